@@ -0,0 +1,11 @@
+#!/bin/bash
+#Compares the forward and deferred render paths across light counts, run after UnixBuild.sh has built the engine
+FRAMES=${FRAMES:-500}
+LIGHT_COUNTS=${LIGHT_COUNTS:-"0 64 256 1024 4096"}
+cd build
+for LIGHTS in $LIGHT_COUNTS; do
+	for RENDER_PATH in forward deferred; do
+		./VulkanEngine --render-path=$RENDER_PATH --lights=$LIGHTS --benchmark-frames=$FRAMES | grep "Average Frame Time"
+	done
+done
+cd ..
@@ -0,0 +1,7 @@
+#!/bin/bash
+#Measures startup with an empty pipeline cache and again with the cache the first run wrote, run after UnixBuild.sh has built the engine
+cd build
+rm -f pipeline_cache.bin
+./VulkanEngine --benchmark-frames=1 | grep "Startup Time"
+./VulkanEngine --benchmark-frames=1 | grep "Startup Time"
+cd ..
@@ -0,0 +1,39 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+//Outputs
+layout(location = 0) out vec4 o_Color;
+
+#include "Lighting.glsl"
+
+//Written in subpass 0 of the deferred render pass, GBuffer.frag packs the material into the alpha channels
+layout(input_attachment_index = 0, set = 2, binding = 0) uniform subpassInput gBufferAlbedo;
+layout(input_attachment_index = 1, set = 2, binding = 1) uniform subpassInput gBufferNormal;
+layout(input_attachment_index = 2, set = 2, binding = 2) uniform subpassInput gBufferDepth;
+
+layout(push_constant) uniform Push {
+	vec2 inverseExtent;
+} push;
+
+void main() {
+	float depth = subpassLoad(gBufferDepth).x;
+	if (depth >= 1.0) {
+		discard;
+	}
+	vec4 albedo = subpassLoad(gBufferAlbedo);
+	if (albedo.a < 0.5) {
+		o_Color = vec4(albedo.xyz, 1.0);
+		return;
+	}
+	vec4 normal = subpassLoad(gBufferNormal);
+	float shininess = normal.w;
+
+	//Rebuild the view position from depth, the projection is the perspective one built by Camera
+	vec2 ndc = gl_FragCoord.xy * push.inverseExtent * 2.0 - 1.0;
+	float viewDepth = ubo.projectionMatrix[3][2] / (depth - ubo.projectionMatrix[2][2]);
+	vec4 viewPosition = vec4(ndc.x * viewDepth / ubo.projectionMatrix[0][0], ndc.y * viewDepth / ubo.projectionMatrix[1][1], viewDepth, 1.0);
+	vec4 worldPosition = ubo.inverseViewMatrix * viewPosition;
+
+	vec3 lit = ShadeSurface(albedo.xyz, worldPosition.xyz, normalize(normal.xyz), ndc, viewDepth, shininess > 0.0, shininess);
+	o_Color = vec4(lit, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 450
+
+//Must match the position math in World.vert exactly, the main pass depth tests with EQUAL against this
+invariant gl_Position;
+
+//Inputs
+layout(location = 0) in vec4 position;
+
+layout(set = 0, binding = 0) uniform GlobalUBO {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	mat4 inverseViewMatrix;
+	vec4 ambientLightColor; //4th component is light intensity
+	uvec4 clusterGrid; //tiles across, tiles down and depth slices, w is the light count
+	vec4 clusterDepth; //depth slice is log(view depth) * x + y
+} ubo;
+
+layout(push_constant) uniform Push {
+	mat4 modelMatrix;
+	mat4 normalMatrix;
+} push;
+
+void main() {
+	vec4 positionWorld = push.modelMatrix * position;
+	gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
+}
@@ -0,0 +1,20 @@
+#version 450
+
+//Inputs
+layout(location = 0) in vec4 color;
+layout(location = 1) in vec4 worldPosition;
+layout(location = 2) in vec4 worldNormal;
+
+//Outputs, lighting happens in DeferredLighting.frag
+layout(location = 0) out vec4 o_Albedo; //a is 1 for lit surfaces
+layout(location = 1) out vec4 o_Normal; //w is the shininess, 0 without specular
+
+//Specialization constants, set per material by WorldShaderVariant like in World.frag
+layout(constant_id = 0) const bool LIT = true;
+layout(constant_id = 1) const bool SPECULAR = true;
+layout(constant_id = 2) const float SHININESS = 32.0;
+
+void main() {
+	o_Albedo = vec4(color.xyz, LIT ? 1.0 : 0.0);
+	o_Normal = vec4(normalize(worldNormal.xyz), SPECULAR ? SHININESS : 0.0);
+}
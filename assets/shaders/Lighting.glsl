@@ -0,0 +1,74 @@
+//Point light shading shared by World.frag and DeferredLighting.frag, so the forward and deferred paths can't drift apart
+//Included with GL_GOOGLE_include_directive, it isn't compiled on its own
+
+struct PointLight {
+	vec4 position; //w is the cutoff radius
+	vec4 color; // w is intensity
+};
+
+layout(set = 0, binding = 0) uniform GlobalUBO {
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	mat4 inverseViewMatrix;
+	vec4 ambientLightColor; //4th component is light intensity
+	uvec4 clusterGrid; //tiles across, tiles down and depth slices, w is the light count
+	vec4 clusterDepth; //depth slice is log(view depth) * x + y
+} ubo;
+
+layout(set = 1, binding = 0) readonly buffer LightBuffer {
+	PointLight lights[];
+} lightBuffer;
+
+layout(set = 1, binding = 1) readonly buffer ClusterBuffer {
+	uvec2 ranges[]; //offset and count into the light index list
+} clusterBuffer;
+
+layout(set = 1, binding = 2) readonly buffer LightIndexBuffer {
+	uint indices[];
+} lightIndexBuffer;
+
+//Lights of the froxel the surface lies in, the grid is binned on the cpu by ClusteredLighting
+uvec2 ClusterRange(vec2 ndc, float viewDepth) {
+	vec2 tile = clamp((ndc * 0.5 + 0.5) * vec2(ubo.clusterGrid.xy), vec2(0.0), vec2(ubo.clusterGrid.xy - 1u));
+	float slice = clamp(log(max(viewDepth, 1e-4)) * ubo.clusterDepth.x + ubo.clusterDepth.y, 0.0, float(ubo.clusterGrid.z - 1u));
+	uvec3 cluster = uvec3(uvec2(tile), uint(slice));
+	return clusterBuffer.ranges[cluster.x + ubo.clusterGrid.x * (cluster.y + ubo.clusterGrid.y * cluster.z)];
+}
+
+//Ambient plus blinn-phong from every light in range, ndc and viewDepth locate the froxel
+vec3 ShadeSurface(vec3 albedo, vec3 worldPosition, vec3 surfaceNormal, vec2 ndc, float viewDepth, bool specular, float shininess) {
+	vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
+	vec3 specularLight = vec3(0.0);
+
+	vec3 cameraPosWorld = ubo.inverseViewMatrix[3].xyz;
+	vec3 viewDirection = normalize(cameraPosWorld - worldPosition);
+
+	uvec2 range = ClusterRange(ndc, viewDepth);
+	for (uint i = 0; i < range.y; i++) {
+		PointLight light = lightBuffer.lights[lightIndexBuffer.indices[range.x + i]];
+		vec3 directionToLight = light.position.xyz - worldPosition;
+		float distanceSquared = dot(directionToLight, directionToLight);
+		float radiusSquared = light.position.w * light.position.w;
+		if (distanceSquared > radiusSquared) {
+			continue;
+		}
+		//Windowed so the contribution reaches exactly zero at the cutoff radius
+		float falloff = 1.0 - (distanceSquared * distanceSquared) / (radiusSquared * radiusSquared);
+		float attenuation = falloff * falloff / distanceSquared;
+		directionToLight = normalize(directionToLight);
+
+		float cosAngleIncidence = max(dot(surfaceNormal, directionToLight), 0);
+		vec3 intensity = light.color.xyz * light.color.w * attenuation;
+
+		diffuseLight += intensity * cosAngleIncidence;
+		//specular lighting
+		if (specular) {
+			vec3 halfAngle = normalize(directionToLight + viewDirection);
+			float blinnTerm = dot(surfaceNormal, halfAngle);
+			blinnTerm = clamp(blinnTerm, 0, 1);
+			blinnTerm = pow(blinnTerm, shininess); //High values = sharp highlight
+			specularLight += intensity * blinnTerm;
+		}
+	}
+	return diffuseLight * albedo + specularLight * albedo;
+}
@@ -9,35 +9,30 @@ const vec2 OFFSETS[6] = vec2[](
 	vec2(1.0, 1.0)
 );
 
-layout (location = 0) out vec2 fragOffset;
+//Per instance inputs
+layout(location = 0) in vec4 lightPosition; //w is the billboard radius
+layout(location = 1) in vec4 lightColor; //w is intensity
 
-struct PointLight {
-	vec4 position; //ignore w
-	vec4 color; // w is intensity
-};
+layout (location = 0) out vec2 fragOffset;
+layout (location = 1) out vec4 fragColor;
 
 layout(set = 0, binding = 0) uniform GlobalUBO {
 	mat4 projectionMatrix;
 	mat4 viewMatrix;
 	mat4 inverseViewMatrix;
 	vec4 ambientLightColor; //4th component is light intensity
-	PointLight pointLights[10];
-	int numLights;
+	uvec4 clusterGrid; //tiles across, tiles down and depth slices, w is the light count
+	vec4 clusterDepth; //depth slice is log(view depth) * x + y
 } ubo;
 
-layout(push_constant) uniform Push {
-	vec4 position;
-	vec4 color;
-	float radius;
-} push;
-
 void main() {
 	fragOffset = OFFSETS[gl_VertexIndex];
 	//vec3 cameraRightWorld = {ubo.viewMatrix[0][0], ubo.viewMatrix[1][0], ubo.viewMatrix[2][0]};
 	//vec3 cameraUpWorld = {ubo.viewMatrix[0][1], ubo.viewMatrix[1][1], ubo.viewMatrix[2][1]};
 	//vec3 positionWorld = ubo.lightPosition.xyz + LIGHT_RADIUS * fragOffset.x * cameraRightWorld + LIGHT_RADIUS * //fragOffset.y * cameraUpWorld;
 	//gl_Position = ubo.projectionMatrix * ubo.viewMatrix * vec4(positionWorld, 1.0);
-	vec4 CameraSpace = ubo.viewMatrix * vec4(push.position.xyz, 1.0);
-	vec4 Position = CameraSpace + push.radius * vec4(fragOffset, 0.0, 0.0);
+	vec4 CameraSpace = ubo.viewMatrix * vec4(lightPosition.xyz, 1.0);
+	vec4 Position = CameraSpace + lightPosition.w * vec4(fragOffset, 0.0, 0.0);
 	gl_Position = ubo.projectionMatrix * Position;
+	fragColor = lightColor;
 }
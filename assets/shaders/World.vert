@@ -1,5 +1,8 @@
 #version 450
 
+//Required for the depth pre-pass, see DepthOnly.vert
+invariant gl_Position;
+
 //Inputs
 layout(location = 0) in vec4 position;
 layout(location = 1) in vec4 color;
@@ -11,18 +14,13 @@ layout(location = 0) out vec4 o_Color;
 layout(location = 1) out vec4 o_WorldPosition;
 layout(location = 2) out vec4 o_WorldNormal;
 
-struct PointLight {
-	vec4 position; //ignore w
-	vec4 color; // w is intensity
-};
-
 layout(set = 0, binding = 0) uniform GlobalUBO {
 	mat4 projectionMatrix;
 	mat4 viewMatrix;
 	mat4 inverseViewMatrix;
 	vec4 ambientLightColor; //4th component is light intensity
-	PointLight pointlights[10];
-	int numLights;
+	uvec4 clusterGrid; //tiles across, tiles down and depth slices, w is the light count
+	vec4 clusterDepth; //depth slice is log(view depth) * x + y
 } ubo;
 
 layout(push_constant) uniform Push {
@@ -0,0 +1,34 @@
+#include "Application.h"
+#include <cstdlib>
+
+namespace {
+
+	bool HasDisplay() {
+#if defined(_WIN32) || defined(__APPLE__)
+		return true;
+#else
+		return std::getenv("DISPLAY") != nullptr || std::getenv("WAYLAND_DISPLAY") != nullptr;
+#endif
+	}
+
+}
+
+//Runs the frame time benchmark along a camera path with a fixed timestep and writes the results as JSON,
+//accepts every VulkanEngine argument and --frames=<count> for the number of measured frames
+int main(int argc, char** argv) {
+	Florencia::ApplicationProps props = Florencia::ApplicationProps::FromCommandLine(argc, argv);
+	if (props.FrameLimit > 0) {
+		props.FrameTimeBenchmarkFrames = props.FrameLimit;
+		props.FrameLimit = 0;
+	}
+	if (props.FrameTimeBenchmarkFrames == 0) { props.FrameTimeBenchmarkFrames = 600; }
+	if (props.CameraPathFile.empty()) { props.CameraPathFile = "orbit"; }
+	if (props.FixedTimeStep <= 0.0f) { props.FixedTimeStep = 1.0f / 60.0f; }
+	if (props.BenchmarkOutput.empty()) { props.BenchmarkOutput = "benchmark.json"; }
+	if (!props.Headless && !HasDisplay()) { props.Headless = true; }
+
+	Florencia::Application* app = new Florencia::Application(props);
+	app->Run();
+	delete app;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Systems/PointLightSystem.h"
+#include "SoftwareRasterizer.h"
+#include "AllocationTracker.h"
+#include "GameObject.h"
+#include "Camera.h"
+#include "Model.h"
+
+namespace Florencia {
+
+	namespace {
+
+		struct MicroBenchmarkResult {
+			std::string m_Name;
+			size_t m_Items = 0;
+			uint64_t m_Iterations = 0;
+			double m_NanosecondsPerItem = 0.0;
+			double m_AllocationsPerIteration = 0.0;
+		};
+
+		struct MicroBenchmarkOptions {
+			double m_MinimumSeconds = 0.25;
+			std::string m_Filter;
+			std::string m_CsvPath;
+		};
+
+		//Written by every benchmark body so the work it measures can't be optimized away
+		volatile size_t g_Sink = 0;
+
+		//One untimed call to warm caches and scratch memory, then iterations until MinimumSeconds have passed
+		MicroBenchmarkResult Measure(const std::string& name, size_t items, const MicroBenchmarkOptions& options, const std::function<size_t()>& body) {
+			g_Sink = g_Sink + body();
+			uint64_t iterations = 0;
+			uint64_t allocationsBefore = AllocationTracker::GetHeapStatistics().m_Allocations;
+			auto start = std::chrono::high_resolution_clock::now();
+			double elapsed = 0.0;
+			do {
+				g_Sink = g_Sink + body();
+				iterations++;
+				elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+			} while (elapsed < options.m_MinimumSeconds);
+			uint64_t allocations = AllocationTracker::GetHeapStatistics().m_Allocations - allocationsBefore;
+
+			MicroBenchmarkResult result{};
+			result.m_Name = name;
+			result.m_Items = items;
+			result.m_Iterations = iterations;
+			result.m_NanosecondsPerItem = elapsed * 1e9 / (static_cast<double>(iterations) * static_cast<double>(items));
+			result.m_AllocationsPerIteration = static_cast<double>(allocations) / static_cast<double>(iterations);
+			return result;
+		}
+
+		//Grid of size x size quads with shared corners, so dedup folds the six corners of every quad back to its four vertices
+		std::string GenerateGridObj(uint32_t size) {
+			std::ostringstream obj;
+			for (uint32_t z = 0; z <= size; z++) {
+				for (uint32_t x = 0; x <= size; x++) {
+					obj << "v " << x << " 0 " << z << " " << (x % 2) << " " << (z % 2) << " 1\n";
+					obj << "vt " << static_cast<float>(x) / size << " " << static_cast<float>(z) / size << "\n";
+				}
+			}
+			obj << "vn 0 -1 0\n";
+			for (uint32_t z = 0; z < size; z++) {
+				for (uint32_t x = 0; x < size; x++) {
+					uint32_t a = z * (size + 1) + x + 1;
+					uint32_t b = a + 1, c = a + size + 1, d = c + 1;
+					obj << "f " << a << "/" << a << "/1 " << b << "/" << b << "/1 " << d << "/" << d << "/1 " << c << "/" << c << "/1\n";
+				}
+			}
+			return obj.str();
+		}
+
+		std::vector<Model::Vertex> GenerateVertices(size_t count, std::mt19937& random) {
+			std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+			std::vector<Model::Vertex> vertices(count);
+			for (Model::Vertex& vertex : vertices) {
+				vertex.position = { distribution(random), distribution(random), distribution(random), 1.0f };
+				vertex.color = { distribution(random), distribution(random), distribution(random), 1.0f };
+				vertex.normal = { distribution(random), distribution(random), distribution(random), 0.0f };
+				vertex.uv = { distribution(random), distribution(random) };
+			}
+			return vertices;
+		}
+
+		std::vector<TransformComponent> GenerateTransforms(size_t count, std::mt19937& random) {
+			std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+			std::vector<TransformComponent> transforms(count);
+			for (TransformComponent& transform : transforms) {
+				transform.translation = { distribution(random), distribution(random), distribution(random) };
+				transform.rotation = { distribution(random), distribution(random), distribution(random) };
+				transform.scale = glm::vec3(1.0f + 0.05f * distribution(random));
+			}
+			return transforms;
+		}
+
+		//Unit cube, occluders are meant to be a handful of large simple meshes like this
+		const glm::vec3 CubeVertices[8] = {
+			{ -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f },
+			{ -0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f }, { 0.5f, 0.5f, 0.5f }, { -0.5f, 0.5f, 0.5f }
+		};
+		const uint32_t CubeIndices[36] = {
+			0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6, 0, 4, 5, 0, 5, 1,
+			3, 2, 6, 3, 6, 7, 0, 3, 7, 0, 7, 4, 1, 5, 6, 1, 6, 2
+		};
+
+		//Walls between the camera and a field of small boxes, some of which end up hidden
+		struct RasterizerScene {
+			glm::mat4 m_ViewProjection{ 1.0f };
+			std::vector<glm::mat4> m_Occluders;
+			std::vector<AABB> m_Queries;
+		};
+
+		RasterizerScene GenerateRasterizerScene(size_t occluderCount, std::mt19937& random) {
+			std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+			Camera camera{};
+			camera.SetPerspectiveProjection(1.2f, 4.0f / 3.0f, 0.1f, 100.0f);
+			camera.SetViewTarget({ 0.0f, -1.0f, -10.0f }, { 0.0f, 0.0f, 0.0f });
+
+			RasterizerScene scene{};
+			scene.m_ViewProjection = camera.GetProjectionMatrix() * camera.GetViewMatrix();
+			for (size_t i = 0; i < occluderCount; i++) {
+				TransformComponent transform{};
+				transform.translation = { 6.0f * distribution(random), 3.0f * distribution(random), 2.0f * distribution(random) };
+				transform.rotation = { 0.0f, 0.3f * distribution(random), 0.0f };
+				transform.scale = { 2.0f + distribution(random), 1.5f + distribution(random), 0.2f };
+				scene.m_Occluders.push_back(transform.Mat4());
+			}
+			for (size_t i = 0; i < 1024; i++) {
+				glm::vec3 center{ 8.0f * distribution(random), 4.0f * distribution(random), 8.0f + 6.0f * distribution(random) };
+				scene.m_Queries.push_back({ center - glm::vec3(0.25f), center + glm::vec3(0.25f) });
+			}
+			return scene;
+		}
+
+		void RasterizeScene(SoftwareRasterizer& rasterizer, const RasterizerScene& scene, JobSystem* jobs) {
+			rasterizer.Begin(scene.m_ViewProjection);
+			for (const glm::mat4& modelMatrix : scene.m_Occluders) { rasterizer.AddOccluder(CubeVertices, CubeIndices, 36, modelMatrix); }
+			rasterizer.Rasterize(jobs);
+		}
+
+		//Tiles are owned by one job each, so every depth texel and every visibility answer has to match the single threaded
+		//result exactly however the jobs get scheduled, a few runs give the scheduling a chance to differ
+		void CheckRasterizerDeterminism(const RasterizerScene& scene, JobSystem& jobs) {
+			SoftwareRasterizer single{};
+			RasterizeScene(single, scene, nullptr);
+			uint32_t occluded = 0;
+			for (const AABB& query : scene.m_Queries) { occluded += single.IsOccluded(query) ? 1 : 0; }
+
+			SoftwareRasterizer threaded{};
+			for (int run = 0; run < 8; run++) {
+				RasterizeScene(threaded, scene, &jobs);
+				for (uint32_t y = 0; y < single.GetHeight(); y++) {
+					for (uint32_t x = 0; x < single.GetWidth(); x++) {
+						if (single.GetDepth(x, y) != threaded.GetDepth(x, y)) {
+							throw std::runtime_error("Software Rasterizer Depth Differs When Threaded At " + std::to_string(x) + ", " + std::to_string(y));
+						}
+					}
+				}
+				for (size_t i = 0; i < scene.m_Queries.size(); i++) {
+					if (single.IsOccluded(scene.m_Queries[i]) != threaded.IsOccluded(scene.m_Queries[i])) {
+						throw std::runtime_error("Software Rasterizer Visibility Differs When Threaded For Query " + std::to_string(i));
+					}
+				}
+			}
+			std::cout << "SoftwareRasterizer Deterministic: " << scene.m_Occluders.size() << " Occluders, " << occluded << " Of " << scene.m_Queries.size()
+				<< " Queries Occluded, Same With " << jobs.GetWorkerCount() << " Workers\n";
+		}
+
+		void RunAll(const MicroBenchmarkOptions& options) {
+			std::vector<MicroBenchmarkResult> results{};
+			std::mt19937 random{ 1234 };
+			auto enabled = [&](const std::string& name) { return options.m_Filter.empty() || name.find(options.m_Filter) != std::string::npos; };
+			auto report = [&](const MicroBenchmarkResult& result) {
+				//Per item cost against the smallest size of the same benchmark, flat means it scales linearly
+				double baseline = result.m_NanosecondsPerItem;
+				for (const MicroBenchmarkResult& previous : results) {
+					if (previous.m_Name == result.m_Name) { baseline = previous.m_NanosecondsPerItem; break; }
+				}
+				results.push_back(result);
+				std::cout << std::left << std::setw(28) << result.m_Name << std::right << std::setw(10) << result.m_Items
+					<< std::fixed << std::setprecision(2) << std::setw(12) << result.m_NanosecondsPerItem << " ns/item"
+					<< std::setw(14) << std::setprecision(0) << 1e9 / result.m_NanosecondsPerItem << " items/s"
+					<< std::setw(10) << std::setprecision(1) << result.m_AllocationsPerIteration << " allocs/iter"
+					<< std::setw(8) << std::setprecision(2) << result.m_NanosecondsPerItem / baseline << "x\n";
+			};
+
+			if (enabled("Model::LoadModel")) {
+				for (uint32_t size : { 8u, 32u, 128u, 256u }) {
+					std::string obj = GenerateGridObj(size);
+					Model::Data data{};
+					report(Measure("Model::LoadModel", static_cast<size_t>(size) * size * 6, options, [&]() {
+						std::istringstream stream(obj);
+						data.LoadModel(stream);
+						return data.indices.size();
+					}));
+				}
+			}
+
+			if (enabled("std::hash<Vertex>")) {
+				for (size_t count : { 1024u, 16384u, 262144u }) {
+					std::vector<Model::Vertex> vertices = GenerateVertices(count, random);
+					report(Measure("std::hash<Vertex>", count, options, [&]() {
+						size_t combined = 0;
+						for (const Model::Vertex& vertex : vertices) { combined ^= std::hash<Model::Vertex>{}(vertex); }
+						return combined;
+					}));
+				}
+			}
+
+			if (enabled("TransformComponent")) {
+				for (size_t count : { 1024u, 16384u, 262144u }) {
+					std::vector<TransformComponent> transforms = GenerateTransforms(count, random);
+					report(Measure("TransformComponent::Mat4", count, options, [&]() {
+						float sum = 0.0f;
+						for (TransformComponent& transform : transforms) { sum += transform.Mat4()[3][0]; }
+						return static_cast<size_t>(sum);
+					}));
+					report(Measure("TransformComponent::Normal", count, options, [&]() {
+						float sum = 0.0f;
+						for (TransformComponent& transform : transforms) { sum += transform.NormalMatrix()[0][0]; }
+						return static_cast<size_t>(sum);
+					}));
+				}
+			}
+
+			if (enabled("Camera")) {
+				for (size_t count : { 1024u, 16384u, 262144u }) {
+					std::vector<TransformComponent> transforms = GenerateTransforms(count, random);
+					Camera camera{};
+					report(Measure("Camera::SetViewYXZ", count, options, [&]() {
+						for (const TransformComponent& transform : transforms) { camera.SetViewYXZ(transform.translation, transform.rotation); }
+						return static_cast<size_t>(camera.GetViewMatrix()[3][0]);
+					}));
+					report(Measure("Camera::SetPerspective", count, options, [&]() {
+						for (const TransformComponent& transform : transforms) { camera.SetPerspectiveProjection(1.2f, 1.0f + 0.01f * transform.scale.x, 0.01f, 100.0f); }
+						return static_cast<size_t>(camera.GetProjectionMatrix()[0][0]);
+					}));
+				}
+			}
+
+			if (enabled("LightDistanceSort")) {
+				for (size_t count : { 64u, 1024u, 16384u, 65536u }) {
+					Registry registry{};
+					std::vector<Entity> lights{};
+					std::uniform_real_distribution<float> distribution(-20.0f, 20.0f);
+					for (size_t i = 0; i < count; i++) {
+						auto light = GameObject::CreatePointLight(registry, 0.2f, 0.03f);
+						light.Transform().translation = { distribution(random), distribution(random), distribution(random) };
+						lights.push_back(light.GetID());
+					}
+					LightDistanceSort sort{};
+					report(Measure("LightDistanceSort", count, options, [&]() {
+						uint32_t sorted = sort.Sort(registry, glm::vec3(0.0f, -1.0f, -2.5f), lights);
+						return static_cast<size_t>(sort.GetBackToFront(0).m_Index) + sorted;
+					}));
+				}
+			}
+
+			if (enabled("SoftwareRasterizer")) {
+				//Fixed worker count so the threaded path really is threaded on small machines
+				JobSystem jobs{ 4 };
+				for (size_t count : { 16u, 64u, 256u }) {
+					std::mt19937 sceneRandom{ 42 };
+					RasterizerScene scene = GenerateRasterizerScene(count, sceneRandom);
+					CheckRasterizerDeterminism(scene, jobs);
+					SoftwareRasterizer rasterizer{};
+					size_t triangles = count * 12;
+					report(Measure("SoftwareRasterizer", triangles, options, [&]() {
+						RasterizeScene(rasterizer, scene, nullptr);
+						return static_cast<size_t>(rasterizer.GetTriangleCount());
+					}));
+					report(Measure("SoftwareRasterizer Jobs", triangles, options, [&]() {
+						RasterizeScene(rasterizer, scene, &jobs);
+						return static_cast<size_t>(rasterizer.GetTriangleCount());
+					}));
+				}
+			}
+
+			if (!options.m_CsvPath.empty()) {
+				std::ofstream csv(options.m_CsvPath);
+				if (!csv) throw std::runtime_error("Failed to Write " + options.m_CsvPath);
+				csv << "name,items,iterations,ns_per_item,allocations_per_iteration\n";
+				for (const MicroBenchmarkResult& result : results) {
+					csv << result.m_Name << "," << result.m_Items << "," << result.m_Iterations << "," << result.m_NanosecondsPerItem << "," << result.m_AllocationsPerIteration << "\n";
+				}
+			}
+		}
+
+	}
+
+}
+
+//CPU hot paths on synthetic inputs of growing size, no window or gpu is created
+//Recognizes --filter=<substring>, --min-time=<seconds per size> and --csv=<file>
+int main(int argc, char** argv) {
+	Florencia::MicroBenchmarkOptions options{};
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument.rfind("--filter=", 0) == 0) { options.m_Filter = argument.substr(9); }
+		else if (argument.rfind("--min-time=", 0) == 0) { options.m_MinimumSeconds = std::stod(argument.substr(11)); }
+		else if (argument.rfind("--csv=", 0) == 0) { options.m_CsvPath = argument.substr(6); }
+	}
+	Florencia::RunAll(options);
+	return 0;
+}
\ No newline at end of file
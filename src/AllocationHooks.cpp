@@ -0,0 +1,22 @@
+#include "AllocationTracker.h"
+#include <cstdlib>
+#include <new>
+
+//Replaces the global allocation functions for the whole executable, so it is linked into executables instead of the engine
+//library. The aligned overloads are left to the standard library, which doesn't route them through these, so over-aligned
+//allocations are not counted
+void* operator new(std::size_t size) {
+	Florencia::AllocationTracker::RecordHeapAllocation(size);
+	if (void* memory = std::malloc(size == 0 ? 1 : size)) { return memory; }
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try { return operator new(size); }
+	catch (const std::bad_alloc&) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return operator new(size, std::nothrow); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
\ No newline at end of file
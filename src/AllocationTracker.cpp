@@ -0,0 +1,163 @@
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace Florencia {
+
+	namespace {
+
+		std::atomic<uint64_t> g_HeapAllocations{ 0 };
+		std::atomic<uint64_t> g_HeapBytes{ 0 };
+
+		struct ScopeCounters {
+			std::atomic<uint64_t> m_Allocations{ 0 };
+			std::atomic<uint64_t> m_Reallocations{ 0 };
+			std::atomic<uint64_t> m_Frees{ 0 };
+			std::atomic<uint64_t> m_Bytes{ 0 };
+			std::atomic<uint64_t> m_PeakBytes{ 0 };
+		};
+
+		ScopeCounters g_VulkanScopes[VulkanAllocationStatistics::ScopeCount];
+		std::atomic<uint64_t> g_VulkanInternalBytes{ 0 };
+
+		//In front of every block handed to the driver, free and realloc only get the pointer
+		struct BlockHeader {
+			void* m_Base;
+			size_t m_Size;
+			VkSystemAllocationScope m_Scope;
+		};
+
+		BlockHeader* GetHeader(void* memory) { return static_cast<BlockHeader*>(memory) - 1; }
+
+		void AddBytes(VkSystemAllocationScope scope, size_t size) {
+			ScopeCounters& counters = g_VulkanScopes[scope];
+			uint64_t bytes = counters.m_Bytes.fetch_add(size, std::memory_order_relaxed) + size;
+			uint64_t peak = counters.m_PeakBytes.load(std::memory_order_relaxed);
+			while (bytes > peak && !counters.m_PeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+		}
+
+		void RemoveBytes(VkSystemAllocationScope scope, size_t size) { g_VulkanScopes[scope].m_Bytes.fetch_sub(size, std::memory_order_relaxed); }
+
+		//alignment is a power of two, the header is placed right below the aligned address
+		void* AllocateBlock(size_t size, size_t alignment, VkSystemAllocationScope scope) {
+			alignment = std::max(alignment, alignof(BlockHeader));
+			void* base = std::malloc(size + alignment + sizeof(BlockHeader));
+			if (base == nullptr) { return nullptr; }
+			uintptr_t address = (reinterpret_cast<uintptr_t>(base) + sizeof(BlockHeader) + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+			void* memory = reinterpret_cast<void*>(address);
+			*GetHeader(memory) = { base, size, scope };
+			AddBytes(scope, size);
+			return memory;
+		}
+
+		void FreeBlock(void* memory) {
+			BlockHeader* header = GetHeader(memory);
+			RemoveBytes(header->m_Scope, header->m_Size);
+			std::free(header->m_Base);
+		}
+
+		void* VKAPI_PTR Allocate(void*, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+			if (size == 0) { return nullptr; }
+			g_VulkanScopes[scope].m_Allocations.fetch_add(1, std::memory_order_relaxed);
+			return AllocateBlock(size, alignment, scope);
+		}
+
+		void* VKAPI_PTR Reallocate(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) {
+			if (original == nullptr) { return Allocate(userData, size, alignment, scope); }
+			if (size == 0) {
+				g_VulkanScopes[GetHeader(original)->m_Scope].m_Frees.fetch_add(1, std::memory_order_relaxed);
+				FreeBlock(original);
+				return nullptr;
+			}
+			g_VulkanScopes[scope].m_Reallocations.fetch_add(1, std::memory_order_relaxed);
+			void* memory = AllocateBlock(size, alignment, scope);
+			//The original stays valid when the reallocation fails
+			if (memory == nullptr) { return nullptr; }
+			std::memcpy(memory, original, std::min(size, GetHeader(original)->m_Size));
+			FreeBlock(original);
+			return memory;
+		}
+
+		void VKAPI_PTR Free(void*, void* memory) {
+			if (memory == nullptr) { return; }
+			g_VulkanScopes[GetHeader(memory)->m_Scope].m_Frees.fetch_add(1, std::memory_order_relaxed);
+			FreeBlock(memory);
+		}
+
+		void VKAPI_PTR InternalAllocation(void*, size_t size, VkInternalAllocationType, VkSystemAllocationScope) { g_VulkanInternalBytes.fetch_add(size, std::memory_order_relaxed); }
+		void VKAPI_PTR InternalFree(void*, size_t size, VkInternalAllocationType, VkSystemAllocationScope) { g_VulkanInternalBytes.fetch_sub(size, std::memory_order_relaxed); }
+
+		const VkAllocationCallbacks g_VulkanCallbacks{ nullptr, Allocate, Reallocate, Free, InternalAllocation, InternalFree };
+
+	}
+
+	uint64_t VulkanAllocationStatistics::GetCalls() const {
+		uint64_t calls = 0;
+		for (const VulkanAllocationScopeStatistics& scope : m_Scopes) { calls += scope.m_Allocations + scope.m_Reallocations; }
+		return calls;
+	}
+
+	uint64_t VulkanAllocationStatistics::GetBytes() const {
+		uint64_t bytes = 0;
+		for (const VulkanAllocationScopeStatistics& scope : m_Scopes) { bytes += scope.m_Bytes; }
+		return bytes;
+	}
+
+	void AllocationTracker::RecordHeapAllocation(size_t size) {
+		g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+		g_HeapBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	HeapAllocationStatistics AllocationTracker::GetHeapStatistics() {
+		return { g_HeapAllocations.load(std::memory_order_relaxed), g_HeapBytes.load(std::memory_order_relaxed) };
+	}
+
+	const VkAllocationCallbacks* AllocationTracker::GetVulkanCallbacks() {
+		return Enabled ? &g_VulkanCallbacks : nullptr;
+	}
+
+	VulkanAllocationStatistics AllocationTracker::GetVulkanStatistics() {
+		VulkanAllocationStatistics statistics{};
+		for (uint32_t i = 0; i < VulkanAllocationStatistics::ScopeCount; i++) {
+			const ScopeCounters& counters = g_VulkanScopes[i];
+			statistics.m_Scopes[i].m_Allocations = counters.m_Allocations.load(std::memory_order_relaxed);
+			statistics.m_Scopes[i].m_Reallocations = counters.m_Reallocations.load(std::memory_order_relaxed);
+			statistics.m_Scopes[i].m_Frees = counters.m_Frees.load(std::memory_order_relaxed);
+			statistics.m_Scopes[i].m_Bytes = counters.m_Bytes.load(std::memory_order_relaxed);
+			statistics.m_Scopes[i].m_PeakBytes = counters.m_PeakBytes.load(std::memory_order_relaxed);
+		}
+		statistics.m_InternalBytes = g_VulkanInternalBytes.load(std::memory_order_relaxed);
+		return statistics;
+	}
+
+	const char* AllocationTracker::GetScopeName(uint32_t scope) {
+		switch (scope) {
+			case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND: return "Command";
+			case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT: return "Object";
+			case VK_SYSTEM_ALLOCATION_SCOPE_CACHE: return "Cache";
+			case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE: return "Device";
+			case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE: return "Instance";
+			default: return "Unknown";
+		}
+	}
+
+	void FrameAllocationCounter::BeginFrame() {
+		m_HeapStart = AllocationTracker::GetHeapStatistics();
+		m_VulkanStart = AllocationTracker::GetVulkanStatistics().GetCalls();
+	}
+
+	void FrameAllocationCounter::EndFrame(bool steadyState) {
+		if (!steadyState) { return; }
+		uint64_t heapAllocations = AllocationTracker::GetHeapStatistics().m_Allocations - m_HeapStart.m_Allocations;
+		uint64_t vulkanAllocations = AllocationTracker::GetVulkanStatistics().GetCalls() - m_VulkanStart;
+		m_Statistics.m_Frames++;
+		if (heapAllocations > 0) { m_Statistics.m_FramesWithHeapAllocations++; }
+		m_Statistics.m_HeapAllocations += heapAllocations;
+		m_Statistics.m_MaxHeapAllocations = std::max(m_Statistics.m_MaxHeapAllocations, heapAllocations);
+		m_Statistics.m_VulkanAllocations += vulkanAllocations;
+		m_Statistics.m_MaxVulkanAllocations = std::max(m_Statistics.m_MaxVulkanAllocations, vulkanAllocations);
+	}
+
+}
\ No newline at end of file
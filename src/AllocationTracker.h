@@ -0,0 +1,80 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace Florencia {
+
+	//Everything allocated through global operator new by every thread, unsized deletes don't know the size so only
+	//allocated bytes are counted, not live ones
+	struct HeapAllocationStatistics {
+		uint64_t m_Allocations = 0;
+		uint64_t m_Bytes = 0;
+	};
+
+	struct VulkanAllocationScopeStatistics {
+		uint64_t m_Allocations = 0;
+		uint64_t m_Reallocations = 0;
+		uint64_t m_Frees = 0;
+		uint64_t m_Bytes = 0;
+		uint64_t m_PeakBytes = 0;
+	};
+
+	//Host memory the driver allocated through the tracked VkAllocationCallbacks, m_Scopes is indexed by VkSystemAllocationScope
+	struct VulkanAllocationStatistics {
+		static constexpr uint32_t ScopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+		VulkanAllocationScopeStatistics m_Scopes[ScopeCount];
+		//Reported by the driver for memory it allocated itself, executable code for example
+		uint64_t m_InternalBytes = 0;
+
+		//Allocations and reallocations over every scope
+		uint64_t GetCalls() const;
+		uint64_t GetBytes() const;
+	};
+
+	//Counts heap and Vulkan host allocations when FLORENCIA_TRACK_ALLOCATIONS is defined, which hands the driver counting
+	//allocation callbacks and links AllocationHooks.cpp, the global operator new replacement, into every executable
+	//Without it nothing is replaced and every count stays zero
+	class AllocationTracker {
+	public:
+#ifdef FLORENCIA_TRACK_ALLOCATIONS
+		static constexpr bool Enabled = true;
+#else
+		static constexpr bool Enabled = false;
+#endif
+
+		//Called by the operator new replacement in AllocationHooks.cpp on every allocation
+		static void RecordHeapAllocation(size_t size);
+		static HeapAllocationStatistics GetHeapStatistics();
+		//Passed to every vkCreate*, vkAllocate*, vkDestroy* and vkFree* call through Device::GetAllocator, nullptr unless Enabled
+		static const VkAllocationCallbacks* GetVulkanCallbacks();
+		static VulkanAllocationStatistics GetVulkanStatistics();
+		static const char* GetScopeName(uint32_t scope);
+	};
+
+	//Summed over the frames counted as steady state
+	struct FrameAllocationStatistics {
+		uint32_t m_Frames = 0;
+		uint32_t m_FramesWithHeapAllocations = 0;
+		uint64_t m_HeapAllocations = 0;
+		uint64_t m_MaxHeapAllocations = 0;
+		uint64_t m_VulkanAllocations = 0;
+		uint64_t m_MaxVulkanAllocations = 0;
+	};
+
+	//Heap and Vulkan host allocations made between BeginFrame and EndFrame, on any thread
+	class FrameAllocationCounter {
+	public:
+		void BeginFrame();
+		//Frames still filling caches and pools pass false and are left out
+		void EndFrame(bool steadyState);
+
+		const FrameAllocationStatistics& GetStatistics() const { return m_Statistics; }
+
+	private:
+		HeapAllocationStatistics m_HeapStart{};
+		uint64_t m_VulkanStart = 0;
+		FrameAllocationStatistics m_Statistics{};
+	};
+
+}
\ No newline at end of file
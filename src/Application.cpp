@@ -1,9 +1,21 @@
 #include "Application.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <stdexcept>
+#include <limits>
+#include <string>
 #include <chrono>
 
+#include "Systems/DeferredLightingSystem.h"
 #include "Systems/SimpleRenderSystem.h"
 #include "Systems/PointLightSystem.h"
+#include "BenchmarkRunner.h"
+#include "GpuProfiler.h"
+#include "CpuProfiler.h"
+#include "CameraPath.h"
+#include "ClusteredLighting.h"
+#include "OcclusionCulling.h"
+#include "FramePacer.h"
 #include "ObjectController.h"
 #include "FrameInfo.h"
 #include "Camera.h"
@@ -12,62 +24,227 @@
 
 namespace Florencia {
 
-	Application::Application() {
+	namespace {
+
+		//True when argument starts with prefix, value receives the rest of the argument
+		bool MatchArgument(const std::string& argument, const std::string& prefix, std::string& value) {
+			if (argument.compare(0, prefix.size(), prefix) != 0) { return false; }
+			value = argument.substr(prefix.size());
+			return true;
+		}
+
+		constexpr const char* Usage =
+			"Usage: VulkanEngine [options]\n"
+			"  --occlusion=none|hiz|software         --render-path=forward|deferred       --lights=<count>\n"
+			"  --benchmark-prepass=<frames>          --benchmark-frames=<frames>          --benchmark-resize=<frames>\n"
+			"  --benchmark-output=<file>             --dynamic-rendering                  --present=low-latency|vsync|uncapped|mailbox\n"
+			"  --frames-in-flight=<1-4>              --frame-loop=standard|late-input|deadline\n"
+			"  --headless                            --frames=<count>                     --capture=<path prefix>\n"
+			"  --camera-path=<file>|orbit            --record-camera-path=<file>          --fixed-timestep=<seconds>\n"
+			"  --gpu-trace=<file>                    --cpu-trace=<file>";
+
+		//The whole value has to be a number, std::stoul alone would take "12abc" as 12 and wrap "-1" around
+		uint32_t ParseUnsigned(const std::string& flag, const std::string& value) {
+			size_t end = 0;
+			unsigned long parsed = 0;
+			try { parsed = std::stoul(value, &end); }
+			catch (const std::exception&) { end = 0; }
+			if (end == 0 || end != value.size() || value[0] == '-' || parsed > std::numeric_limits<uint32_t>::max()) throw std::runtime_error("Invalid Value For " + flag + " " + value + ", Expected A Whole Number");
+			return static_cast<uint32_t>(parsed);
+		}
+
+		float ParseFloat(const std::string& flag, const std::string& value) {
+			size_t end = 0;
+			float parsed = 0.0f;
+			try { parsed = std::stof(value, &end); }
+			catch (const std::exception&) { end = 0; }
+			if (end == 0 || end != value.size()) throw std::runtime_error("Invalid Value For " + flag + " " + value + ", Expected A Number");
+			return parsed;
+		}
+
+	}
+
+	ApplicationProps ApplicationProps::FromCommandLine(int argc, char** argv) {
+		ApplicationProps props{};
+		for (int i = 1; i < argc; i++) {
+			std::string argument = argv[i];
+			std::string value;
+			if (MatchArgument(argument, "--occlusion=", value)) {
+				if (value == "none") { props.OcclusionCulling = OcclusionCullingMode::None; }
+				else if (value == "hiz") { props.OcclusionCulling = OcclusionCullingMode::HiZ; }
+				else if (value == "software") { props.OcclusionCulling = OcclusionCullingMode::Software; }
+				else { throw std::runtime_error("Unknown Occlusion Culling Mode: " + value); }
+			}
+			else if (MatchArgument(argument, "--render-path=", value)) {
+				if (value == "forward") { props.Path = RenderPath::Forward; }
+				else if (value == "deferred") { props.Path = RenderPath::Deferred; }
+				else { throw std::runtime_error("Unknown Render Path: " + value); }
+			}
+			else if (MatchArgument(argument, "--lights=", value)) {
+				props.LightCount = ParseUnsigned("--lights", value);
+			}
+			else if (MatchArgument(argument, "--benchmark-prepass=", value)) {
+				props.DepthPrepassBenchmarkFrames = ParseUnsigned("--benchmark-prepass", value);
+			}
+			else if (MatchArgument(argument, "--benchmark-frames=", value)) {
+				props.FrameTimeBenchmarkFrames = ParseUnsigned("--benchmark-frames", value);
+			}
+			else if (MatchArgument(argument, "--benchmark-resize=", value)) {
+				props.ResizeBenchmarkFrames = ParseUnsigned("--benchmark-resize", value);
+			}
+			else if (argument == "--dynamic-rendering") {
+				props.DynamicRendering = true;
+			}
+			else if (MatchArgument(argument, "--present=", value)) {
+				if (value == "low-latency") { props.Present = PresentPolicy::LowLatency; }
+				else if (value == "vsync") { props.Present = PresentPolicy::VSync; }
+				else if (value == "uncapped") { props.Present = PresentPolicy::Uncapped; }
+				else if (value == "mailbox") { props.Present = PresentPolicy::Mailbox; }
+				else { throw std::runtime_error("Unknown Present Policy: " + value); }
+			}
+			else if (MatchArgument(argument, "--frame-loop=", value)) {
+				if (value == "standard") { props.FrameLoop = FrameLoopMode::Standard; }
+				else if (value == "late-input") { props.FrameLoop = FrameLoopMode::LateInput; }
+				else if (value == "deadline") { props.FrameLoop = FrameLoopMode::Deadline; }
+				else { throw std::runtime_error("Unknown Frame Loop: " + value); }
+			}
+			else if (MatchArgument(argument, "--frames-in-flight=", value)) {
+				props.FramesInFlight = ParseUnsigned("--frames-in-flight", value);
+				if (props.FramesInFlight < 1 || props.FramesInFlight > SwapChain::MaxFramesInFlight) throw std::runtime_error("--frames-in-flight Must Be Between 1 And " + std::to_string(SwapChain::MaxFramesInFlight));
+			}
+			else if (argument == "--headless") {
+				props.Headless = true;
+			}
+			else if (MatchArgument(argument, "--frames=", value)) {
+				props.FrameLimit = ParseUnsigned("--frames", value);
+			}
+			else if (MatchArgument(argument, "--capture=", value)) {
+				props.CapturePath = value;
+			}
+			else if (MatchArgument(argument, "--camera-path=", value)) {
+				props.CameraPathFile = value;
+			}
+			else if (MatchArgument(argument, "--record-camera-path=", value)) {
+				props.RecordCameraPathFile = value;
+			}
+			else if (MatchArgument(argument, "--fixed-timestep=", value)) {
+				props.FixedTimeStep = ParseFloat("--fixed-timestep", value);
+			}
+			else if (MatchArgument(argument, "--benchmark-output=", value)) {
+				props.BenchmarkOutput = value;
+			}
+			else if (MatchArgument(argument, "--gpu-trace=", value)) {
+				props.GpuTraceOutput = value;
+			}
+			else if (MatchArgument(argument, "--cpu-trace=", value)) {
+				props.CpuTraceOutput = value;
+			}
+			else { throw std::runtime_error("Unknown Argument: " + argument + "\n" + Usage); }
+		}
+		return props;
+	}
+
+	Application::Application(const ApplicationProps& props) : m_Properties{ props } {
+		bool benchmark = m_Properties.DepthPrepassBenchmarkFrames > 0 || m_Properties.FrameTimeBenchmarkFrames > 0 || m_Properties.ResizeBenchmarkFrames > 0;
+		if (m_Properties.Headless && m_Properties.FrameLimit == 0 && !benchmark) throw std::runtime_error("Headless Mode Needs --frames=<count> Or A Benchmark To Exit");
+		if (!m_Properties.CapturePath.empty()) { m_Renderer.CaptureFrames(m_Properties.CapturePath); }
+		if (!m_Properties.BenchmarkOutput.empty() && m_Properties.FrameTimeBenchmarkFrames == 0) throw std::runtime_error("--benchmark-output Requires --benchmark-frames=<frames>");
+		if (!m_Properties.CpuTraceOutput.empty() && !CpuProfiler::Enabled) throw std::runtime_error("--cpu-trace Requires A Build With FLORENCIA_ENABLE_PROFILING");
 		m_GlobalPool = DescriptorPool::Builder(m_Device)
-			.SetMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT)
-			.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT)
+			.SetMaxSets(m_Renderer.GetFramesInFlight())
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_Renderer.GetFramesInFlight())
 			.Build();
 		LoadGameObjects();
 	}
 
 	void Application::LoadGameObjects() {
-		auto model = Model::CreateModelFromFile(m_Device, "assets/models/cube.obj");
-		auto cube = GameObject::CreateGameObject();
-		cube.m_Transform.translation = { -1.0f, 0.0f, 0.0f };
-		cube.m_Transform.scale *= 1.0f;
-		cube.m_Model = model;
-		m_GameObjects.emplace(cube.GetID(), std::move(cube));
-
-		model = Model::CreateModelFromFile(m_Device, "assets/models/colored_cube.obj");
-		auto colorcube = GameObject::CreateGameObject();
-		colorcube.m_Transform.translation = { 1.0f, 0.0f, 0.0f };
-		colorcube.m_Transform.scale *= 1.0f;
-		colorcube.m_Model = model;
-		m_GameObjects.emplace(colorcube.GetID(), std::move(colorcube));
-
-		model = Model::CreateModelFromFile(m_Device, "assets/models/quad.obj");
-		auto floor = GameObject::CreateGameObject();
-		floor.m_Transform.translation = { 0.0f, 0.5f, 0.0f };
-		floor.m_Transform.scale *= 2.0f;
-		floor.m_Model = model;
-		m_GameObjects.emplace(floor.GetID(), std::move(floor));
-
-		model = Model::CreateModelFromFile(m_Device, "assets/models/flat_vase.obj");
-		auto flat_vase = GameObject::CreateGameObject();
-		flat_vase.m_Transform.translation = { -1.0f, -0.5f, 0.0f };
-		flat_vase.m_Transform.scale *= 2.0f;
-		flat_vase.m_Model = model;
-		m_GameObjects.emplace(flat_vase.GetID(), std::move(flat_vase));
+		//Large simple meshes double as occluders for the software occlusion culler
+		Model::Data data{};
+		data.LoadModel("assets/models/cube.obj");
+		auto cube = GameObject::CreateGameObject(m_Registry);
+		cube.Transform().translation = { -1.0f, 0.0f, 0.0f };
+		cube.Transform().scale *= 1.0f;
+		cube.AddComponent<ModelComponent>(std::make_shared<Model>(m_Device, data));
+		cube.AddComponent<OccluderComponent>(OccluderComponent::FromModelData(data));
+
+		data.LoadModel("assets/models/colored_cube.obj");
+		auto colorcube = GameObject::CreateGameObject(m_Registry);
+		colorcube.Transform().translation = { 1.0f, 0.0f, 0.0f };
+		colorcube.Transform().scale *= 1.0f;
+		colorcube.AddComponent<ModelComponent>(std::make_shared<Model>(m_Device, data));
+		colorcube.AddComponent<OccluderComponent>(OccluderComponent::FromModelData(data));
+
+		data.LoadModel("assets/models/quad.obj");
+		auto floor = GameObject::CreateGameObject(m_Registry);
+		floor.Transform().translation = { 0.0f, 0.5f, 0.0f };
+		floor.Transform().scale *= 2.0f;
+		floor.AddComponent<ModelComponent>(std::make_shared<Model>(m_Device, data));
+		floor.AddComponent<OccluderComponent>(OccluderComponent::FromModelData(data));
+		floor.AddComponent<MaterialComponent>(MaterialComponent{ true, false });
+
+		auto model = Model::CreateModelFromFile(m_Device, "assets/models/flat_vase.obj");
+		auto flat_vase = GameObject::CreateGameObject(m_Registry);
+		flat_vase.Transform().translation = { -1.0f, -0.5f, 0.0f };
+		flat_vase.Transform().scale *= 2.0f;
+		flat_vase.AddComponent<ModelComponent>(model);
+		flat_vase.AddComponent<MaterialComponent>(MaterialComponent{ true, true, 8.0f });
 
 		model = Model::CreateModelFromFile(m_Device, "assets/models/smooth_vase.obj");
-		auto smooth_vase = GameObject::CreateGameObject();
-		smooth_vase.m_Transform.translation = { 1.0f, -0.5f, 0.0f };
-		smooth_vase.m_Transform.scale *= 2.0f;
-		smooth_vase.m_Model = model;
-		m_GameObjects.emplace(smooth_vase.GetID(), std::move(smooth_vase));
-
-		auto pointLight1 = GameObject::CreatePointLight(1.0f, 0.2f, {0.4f, 0.0f, 0.9f});
-		pointLight1.m_Transform.translation = { 0.0f, -1.0f, 1.0f };
-		m_GameObjects.emplace(pointLight1.GetID(), std::move(pointLight1));
-
-		auto pointLight2 = GameObject::CreatePointLight(0.5);
-		pointLight2.m_Transform.translation = { 0.0f, -1.0f, -1.0f };
-		m_GameObjects.emplace(pointLight2.GetID(), std::move(pointLight2));
+		auto smooth_vase = GameObject::CreateGameObject(m_Registry);
+		smooth_vase.Transform().translation = { 1.0f, -0.5f, 0.0f };
+		smooth_vase.Transform().scale *= 2.0f;
+		smooth_vase.AddComponent<ModelComponent>(model);
+
+		auto pointLight1 = GameObject::CreatePointLight(m_Registry, 1.0f, 0.2f, {0.4f, 0.0f, 0.9f});
+		pointLight1.Transform().translation = { 0.0f, -1.0f, 1.0f };
+
+		auto pointLight2 = GameObject::CreatePointLight(m_Registry, 0.5);
+		pointLight2.Transform().translation = { 0.0f, -1.0f, -1.0f };
+
+		//Golden angle spiral over the floor so any light count covers the scene evenly and every run places them the same way
+		for (uint32_t i = 0; i < m_Properties.LightCount; i++) {
+			float t = (static_cast<float>(i) + 0.5f) / static_cast<float>(m_Properties.LightCount);
+			float angle = static_cast<float>(i) * 2.39996323f;
+			glm::vec3 color = glm::clamp(glm::abs(glm::mod(glm::vec3(angle) / glm::two_pi<float>() * 6.0f + glm::vec3(0.0f, 4.0f, 2.0f), 6.0f) - 3.0f) - 1.0f, 0.0f, 1.0f);
+			auto light = GameObject::CreatePointLight(m_Registry, 0.2f, 0.03f, color);
+			light.Transform().translation = { 2.0f * glm::sqrt(t) * glm::cos(angle), -0.25f - 0.75f * t, 2.0f * glm::sqrt(t) * glm::sin(angle) };
+		}
+
+		m_Registry.Query<ModelComponent>().Each([&](Entity entity, ModelComponent& model) {
+			m_SpatialIndex.Track(entity, model.m_Model->GetBounds(), SpatialLayer::Renderable);
+		});
+		m_Registry.Query<PointLightComponent>().Each([&](Entity entity, PointLightComponent& light) {
+			float range = light.Range();
+			m_SpatialIndex.Track(entity, AABB{ glm::vec3(-range), glm::vec3(range) }, SpatialLayer::Light);
+		});
+	}
+
+	void Application::PickGameObject(const Camera& camera) {
+		double x, y;
+		glfwGetCursorPos(m_Window.Get(), &x, &y);
+		VkExtent2D extent = m_Window.GetExtent();
+		if (extent.width == 0 || extent.height == 0) { return; }
+		glm::vec2 ndc{ 2.0f * static_cast<float>(x) / extent.width - 1.0f, 2.0f * static_cast<float>(y) / extent.height - 1.0f };
+
+		//Clicking empty space clears the selection
+		Entity hit;
+		if (!m_SpatialIndex.Pick(camera.ScreenPointToRay(ndc), SpatialLayer::Renderable, hit)) { hit = Entity{}; }
+		if (hit == m_SelectedEntity) { return; }
+		m_SelectedEntity = hit;
+		UpdateWindowTitle();
+	}
+
+	void Application::UpdateWindowTitle() {
+		std::string title = "Vulkan Tutorial - Depth Pre-pass ";
+		title += m_DepthPrepassEnabled ? "On" : "Off";
+		if (m_SelectedEntity.m_Index != Entity::InvalidIndex) { title += " - Selected GameObject " + std::to_string(m_SelectedEntity.m_Index); }
+		m_Window.SetTitle(title);
 	}
 
 	void Application::Run() {
-		std::vector<std::unique_ptr<Buffer>> uboBuffers(SwapChain::MAX_FRAMES_IN_FLIGHT);
-		for (int i = 0; i < uboBuffers.size(); i++) {
+		uint32_t framesInFlight = m_Renderer.GetFramesInFlight();
+		std::vector<std::unique_ptr<Buffer>> uboBuffers(framesInFlight);
+		for (size_t i = 0; i < uboBuffers.size(); i++) {
 			uboBuffers[i] = std::make_unique<Buffer>(
 				m_Device,
 				sizeof(GlobalUBO),
@@ -75,6 +252,7 @@ namespace Florencia {
 				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
 				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
 			);
+			uboBuffers[i]->SetName("Global UBO");
 			uboBuffers[i]->Map();
 		}
 
@@ -82,65 +260,175 @@ namespace Florencia {
 			.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
 			.Build();
 
-		std::vector<VkDescriptorSet> globalDescriptorSets(SwapChain::MAX_FRAMES_IN_FLIGHT);
-		for (int i = 0; i < globalDescriptorSets.size(); i++) {
+		std::vector<VkDescriptorSet> globalDescriptorSets(framesInFlight);
+		for (size_t i = 0; i < globalDescriptorSets.size(); i++) {
 			auto bufferInfo = uboBuffers[i]->DescriptorInfo();
 			DescriptorWriter(*globalSetLayout, *m_GlobalPool)
 				.WriteBuffer(0, &bufferInfo)
 				.Build(globalDescriptorSets[i]);
+			m_Device.SetObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, globalDescriptorSets[i], "Global Set");
 		}
 
-		SimpleRenderSystem simpleRenderSystem(m_Device, m_Renderer.GetSwapChainRenderPass(), globalSetLayout->GetDescriptorSetLayout());
-		PointLightSystem pointLightSystem(m_Device, m_Renderer.GetSwapChainRenderPass(), globalSetLayout->GetDescriptorSetLayout());
+		ClusteredLighting clusteredLighting{ m_Device, framesInFlight };
+		bool deferred = m_Renderer.GetRenderPath() == RenderPath::Deferred;
+		SimpleRenderSystem simpleRenderSystem(m_Device, m_PipelineBuilder, m_Renderer.GetSwapChainRenderTarget(), globalSetLayout->GetDescriptorSetLayout(), clusteredLighting.GetDescriptorSetLayout(), m_Renderer.GetRenderPath());
+		PointLightSystem pointLightSystem(m_Device, m_PipelineBuilder, m_Renderer.GetSwapChainRenderTarget(), globalSetLayout->GetDescriptorSetLayout(), framesInFlight, deferred ? 1 : 0);
+		std::unique_ptr<DeferredLightingSystem> deferredLightingSystem{};
+		if (deferred) { deferredLightingSystem = std::make_unique<DeferredLightingSystem>(m_Device, m_PipelineBuilder, m_Renderer.GetSwapChainRenderPass(), globalSetLayout->GetDescriptorSetLayout(), clusteredLighting.GetDescriptorSetLayout(), framesInFlight); }
+		std::unique_ptr<OcclusionCuller> occlusionCuller{};
+		switch (m_Properties.OcclusionCulling) {
+			case OcclusionCullingMode::HiZ: occlusionCuller = std::make_unique<HiZOcclusionCuller>(m_Device, m_Renderer); break;
+			case OcclusionCullingMode::Software: occlusionCuller = std::make_unique<SoftwareOcclusionCuller>(m_JobSystem); break;
+			default: break;
+		}
 		Camera camera{};
+		simpleRenderSystem.SetDepthPrepassEnabled(m_DepthPrepassEnabled);
+		UpdateWindowTitle();
+
+		//Every system has requested its pipelines, they compile in parallel and are all done after this
+		m_PipelineBuilder.WaitIdle();
+		GpuProfiler gpuProfiler{ m_Device, framesInFlight };
+		if (!m_Properties.GpuTraceOutput.empty()) { gpuProfiler.EnableTrace(); }
+		BenchmarkRunner benchmarkRunner{ m_Properties, m_Device, m_Renderer, m_Window, gpuProfiler };
+		benchmarkRunner.PrintStartup(m_StartTime, m_PipelineBuilder);
+		bool benchmarking = benchmarkRunner.IsBenchmarking();
 
-		auto viewer = GameObject::CreateGameObject();
+		auto viewer = GameObject::CreateGameObject(m_Registry);
 		ObjectController cameraController{};
+		CameraPath cameraPath{};
+		if (m_Properties.CameraPathFile == "orbit") { cameraPath = CameraPath::Orbit(4.0f, -1.5f, 20.0f); }
+		else if (!m_Properties.CameraPathFile.empty()) { cameraPath = CameraPath::Load(m_Properties.CameraPathFile); }
+		CameraPath recordedPath{};
+		float simulationTime = 0.0f;
+
+		FrameArena frameArena{ 64 * 1024, framesInFlight };
+
+		FramePacer framePacer{ m_Renderer };
+		bool lateInput = m_Properties.FrameLoop != FrameLoopMode::Standard;
 
 		auto currentTime = std::chrono::high_resolution_clock::now();
+		float frameTime = 0.0f;
+		float timeStep = 0.0f;
 
-		while (m_Window.IsOpen()) {
+		//Polls events and moves the camera, the standard loop does this before BeginFrame and the late input loops right after it
+		auto sampleInput = [&]() {
+			FLORENCIA_PROFILE_SCOPE("SampleInput");
 			m_Window.Update();
+			framePacer.InputSampled();
 
 			auto newTime = std::chrono::high_resolution_clock::now();
-			float timeStep = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
+			frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
 			currentTime = newTime;
+			//Every run along a camera path then renders the same frames, however long they take
+			timeStep = m_Properties.FixedTimeStep > 0.0f ? m_Properties.FixedTimeStep : frameTime;
+			simulationTime += timeStep;
 
-			cameraController.MoveInPlaneXZ(m_Window.Get(), timeStep, viewer);
-			camera.SetViewYXZ(viewer.m_Transform.translation, viewer.m_Transform.rotation);
+			//The camera stays put while benchmarking without a path so both modes render the same frames
+			if (!cameraPath.IsEmpty()) { cameraPath.Sample(simulationTime, viewer.Transform()); }
+			else if (!benchmarking) { cameraController.MoveInPlaneXZ(m_Window, timeStep, viewer); }
+			if (!m_Properties.RecordCameraPathFile.empty()) { recordedPath.Record(simulationTime, viewer.Transform()); }
+			camera.SetViewYXZ(viewer.Transform().translation, viewer.Transform().rotation);
 
 			float aspect = m_Renderer.GetAspectRatio();
 			camera.SetPerspectiveProjection(glm::radians(70.0f), aspect, 0.01f, 100.0f);
 
-			if (auto commandBuffer = m_Renderer.BeginFrame()) {
+			bool pickButtonPressed = m_Window.IsMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT);
+			if (pickButtonPressed && !m_PickButtonHeld) { PickGameObject(camera); }
+			m_PickButtonHeld = pickButtonPressed;
+
+			bool prepassKeyPressed = m_Window.IsKeyPressed(GLFW_KEY_P);
+			if (prepassKeyPressed && !m_PrepassKeyHeld && !benchmarking) {
+				m_DepthPrepassEnabled = !m_DepthPrepassEnabled;
+				simpleRenderSystem.SetDepthPrepassEnabled(m_DepthPrepassEnabled);
+				UpdateWindowTitle();
+			}
+			m_PrepassKeyHeld = prepassKeyPressed;
+			benchmarkRunner.InputSampled(simpleRenderSystem);
+		};
+
+		FLORENCIA_PROFILE_THREAD("Main");
+		while (m_Window.IsOpen()) {
+			FLORENCIA_PROFILE_SCOPE("Frame");
+			benchmarkRunner.FrameStarted();
+			if (!lateInput) { sampleInput(); }
+			else {
+				FLORENCIA_PROFILE_SCOPE("WaitForFrame");
+				//Everything that can block happens before the input is read, so the camera is as fresh as possible when the UBO is written
+				m_Renderer.WaitForFrame();
+				if (m_Properties.FrameLoop == FrameLoopMode::Deadline) { framePacer.SleepUntilDeadline(); }
+			}
+
+			m_SpatialIndex.Update();
+
+			VkCommandBuffer commandBuffer = m_Renderer.BeginFrame();
+			//Also keeps events flowing when no frame could be started
+			if (lateInput) { sampleInput(); }
+			if (commandBuffer) {
+				auto recordStart = std::chrono::high_resolution_clock::now();
 				int frameIndex = m_Renderer.GetFrameIndex();
+				frameArena.BeginFrame(frameIndex);
+				benchmarkRunner.RecordingStarted(frameIndex, gpuProfiler.BeginFrame(commandBuffer, frameIndex), simpleRenderSystem.IsDepthPrepassEnabled());
 				FrameInfo frameInfo {
 					camera,
 					frameIndex,
 					timeStep,
 					commandBuffer,
 					globalDescriptorSets[frameIndex],
-					m_GameObjects
+					clusteredLighting.GetDescriptorSet(frameIndex),
+					m_Registry,
+					m_SpatialIndex,
+					frameArena,
+					occlusionCuller.get()
 				};
+				if (occlusionCuller) { occlusionCuller->BeginFrame(frameInfo); }
 
 				//Update
-				GlobalUBO ubo{};
-				ubo.m_ProjectionMatrix = camera.GetProjectionMatrix();
-				ubo.m_ViewMatrix = camera.GetViewMatrix();
-				ubo.m_InverseViewMatrix = camera.GetInverseViewMatrix();
-				pointLightSystem.Update(frameInfo, ubo);
-				uboBuffers[frameIndex]->WriteToBuffer(&ubo);
-				uboBuffers[frameIndex]->Flush();
+				{
+					FLORENCIA_PROFILE_SCOPE("UpdateUBO");
+					GlobalUBO ubo{};
+					ubo.m_ProjectionMatrix = camera.GetProjectionMatrix();
+					ubo.m_ViewMatrix = camera.GetViewMatrix();
+					ubo.m_InverseViewMatrix = camera.GetInverseViewMatrix();
+					pointLightSystem.Update(frameInfo, ubo, clusteredLighting);
+					uboBuffers[frameIndex]->WriteToBuffer(&ubo);
+					uboBuffers[frameIndex]->Flush();
+				}
 
 				//Render
-				m_Renderer.BeginSwapChainRenderPass(commandBuffer);
-				simpleRenderSystem.RenderGameObjects(frameInfo);
-				pointLightSystem.Render(frameInfo);
-				m_Renderer.EndSwapChainRenderPass(commandBuffer);
+				{
+					GpuScope renderPassScope{ gpuProfiler, commandBuffer, "RenderPass" };
+					m_Renderer.BeginSwapChainRenderPass(commandBuffer);
+					//Every statistics scope stays within one subpass, queries can't span them
+					{
+						GpuScope scope{ gpuProfiler, commandBuffer, "SimpleRenderSystem", true };
+						simpleRenderSystem.RenderGameObjects(frameInfo);
+					}
+					if (deferred) {
+						m_Renderer.NextSubpass(commandBuffer);
+						GpuScope scope{ gpuProfiler, commandBuffer, "DeferredLightingSystem" };
+						deferredLightingSystem->Render(frameInfo, m_Renderer.GetCurrentGBufferViews(), m_Renderer.GetSwapChainExtent());
+					}
+					{
+						GpuScope scope{ gpuProfiler, commandBuffer, "PointLightSystem", true };
+						pointLightSystem.Render(frameInfo);
+					}
+					m_Renderer.EndSwapChainRenderPass(commandBuffer);
+				}
+				if (occlusionCuller) {
+					GpuScope scope{ gpuProfiler, commandBuffer, "OcclusionReadback" };
+					occlusionCuller->EndFrame(frameInfo);
+				}
+				gpuProfiler.EndFrame(commandBuffer);
 				m_Renderer.EndFrame();
+				framePacer.FramePresented();
+				double cpuMilliseconds = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - recordStart).count();
+				benchmarkRunner.FramePresented(frameTime * 1000.0f, cpuMilliseconds, frameInfo.m_Statistics);
 			}
+			benchmarkRunner.FrameEnded();
 		}
 
 		vkDeviceWaitIdle(m_Device.Get());
+		if (!m_Properties.RecordCameraPathFile.empty()) { recordedPath.Save(m_Properties.RecordCameraPathFile); }
+		benchmarkRunner.PrintSummary(framePacer, frameArena);
 	}
 }
\ No newline at end of file
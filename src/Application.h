@@ -1,17 +1,74 @@
 #pragma once
 #include <memory>
+#include <chrono>
+#include <string>
 
 #include "Descriptors.h"
+#include "PipelineBuilder.h"
+#include "SpatialIndex.h"
 #include "GameObject.h"
+#include "JobSystem.h"
+#include "Camera.h"
 #include "Renderer.h"
 #include "Window.h"
 #include "Device.h"
 
 namespace Florencia {
 
+	enum class OcclusionCullingMode { None, HiZ, Software };
+
+	//LateInput waits for the gpu and acquires the image before reading input, Deadline also sleeps until the latest predicted start
+	enum class FrameLoopMode { Standard, LateInput, Deadline };
+
+	struct ApplicationProps {
+		//Hi-Z adds a depth reduction and readback to every frame, so it is opt-in through --occlusion=hiz
+		OcclusionCullingMode OcclusionCulling = OcclusionCullingMode::None;
+		RenderPath Path = RenderPath::Forward;
+		//Extra point lights spread over the scene, for comparing render paths under load
+		uint32_t LightCount = 0;
+		//Renders this many frames with the depth pre-pass off then on, prints the fragment shader invocations and exits
+		uint32_t DepthPrepassBenchmarkFrames = 0;
+		//Renders this many frames after a warm up, prints the average frame time and exits
+		uint32_t FrameTimeBenchmarkFrames = 0;
+		//Resizes the window every few frames for this many frames, prints how many frames stalled and exits
+		uint32_t ResizeBenchmarkFrames = 0;
+		//Forward path only, renders to the swapchain without a render pass or framebuffers when the device supports it
+		bool DynamicRendering = false;
+		PresentPolicy Present = PresentPolicy::Uncapped;
+		//1 to SwapChain::MaxFramesInFlight
+		uint32_t FramesInFlight = 2;
+		FrameLoopMode FrameLoop = FrameLoopMode::Standard;
+		//Renders into offscreen targets without creating a window or surface, needs a frame limit or a benchmark to ever exit
+		bool Headless = false;
+		//Closes the window after this many frames, 0 runs until it is closed
+		uint32_t FrameLimit = 0;
+		//Headless only, writes every frame to <CapturePath><frame number>.ppm when not empty
+		std::string CapturePath;
+		//Drives the viewer instead of the keyboard, a file written by RecordCameraPathFile or "orbit" for the scripted flythrough
+		std::string CameraPathFile;
+		//Writes the viewer's path to this file on exit when not empty
+		std::string RecordCameraPathFile;
+		//Seconds simulated per frame regardless of how long it took, 0 uses the measured frame time
+		float FixedTimeStep = 0.0f;
+		//With FrameTimeBenchmarkFrames, writes frame time percentiles, gpu time, draw and bind counts and device memory as JSON
+		std::string BenchmarkOutput;
+		//Writes every gpu scope resolved during the run as a Chrome trace event file on exit when not empty
+		std::string GpuTraceOutput;
+		//Writes every cpu zone recorded during the run as a Chrome trace event file on exit, needs FLORENCIA_ENABLE_PROFILING
+		std::string CpuTraceOutput;
+
+		//Recognizes --occlusion=none|hiz|software, --render-path=forward|deferred, --lights=<count>,
+		//--benchmark-prepass=<frames>, --benchmark-frames=<frames>, --benchmark-resize=<frames>, --dynamic-rendering,
+		//--present=low-latency|vsync|uncapped|mailbox, --frames-in-flight=<1-4>, --frame-loop=standard|late-input|deadline,
+		//--headless, --frames=<count>, --capture=<path prefix>, --camera-path=<file>|orbit, --record-camera-path=<file>,
+		//--fixed-timestep=<seconds>, --benchmark-output=<file>, --gpu-trace=<file> and --cpu-trace=<file>, throws with the usage on anything
+		//else and names the flag when a value is malformed
+		static ApplicationProps FromCommandLine(int argc, char** argv);
+	};
+
 	class Application {
 	public:
-		Application();
+		Application(const ApplicationProps& props = ApplicationProps{});
 		~Application() {}
 
 		Application(const Application&) = delete;
@@ -21,13 +78,26 @@ namespace Florencia {
 
 	private:
 		void LoadGameObjects();
+		void PickGameObject(const Camera& camera);
+		void UpdateWindowTitle();
 
-		Window m_Window{WindowProps(800, 600, "Vulkan Tutorial")};
+		//Initialized first so startup time covers device creation
+		std::chrono::high_resolution_clock::time_point m_StartTime = std::chrono::high_resolution_clock::now();
+		ApplicationProps m_Properties;
+		Window m_Window{WindowProps(800, 600, "Vulkan Tutorial", m_Properties.Headless)};
 		Device m_Device{m_Window};
-		Renderer m_Renderer{m_Window, m_Device};
+		Renderer m_Renderer{m_Window, m_Device, SwapChainProps{m_Properties.Path, m_Properties.DynamicRendering, m_Properties.Present, m_Properties.FramesInFlight}};
 
+		JobSystem m_JobSystem{};
+		PipelineBuilder m_PipelineBuilder{m_Device, m_JobSystem};
 		std::unique_ptr<DescriptorPool> m_GlobalPool{};
-		GameObject::Map_t m_GameObjects;
+		Registry m_Registry;
+		SpatialIndex m_SpatialIndex{m_Registry};
+		Entity m_SelectedEntity{};
+		bool m_PickButtonHeld = false;
+		bool m_PrepassKeyHeld = false;
+		//Toggled with P and shown in the window title
+		bool m_DepthPrepassEnabled = false;
 	};
 
 }
\ No newline at end of file
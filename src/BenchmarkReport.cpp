@@ -0,0 +1,93 @@
+#include "BenchmarkReport.h"
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+#include <cmath>
+
+namespace Florencia {
+
+	namespace {
+
+		std::string Quote(const std::string& text) {
+			std::string quoted = "\"";
+			for (char c : text) {
+				if (c == '"' || c == '\\') { quoted += '\\'; }
+				quoted += c;
+			}
+			return quoted + "\"";
+		}
+
+	}
+
+	void BenchmarkReport::AddFrame(double frameMilliseconds, double cpuMilliseconds, const RenderStatistics& statistics) {
+		m_FrameMilliseconds.push_back(frameMilliseconds);
+		m_CpuMilliseconds.push_back(cpuMilliseconds);
+		m_DrawCalls.push_back(statistics.m_DrawCalls);
+		m_PipelineBinds.push_back(statistics.m_PipelineBinds);
+		m_DescriptorSetBinds.push_back(statistics.m_DescriptorSetBinds);
+		m_VertexBufferBinds.push_back(statistics.m_VertexBufferBinds);
+	}
+
+	void BenchmarkReport::Reserve(size_t frames) {
+		m_FrameMilliseconds.reserve(frames);
+		m_CpuMilliseconds.reserve(frames);
+		m_GpuMilliseconds.reserve(frames);
+		m_DrawCalls.reserve(frames);
+		m_PipelineBinds.reserve(frames);
+		m_DescriptorSetBinds.reserve(frames);
+		m_VertexBufferBinds.reserve(frames);
+	}
+
+	//Nearest rank percentiles
+	BenchmarkReport::Summary BenchmarkReport::Summarize(std::vector<double> samples) {
+		Summary summary{};
+		if (samples.empty()) { return summary; }
+		std::sort(samples.begin(), samples.end());
+		auto percentile = [&](double p) { return samples[std::min(samples.size() - 1, static_cast<size_t>(std::ceil(p * samples.size())) - 1)]; };
+		summary.m_Mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+		summary.m_P50 = percentile(0.50);
+		summary.m_P90 = percentile(0.90);
+		summary.m_P99 = percentile(0.99);
+		summary.m_Max = samples.back();
+		return summary;
+	}
+
+	double BenchmarkReport::Average(const std::vector<uint32_t>& samples) {
+		if (samples.empty()) { return 0.0; }
+		return std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+	}
+
+	void BenchmarkReport::WriteJson(const std::string& path) const {
+		std::ofstream file(path);
+		if (!file) throw std::runtime_error("Failed to Write Benchmark Report " + path);
+
+		auto writeSummary = [&](const char* name, const std::vector<double>& samples) {
+			Summary summary = Summarize(samples);
+			file << "\t" << Quote(name) << ": { \"samples\": " << samples.size() << ", \"mean\": " << summary.m_Mean << ", \"p50\": " << summary.m_P50
+				<< ", \"p90\": " << summary.m_P90 << ", \"p99\": " << summary.m_P99 << ", \"max\": " << summary.m_Max << " },\n";
+		};
+
+		file << "{\n\t\"settings\": {";
+		for (size_t i = 0; i < m_Settings.size(); i++) {
+			file << (i == 0 ? " " : ", ") << Quote(m_Settings[i].first) << ": " << Quote(m_Settings[i].second);
+		}
+		file << " },\n";
+		file << "\t\"frames\": " << m_FrameMilliseconds.size() << ",\n";
+		writeSummary("frameTimeMs", m_FrameMilliseconds);
+		writeSummary("cpuTimeMs", m_CpuMilliseconds);
+		writeSummary("gpuTimeMs", m_GpuMilliseconds);
+		file << "\t\"perFrame\": { \"drawCalls\": " << Average(m_DrawCalls) << ", \"pipelineBinds\": " << Average(m_PipelineBinds)
+			<< ", \"descriptorSetBinds\": " << Average(m_DescriptorSetBinds) << ", \"vertexBufferBinds\": " << Average(m_VertexBufferBinds) << " },\n";
+		file << "\t\"deviceMemory\": { \"allocations\": " << m_Memory.m_AllocationCount << ", \"bytes\": " << m_Memory.m_AllocatedBytes
+			<< ", \"peakBytes\": " << m_Memory.m_PeakAllocatedBytes << " }" << (AllocationTracker::Enabled ? ",\n" : "\n");
+		if (AllocationTracker::Enabled) {
+			double frames = static_cast<double>(std::max(m_Allocations.m_Frames, 1u));
+			file << "\t\"hostAllocations\": { \"frames\": " << m_Allocations.m_Frames << ", \"framesWithHeapAllocations\": " << m_Allocations.m_FramesWithHeapAllocations
+				<< ", \"heapPerFrame\": " << static_cast<double>(m_Allocations.m_HeapAllocations) / frames << ", \"heapMax\": " << m_Allocations.m_MaxHeapAllocations
+				<< ", \"vulkanPerFrame\": " << static_cast<double>(m_Allocations.m_VulkanAllocations) / frames << ", \"vulkanMax\": " << m_Allocations.m_MaxVulkanAllocations << " }\n";
+		}
+		file << "}\n";
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "AllocationTracker.h"
+#include "FrameInfo.h"
+#include "Device.h"
+
+namespace Florencia {
+
+	//Per frame measurements of a benchmark run, summarized as percentiles and written as JSON so runs can be compared across commits
+	class BenchmarkReport {
+	public:
+		//Written under "settings" so a result can be matched with the run that produced it
+		void AddSetting(const std::string& name, const std::string& value) { m_Settings.emplace_back(name, value); }
+		//frameMilliseconds is the time between frames, cpuMilliseconds the part spent recording and submitting
+		void AddFrame(double frameMilliseconds, double cpuMilliseconds, const RenderStatistics& statistics);
+		//Gpu times arrive frames in flight late, so they are kept apart from the frame they belong to
+		void AddGpuTime(double milliseconds) { m_GpuMilliseconds.push_back(milliseconds); }
+		void SetMemory(const DeviceMemoryStatistics& memory) { m_Memory = memory; }
+		//Written only when AllocationTracker::Enabled, the counts are all zero otherwise
+		void SetAllocations(const FrameAllocationStatistics& allocations) { m_Allocations = allocations; }
+		//Keeps AddFrame and AddGpuTime from allocating during the frames they measure
+		void Reserve(size_t frames);
+
+		size_t GetFrameCount() const { return m_FrameMilliseconds.size(); }
+		void WriteJson(const std::string& path) const;
+
+	private:
+		struct Summary {
+			double m_Mean = 0.0;
+			double m_P50 = 0.0;
+			double m_P90 = 0.0;
+			double m_P99 = 0.0;
+			double m_Max = 0.0;
+		};
+		static Summary Summarize(std::vector<double> samples);
+		static double Average(const std::vector<uint32_t>& samples);
+
+		std::vector<std::pair<std::string, std::string>> m_Settings;
+		std::vector<double> m_FrameMilliseconds;
+		std::vector<double> m_CpuMilliseconds;
+		std::vector<double> m_GpuMilliseconds;
+		std::vector<uint32_t> m_DrawCalls;
+		std::vector<uint32_t> m_PipelineBinds;
+		std::vector<uint32_t> m_DescriptorSetBinds;
+		std::vector<uint32_t> m_VertexBufferBinds;
+		DeviceMemoryStatistics m_Memory{};
+		FrameAllocationStatistics m_Allocations{};
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "BenchmarkRunner.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Application.h"
+#include "CpuProfiler.h"
+
+namespace Florencia {
+
+	BenchmarkRunner::BenchmarkRunner(const ApplicationProps& properties, Device& device, Renderer& renderer, Window& window, GpuProfiler& gpuProfiler)
+		: m_Properties{ properties }, m_Device{ device }, m_Renderer{ renderer }, m_Window{ window }, m_GpuProfiler{ gpuProfiler },
+		m_PrepassBenchmark{ properties.DepthPrepassBenchmarkFrames > 0 }, m_FrameTimeBenchmark{ properties.FrameTimeBenchmarkFrames > 0 },
+		m_ResizeBenchmark{ properties.ResizeBenchmarkFrames > 0 }, m_WriteReport{ !properties.BenchmarkOutput.empty() },
+		m_StatisticsPrepassEnabled(renderer.GetFramesInFlight(), false) {
+		if (m_PrepassBenchmark && (!gpuProfiler.IsSupported() || !gpuProfiler.SupportsStatistics() || renderer.GetRenderPath() == RenderPath::Deferred)) {
+			throw std::runtime_error("Depth Pre-pass Benchmark Requires Pipeline Statistics Queries And The Forward Path");
+		}
+		if (m_WriteReport) { m_Report.Reserve(properties.FrameTimeBenchmarkFrames + 1); }
+		if (m_ResizeBenchmark) { m_ResizeFrameTimes.reserve(properties.ResizeBenchmarkFrames); }
+	}
+
+	void BenchmarkRunner::InputSampled(SimpleRenderSystem& simpleRenderSystem) {
+		if (m_PrepassBenchmark) { simpleRenderSystem.SetDepthPrepassEnabled(m_PrepassFrame++ >= m_Properties.DepthPrepassBenchmarkFrames); }
+	}
+
+	void BenchmarkRunner::RecordingStarted(int frameIndex, bool gpuFrameResolved, bool depthPrepassEnabled) {
+		if (m_WriteReport && gpuFrameResolved && m_RenderedFrames > WarmupFrames) { m_Report.AddGpuTime(m_GpuProfiler.GetResolvedFrameMilliseconds()); }
+
+		GpuPipelineStatistics opaqueStatistics{}, lightStatistics{};
+		if (m_PrepassBenchmark && gpuFrameResolved && m_GpuProfiler.GetResolvedStatistics("SimpleRenderSystem", opaqueStatistics)) {
+			m_GpuProfiler.GetResolvedStatistics("PointLightSystem", lightStatistics);
+			int mode = m_StatisticsPrepassEnabled[frameIndex] ? 1 : 0;
+			m_PrepassInvocations[mode] += opaqueStatistics.m_FragmentShaderInvocations + lightStatistics.m_FragmentShaderInvocations;
+			m_PrepassSamples[mode]++;
+			if (m_PrepassSamples[1] >= m_Properties.DepthPrepassBenchmarkFrames) {
+				std::cout << "Fragment Shader Invocations Per Frame, Pre-pass Off: " << m_PrepassInvocations[0] / std::max(m_PrepassSamples[0], 1u)
+					<< ", Pre-pass On: " << m_PrepassInvocations[1] / m_PrepassSamples[1] << "\n";
+				m_Window.Close();
+			}
+		}
+		m_StatisticsPrepassEnabled[frameIndex] = depthPrepassEnabled;
+	}
+
+	void BenchmarkRunner::FramePresented(float frameMilliseconds, double cpuMilliseconds, const RenderStatistics& statistics) {
+		if (++m_RenderedFrames == m_Properties.FrameLimit) { m_Window.Close(); }
+
+		if (m_FrameTimeBenchmark && m_RenderedFrames == WarmupFrames) { m_FrameTimeStart = std::chrono::high_resolution_clock::now(); }
+		if (m_WriteReport && m_RenderedFrames > WarmupFrames) { m_Report.AddFrame(frameMilliseconds, cpuMilliseconds, statistics); }
+		if (m_FrameTimeBenchmark && m_RenderedFrames == WarmupFrames + m_Properties.FrameTimeBenchmarkFrames) { FinishFrameTimeBenchmark(); }
+
+		if (m_ResizeBenchmark && m_RenderedFrames > WarmupFrames) {
+			m_ResizeFrameTimes.push_back(frameMilliseconds);
+			if (m_ResizeFrameTimes.size() % ResizeInterval == 0) {
+				bool large = (m_ResizeFrameTimes.size() / ResizeInterval) % 2 == 0;
+				m_Window.SetSize(large ? 800 : 640, large ? 600 : 480);
+			}
+			if (m_ResizeFrameTimes.size() == m_Properties.ResizeBenchmarkFrames) { FinishResizeBenchmark(); }
+		}
+	}
+
+	void BenchmarkRunner::FinishFrameTimeBenchmark() {
+		bool deferred = m_Renderer.GetRenderPath() == RenderPath::Deferred;
+		float elapsed = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - m_FrameTimeStart).count();
+		std::cout << "Render Path: " << (deferred ? "Deferred" : "Forward") << ", Lights: " << m_Properties.LightCount
+			<< ", Average Frame Time: " << elapsed / static_cast<float>(m_Properties.FrameTimeBenchmarkFrames) << " ms\n";
+		if (m_WriteReport) {
+			VkExtent2D extent = m_Renderer.GetSwapChainExtent();
+			m_Report.AddSetting("device", m_Device.properties.deviceName);
+			m_Report.AddSetting("renderPath", deferred ? "deferred" : "forward");
+			m_Report.AddSetting("lights", std::to_string(m_Properties.LightCount));
+			m_Report.AddSetting("framesInFlight", std::to_string(m_Renderer.GetFramesInFlight()));
+			m_Report.AddSetting("headless", m_Properties.Headless ? "true" : "false");
+			m_Report.AddSetting("cameraPath", m_Properties.CameraPathFile);
+			m_Report.AddSetting("fixedTimeStep", std::to_string(m_Properties.FixedTimeStep));
+			m_Report.AddSetting("extent", std::to_string(extent.width) + "x" + std::to_string(extent.height));
+			m_Report.SetMemory(m_Device.GetMemoryStatistics());
+			m_Report.SetAllocations(m_AllocationCounter.GetStatistics());
+			m_Report.WriteJson(m_Properties.BenchmarkOutput);
+			std::cout << "Benchmark Report: " << m_Properties.BenchmarkOutput << "\n";
+		}
+		m_Window.Close();
+	}
+
+	void BenchmarkRunner::FinishResizeBenchmark() {
+		//A frame counts as stalled when it takes more than twice the median frame time
+		std::vector<float> sorted = m_ResizeFrameTimes;
+		std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+		float stallTime = 2.0f * sorted[sorted.size() / 2];
+		auto stalledFrames = std::count_if(m_ResizeFrameTimes.begin(), m_ResizeFrameTimes.end(), [&](float frameTime) { return frameTime > stallTime; });
+		std::cout << "Resize Stress: " << m_ResizeFrameTimes.size() << " Frames, " << m_Renderer.GetSwapChainRecreationCount() << " Swapchain Recreations, Stalled Frames: "
+			<< stalledFrames << " (Over " << stallTime << " ms), Worst Frame: " << *std::max_element(m_ResizeFrameTimes.begin(), m_ResizeFrameTimes.end()) << " ms\n";
+		m_Window.Close();
+	}
+
+	void BenchmarkRunner::PrintStartup(std::chrono::high_resolution_clock::time_point startTime, PipelineBuilder& pipelineBuilder) {
+		//Compare a run without pipeline_cache.bin (cold) against the next one (warm)
+		float startupTime = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+		std::cout << "Startup Time: " << startupTime << " ms, Pipeline Cache: " << (m_Device.IsPipelineCacheWarm() ? "Warm" : "Cold")
+			<< ", Shader Modules: " << pipelineBuilder.GetShaderModuleCount() << ", Pipelines: " << pipelineBuilder.GetPipelineCount()
+			<< " (" << pipelineBuilder.GetSharedBuildCount() << " Shared Builds), Pipeline Libraries: " << pipelineBuilder.GetLibraryCount() << "\n";
+	}
+
+	void BenchmarkRunner::PrintSummary(const FramePacer& framePacer, const FrameArena& frameArena) {
+		TimelineWaitStatistics waitStatistics = m_Device.GetTimelineWaitStatistics();
+		std::cout << "Blocking Timeline Waits: " << waitStatistics.m_WaitCount << " (" << waitStatistics.m_WaitMilliseconds << " ms)\n";
+		FrameLatencyStatistics latency = framePacer.GetStatistics();
+		std::cout << "Input To Present: " << latency.m_AverageInputToPresentMilliseconds << " ms Average, " << latency.m_MaxInputToPresentMilliseconds << " ms Max, Input To Display: ";
+		if (latency.m_DisplayedFrames > 0) { std::cout << latency.m_AverageInputToDisplayMilliseconds << " ms Average\n"; }
+		else { std::cout << (m_Device.SupportsPresentWait() ? "No Frames Displayed\n" : "Needs VK_KHR_present_wait\n"); }
+		std::cout << "Gpu Scopes, Average Of The Last " << GpuProfiler::AverageWindow << " Frames:";
+		if (m_GpuProfiler.GetAverages().empty()) { std::cout << (m_GpuProfiler.IsSupported() ? " None Resolved" : " Timestamps Not Supported"); }
+		for (const GpuScopeAverage& average : m_GpuProfiler.GetAverages()) { std::cout << " " << average.m_Name << " " << average.m_AverageMilliseconds << " ms,"; }
+		std::cout << "\n";
+		std::cout << "Frame Arena: " << frameArena.GetPeakBytes() << " Bytes Peak, " << frameArena.GetCapacity() << " Bytes Reserved, " << frameArena.GetOverflowCount() << " Overflows\n";
+		if (AllocationTracker::Enabled) {
+			const FrameAllocationStatistics& allocations = m_AllocationCounter.GetStatistics();
+			double frames = static_cast<double>(std::max(allocations.m_Frames, 1u));
+			std::cout << "Allocations Per Frame After Warm Up: Heap " << static_cast<double>(allocations.m_HeapAllocations) / frames << " Average, " << allocations.m_MaxHeapAllocations
+				<< " Max (" << allocations.m_FramesWithHeapAllocations << " Of " << allocations.m_Frames << " Frames Allocated), Vulkan Host "
+				<< static_cast<double>(allocations.m_VulkanAllocations) / frames << " Average, " << allocations.m_MaxVulkanAllocations << " Max\n";
+			VulkanAllocationStatistics vulkan = AllocationTracker::GetVulkanStatistics();
+			std::cout << "Vulkan Host Memory:";
+			for (uint32_t i = 0; i < VulkanAllocationStatistics::ScopeCount; i++) {
+				std::cout << " " << AllocationTracker::GetScopeName(i) << " " << vulkan.m_Scopes[i].m_Bytes << " Bytes (" << vulkan.m_Scopes[i].m_PeakBytes << " Peak, "
+					<< vulkan.m_Scopes[i].m_Allocations + vulkan.m_Scopes[i].m_Reallocations << " Calls),";
+			}
+			std::cout << " Internal " << vulkan.m_InternalBytes << " Bytes\n";
+		}
+		if (!m_Properties.GpuTraceOutput.empty()) {
+			m_GpuProfiler.WriteTrace(m_Properties.GpuTraceOutput);
+			std::cout << "Gpu Trace: " << m_Properties.GpuTraceOutput << "\n";
+		}
+		if (!m_Properties.CpuTraceOutput.empty()) {
+			CpuProfiler::WriteTrace(m_Properties.CpuTraceOutput);
+			std::cout << "Cpu Trace: " << CpuProfiler::GetEventCount() << " Zones To " << m_Properties.CpuTraceOutput << "\n";
+		}
+		//Captures still pending are written when the Renderer is destroyed
+		if (!m_Properties.CapturePath.empty()) { std::cout << "Captured Frames: " << m_RenderedFrames << " To " << m_Properties.CapturePath << "*.ppm\n"; }
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+#include "Systems/SimpleRenderSystem.h"
+#include "AllocationTracker.h"
+#include "BenchmarkReport.h"
+#include "PipelineBuilder.h"
+#include "GpuProfiler.h"
+#include "FrameArena.h"
+#include "FramePacer.h"
+#include "Renderer.h"
+#include "Window.h"
+#include "Device.h"
+
+namespace Florencia {
+
+	struct ApplicationProps;
+
+	//Runs the benchmarks selected in ApplicationProps alongside the frame loop, counts the rendered frames and closes the
+	//window once the run is over, every statistic printed by the application goes through here
+	class BenchmarkRunner {
+	public:
+		//Frame time, resize stalls and allocations are only measured after this many frames, so pipeline creation and first uploads are not included
+		static constexpr uint32_t WarmupFrames = 60;
+		//The resize benchmark alternates the window between two sizes every this many frames
+		static constexpr uint32_t ResizeInterval = 4;
+
+		BenchmarkRunner(const ApplicationProps& properties, Device& device, Renderer& renderer, Window& window, GpuProfiler& gpuProfiler);
+
+		BenchmarkRunner(const BenchmarkRunner&) = delete;
+		BenchmarkRunner& operator=(const BenchmarkRunner&) = delete;
+
+		//Input that changes what is rendered is ignored while benchmarking, so every run renders the same frames
+		bool IsBenchmarking() const { return m_PrepassBenchmark || m_FrameTimeBenchmark || m_ResizeBenchmark; }
+		uint32_t GetRenderedFrames() const { return m_RenderedFrames; }
+
+		//Per frame callbacks, in the order the frame loop makes them
+		void FrameStarted() { m_AllocationCounter.BeginFrame(); }
+		//Picks the depth pre-pass mode of the frame while the pre-pass benchmark runs
+		void InputSampled(SimpleRenderSystem& simpleRenderSystem);
+		//Call after GpuProfiler::BeginFrame, gpuFrameResolved is what it returned
+		void RecordingStarted(int frameIndex, bool gpuFrameResolved, bool depthPrepassEnabled);
+		//frameMilliseconds is the time between frames, cpuMilliseconds the part spent recording and submitting
+		void FramePresented(float frameMilliseconds, double cpuMilliseconds, const RenderStatistics& statistics);
+		void FrameEnded() { m_AllocationCounter.EndFrame(m_RenderedFrames > WarmupFrames); }
+
+		//Call once every system has requested its pipelines and they have been built
+		void PrintStartup(std::chrono::high_resolution_clock::time_point startTime, PipelineBuilder& pipelineBuilder);
+		//Call after the device is idle, also writes the requested traces
+		void PrintSummary(const FramePacer& framePacer, const FrameArena& frameArena);
+
+	private:
+		void FinishFrameTimeBenchmark();
+		void FinishResizeBenchmark();
+
+		const ApplicationProps& m_Properties;
+		Device& m_Device;
+		Renderer& m_Renderer;
+		Window& m_Window;
+		GpuProfiler& m_GpuProfiler;
+		bool m_PrepassBenchmark;
+		bool m_FrameTimeBenchmark;
+		bool m_ResizeBenchmark;
+		bool m_WriteReport;
+		uint32_t m_RenderedFrames = 0;
+
+		//Fragment invocations are read back frames in flight frames late, so the mode each query was recorded with is kept
+		std::vector<bool> m_StatisticsPrepassEnabled;
+		uint32_t m_PrepassFrame = 0;
+		uint64_t m_PrepassInvocations[2] = { 0, 0 };
+		uint32_t m_PrepassSamples[2] = { 0, 0 };
+
+		std::chrono::high_resolution_clock::time_point m_FrameTimeStart{};
+		std::vector<float> m_ResizeFrameTimes;
+		BenchmarkReport m_Report{};
+		//Frames after the warm up should not allocate, with FLORENCIA_TRACK_ALLOCATIONS every one that does is counted
+		FrameAllocationCounter m_AllocationCounter{};
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Florencia {
+
+	int32_t BoundingVolumeHierarchy::CreateProxy(const AABB& bounds, Entity entity, uint32_t layers) {
+		int32_t proxy = AllocateNode();
+		m_Nodes[proxy].m_Bounds = bounds.Inflate(m_Margin);
+		m_Nodes[proxy].m_Entity = entity;
+		m_Nodes[proxy].m_Layers = layers;
+		m_Nodes[proxy].m_Height = 0;
+		InsertLeaf(proxy);
+		m_ProxyCount++;
+		return proxy;
+	}
+
+	void BoundingVolumeHierarchy::DestroyProxy(int32_t proxy) {
+		assert(proxy >= 0 && proxy < static_cast<int32_t>(m_Nodes.size()) && m_Nodes[proxy].IsLeaf());
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		m_ProxyCount--;
+	}
+
+	bool BoundingVolumeHierarchy::MoveProxy(int32_t proxy, const AABB& bounds) {
+		if (m_Nodes[proxy].m_Bounds.Contains(bounds)) { return false; }
+		RemoveLeaf(proxy);
+		m_Nodes[proxy].m_Bounds = bounds.Inflate(m_Margin);
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	void BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, uint32_t layers, std::vector<Entity>& results) const {
+		if (m_Root == NullNode) { return; }
+		m_Stack.clear();
+		m_Stack.push_back(m_Root);
+		while (!m_Stack.empty()) {
+			const Node& node = m_Nodes[m_Stack.back()];
+			int32_t index = m_Stack.back();
+			m_Stack.pop_back();
+			if ((node.m_Layers & layers) == 0) { continue; }
+
+			Frustum::Containment containment = frustum.Classify(node.m_Bounds);
+			if (containment == Frustum::Containment::Outside) { continue; }
+			if (containment == Frustum::Containment::Inside) {
+				//Whole subtree is visible, skip the remaining plane tests
+				CollectLeaves(index, layers, results);
+				continue;
+			}
+			if (node.IsLeaf()) {
+				results.push_back(node.m_Entity);
+				continue;
+			}
+			m_Stack.push_back(node.m_Child1);
+			m_Stack.push_back(node.m_Child2);
+		}
+	}
+
+	void BoundingVolumeHierarchy::QuerySphere(const glm::vec3& center, float radius, uint32_t layers, std::vector<Entity>& results) const {
+		if (m_Root == NullNode) { return; }
+		m_Stack.clear();
+		m_Stack.push_back(m_Root);
+		while (!m_Stack.empty()) {
+			const Node& node = m_Nodes[m_Stack.back()];
+			m_Stack.pop_back();
+			if ((node.m_Layers & layers) == 0 || !node.m_Bounds.Intersects(center, radius)) { continue; }
+			if (node.IsLeaf()) {
+				results.push_back(node.m_Entity);
+				continue;
+			}
+			m_Stack.push_back(node.m_Child1);
+			m_Stack.push_back(node.m_Child2);
+		}
+	}
+
+	void BoundingVolumeHierarchy::QueryBounds(const AABB& bounds, uint32_t layers, std::vector<Entity>& results) const {
+		if (m_Root == NullNode) { return; }
+		m_Stack.clear();
+		m_Stack.push_back(m_Root);
+		while (!m_Stack.empty()) {
+			const Node& node = m_Nodes[m_Stack.back()];
+			m_Stack.pop_back();
+			if ((node.m_Layers & layers) == 0 || !node.m_Bounds.Intersects(bounds)) { continue; }
+			if (node.IsLeaf()) {
+				results.push_back(node.m_Entity);
+				continue;
+			}
+			m_Stack.push_back(node.m_Child1);
+			m_Stack.push_back(node.m_Child2);
+		}
+	}
+
+	bool BoundingVolumeHierarchy::RayCast(const Ray& ray, uint32_t layers, float maxDistance, Entity& hit, float& distance) const {
+		if (m_Root == NullNode) { return false; }
+		bool found = false;
+		float closest = maxDistance;
+		m_Stack.clear();
+		m_Stack.push_back(m_Root);
+		while (!m_Stack.empty()) {
+			const Node& node = m_Nodes[m_Stack.back()];
+			m_Stack.pop_back();
+			float entry;
+			//Subtrees further away than the closest hit so far are skipped
+			if ((node.m_Layers & layers) == 0 || !ray.Intersects(node.m_Bounds, closest, entry)) { continue; }
+			if (node.IsLeaf()) {
+				closest = entry;
+				hit = node.m_Entity;
+				found = true;
+				continue;
+			}
+			m_Stack.push_back(node.m_Child1);
+			m_Stack.push_back(node.m_Child2);
+		}
+		distance = closest;
+		return found;
+	}
+
+	void BoundingVolumeHierarchy::CollectLeaves(int32_t node, uint32_t layers, std::vector<Entity>& results) const {
+		//Uses its own stack since the caller is still iterating m_Stack
+		m_CollectStack.clear();
+		m_CollectStack.push_back(node);
+		while (!m_CollectStack.empty()) {
+			const Node& current = m_Nodes[m_CollectStack.back()];
+			m_CollectStack.pop_back();
+			if ((current.m_Layers & layers) == 0) { continue; }
+			if (current.IsLeaf()) {
+				results.push_back(current.m_Entity);
+				continue;
+			}
+			m_CollectStack.push_back(current.m_Child1);
+			m_CollectStack.push_back(current.m_Child2);
+		}
+	}
+
+	int32_t BoundingVolumeHierarchy::AllocateNode() {
+		if (m_FreeList == NullNode) {
+			m_Nodes.emplace_back();
+			return static_cast<int32_t>(m_Nodes.size() - 1);
+		}
+		int32_t node = m_FreeList;
+		m_FreeList = m_Nodes[node].m_Parent;
+		m_Nodes[node] = Node{};
+		return node;
+	}
+
+	void BoundingVolumeHierarchy::FreeNode(int32_t node) {
+		m_Nodes[node].m_Parent = m_FreeList;
+		m_Nodes[node].m_Height = -1;
+		m_Nodes[node].m_Child1 = NullNode;
+		m_Nodes[node].m_Child2 = NullNode;
+		m_FreeList = node;
+	}
+
+	void BoundingVolumeHierarchy::InsertLeaf(int32_t leaf) {
+		if (m_Root == NullNode) {
+			m_Root = leaf;
+			m_Nodes[leaf].m_Parent = NullNode;
+			return;
+		}
+
+		//Descend picking the child that adds the least surface area (branch and bound cost heuristic)
+		const AABB leafBounds = m_Nodes[leaf].m_Bounds;
+		int32_t index = m_Root;
+		while (!m_Nodes[index].IsLeaf()) {
+			const Node& node = m_Nodes[index];
+			float area = node.m_Bounds.SurfaceArea();
+			float combinedArea = node.m_Bounds.Merge(leafBounds).SurfaceArea();
+			float cost = 2.0f * combinedArea;
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](int32_t child) {
+				float merged = m_Nodes[child].m_Bounds.Merge(leafBounds).SurfaceArea();
+				if (m_Nodes[child].IsLeaf()) { return merged + inheritanceCost; }
+				return (merged - m_Nodes[child].m_Bounds.SurfaceArea()) + inheritanceCost;
+			};
+			float cost1 = childCost(node.m_Child1);
+			float cost2 = childCost(node.m_Child2);
+
+			if (cost < cost1 && cost < cost2) { break; }
+			index = cost1 < cost2 ? node.m_Child1 : node.m_Child2;
+		}
+
+		int32_t sibling = index;
+		int32_t oldParent = m_Nodes[sibling].m_Parent;
+		int32_t newParent = AllocateNode();
+		m_Nodes[newParent].m_Parent = oldParent;
+		m_Nodes[newParent].m_Bounds = leafBounds.Merge(m_Nodes[sibling].m_Bounds);
+		m_Nodes[newParent].m_Layers = m_Nodes[leaf].m_Layers | m_Nodes[sibling].m_Layers;
+		m_Nodes[newParent].m_Height = m_Nodes[sibling].m_Height + 1;
+		m_Nodes[newParent].m_Child1 = sibling;
+		m_Nodes[newParent].m_Child2 = leaf;
+		m_Nodes[sibling].m_Parent = newParent;
+		m_Nodes[leaf].m_Parent = newParent;
+
+		if (oldParent == NullNode) { m_Root = newParent; }
+		else if (m_Nodes[oldParent].m_Child1 == sibling) { m_Nodes[oldParent].m_Child1 = newParent; }
+		else { m_Nodes[oldParent].m_Child2 = newParent; }
+
+		Refit(m_Nodes[leaf].m_Parent);
+	}
+
+	void BoundingVolumeHierarchy::RemoveLeaf(int32_t leaf) {
+		if (leaf == m_Root) {
+			m_Root = NullNode;
+			return;
+		}
+
+		int32_t parent = m_Nodes[leaf].m_Parent;
+		int32_t grandParent = m_Nodes[parent].m_Parent;
+		int32_t sibling = m_Nodes[parent].m_Child1 == leaf ? m_Nodes[parent].m_Child2 : m_Nodes[parent].m_Child1;
+
+		if (grandParent == NullNode) {
+			m_Root = sibling;
+			m_Nodes[sibling].m_Parent = NullNode;
+			FreeNode(parent);
+			return;
+		}
+
+		if (m_Nodes[grandParent].m_Child1 == parent) { m_Nodes[grandParent].m_Child1 = sibling; }
+		else { m_Nodes[grandParent].m_Child2 = sibling; }
+		m_Nodes[sibling].m_Parent = grandParent;
+		FreeNode(parent);
+		Refit(grandParent);
+	}
+
+	void BoundingVolumeHierarchy::Refit(int32_t index) {
+		while (index != NullNode) {
+			index = Balance(index);
+			Node& node = m_Nodes[index];
+			const Node& child1 = m_Nodes[node.m_Child1];
+			const Node& child2 = m_Nodes[node.m_Child2];
+			node.m_Height = 1 + std::max(child1.m_Height, child2.m_Height);
+			node.m_Bounds = child1.m_Bounds.Merge(child2.m_Bounds);
+			node.m_Layers = child1.m_Layers | child2.m_Layers;
+			index = node.m_Parent;
+		}
+	}
+
+	int32_t BoundingVolumeHierarchy::Balance(int32_t iA) {
+		//Rotates a taller grandchild up when the subtree heights differ by more than one, returns the new subtree root
+		Node& A = m_Nodes[iA];
+		if (A.IsLeaf() || A.m_Height < 2) { return iA; }
+
+		int32_t iB = A.m_Child1;
+		int32_t iC = A.m_Child2;
+		Node& B = m_Nodes[iB];
+		Node& C = m_Nodes[iC];
+		int32_t balance = C.m_Height - B.m_Height;
+
+		auto rotate = [&](int32_t iUp, int32_t iOther) {
+			Node& up = m_Nodes[iUp];
+			int32_t iF = up.m_Child1;
+			int32_t iG = up.m_Child2;
+			Node& F = m_Nodes[iF];
+			Node& G = m_Nodes[iG];
+
+			up.m_Child1 = iA;
+			up.m_Parent = A.m_Parent;
+			A.m_Parent = iUp;
+
+			if (up.m_Parent == NullNode) { m_Root = iUp; }
+			else if (m_Nodes[up.m_Parent].m_Child1 == iA) { m_Nodes[up.m_Parent].m_Child1 = iUp; }
+			else { m_Nodes[up.m_Parent].m_Child2 = iUp; }
+
+			//The taller grandchild stays with the rotated node, the shorter one moves under A
+			int32_t iKeep = F.m_Height > G.m_Height ? iF : iG;
+			int32_t iMove = iKeep == iF ? iG : iF;
+			up.m_Child2 = iKeep;
+			if (A.m_Child1 == iUp) { A.m_Child1 = iMove; }
+			else { A.m_Child2 = iMove; }
+			m_Nodes[iMove].m_Parent = iA;
+
+			const Node& other = m_Nodes[iOther];
+			const Node& moved = m_Nodes[iMove];
+			const Node& kept = m_Nodes[iKeep];
+			A.m_Bounds = other.m_Bounds.Merge(moved.m_Bounds);
+			A.m_Layers = other.m_Layers | moved.m_Layers;
+			A.m_Height = 1 + std::max(other.m_Height, moved.m_Height);
+			up.m_Bounds = A.m_Bounds.Merge(kept.m_Bounds);
+			up.m_Layers = A.m_Layers | kept.m_Layers;
+			up.m_Height = 1 + std::max(A.m_Height, kept.m_Height);
+			return iUp;
+		};
+
+		if (balance > 1) { return rotate(iC, iB); }
+		if (balance < -1) { return rotate(iB, iC); }
+		return iA;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Registry.h"
+#include "Bounds.h"
+
+namespace Florencia {
+
+	namespace SpatialLayer {
+		constexpr uint32_t Renderable = 1 << 0;
+		constexpr uint32_t Light = 1 << 1;
+		constexpr uint32_t All = ~0u;
+	}
+
+	//Dynamic AABB tree, leaves store fattened bounds so small movements don't touch the tree
+	//Internal nodes are kept balanced with tree rotations on insertion/removal
+	class BoundingVolumeHierarchy {
+	public:
+		static constexpr int32_t NullNode = -1;
+
+		BoundingVolumeHierarchy(float margin = 0.1f) : m_Margin{ margin } {}
+
+		int32_t CreateProxy(const AABB& bounds, Entity entity, uint32_t layers);
+		void DestroyProxy(int32_t proxy);
+		//Returns true if the proxy had to be reinserted, false if the fat bounds still contain the new bounds
+		bool MoveProxy(int32_t proxy, const AABB& bounds);
+
+		void QueryFrustum(const Frustum& frustum, uint32_t layers, std::vector<Entity>& results) const;
+		void QuerySphere(const glm::vec3& center, float radius, uint32_t layers, std::vector<Entity>& results) const;
+		void QueryBounds(const AABB& bounds, uint32_t layers, std::vector<Entity>& results) const;
+		bool RayCast(const Ray& ray, uint32_t layers, float maxDistance, Entity& hit, float& distance) const;
+
+		const AABB& GetFatBounds(int32_t proxy) const { return m_Nodes[proxy].m_Bounds; }
+		int32_t GetHeight() const { return m_Root == NullNode ? 0 : m_Nodes[m_Root].m_Height; }
+		size_t GetProxyCount() const { return m_ProxyCount; }
+
+	private:
+		struct Node {
+			AABB m_Bounds;
+			Entity m_Entity;
+			uint32_t m_Layers = 0;
+			int32_t m_Parent = NullNode; //next free node when unused
+			int32_t m_Child1 = NullNode;
+			int32_t m_Child2 = NullNode;
+			int32_t m_Height = -1; //0 for leaves, -1 for free nodes
+
+			bool IsLeaf() const { return m_Child1 == NullNode; }
+		};
+
+		int32_t AllocateNode();
+		void FreeNode(int32_t node);
+		void InsertLeaf(int32_t leaf);
+		void RemoveLeaf(int32_t leaf);
+		int32_t Balance(int32_t node);
+		void Refit(int32_t node);
+		void CollectLeaves(int32_t node, uint32_t layers, std::vector<Entity>& results) const;
+
+		std::vector<Node> m_Nodes;
+		mutable std::vector<int32_t> m_Stack;
+		mutable std::vector<int32_t> m_CollectStack;
+		int32_t m_Root = NullNode;
+		int32_t m_FreeList = NullNode;
+		size_t m_ProxyCount = 0;
+		float m_Margin;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "Bounds.h"
+#include <algorithm>
+
+namespace Florencia {
+
+	void AABB::Expand(const glm::vec3& point) {
+		m_Min = glm::min(m_Min, point);
+		m_Max = glm::max(m_Max, point);
+	}
+
+	AABB AABB::Merge(const AABB& other) const {
+		return { glm::min(m_Min, other.m_Min), glm::max(m_Max, other.m_Max) };
+	}
+
+	AABB AABB::Inflate(float margin) const {
+		return { m_Min - glm::vec3(margin), m_Max + glm::vec3(margin) };
+	}
+
+	AABB AABB::Transform(const glm::mat4& matrix) const {
+		//Arvo's method, transforms the center and accumulates the absolute rotated extents
+		const glm::vec3 center = Center();
+		const glm::vec3 extents = Extents();
+		glm::vec3 newCenter = glm::vec3(matrix[3]);
+		glm::vec3 newExtents{ 0.0f };
+		for (int column = 0; column < 3; column++) {
+			const glm::vec3 axis = glm::vec3(matrix[column]);
+			newCenter += axis * center[column];
+			newExtents += glm::abs(axis) * extents[column];
+		}
+		return { newCenter - newExtents, newCenter + newExtents };
+	}
+
+	float AABB::SurfaceArea() const {
+		const glm::vec3 size = m_Max - m_Min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	bool AABB::Contains(const AABB& other) const {
+		return m_Min.x <= other.m_Min.x && m_Min.y <= other.m_Min.y && m_Min.z <= other.m_Min.z &&
+			m_Max.x >= other.m_Max.x && m_Max.y >= other.m_Max.y && m_Max.z >= other.m_Max.z;
+	}
+
+	bool AABB::Intersects(const AABB& other) const {
+		return m_Min.x <= other.m_Max.x && m_Max.x >= other.m_Min.x &&
+			m_Min.y <= other.m_Max.y && m_Max.y >= other.m_Min.y &&
+			m_Min.z <= other.m_Max.z && m_Max.z >= other.m_Min.z;
+	}
+
+	bool AABB::Intersects(const glm::vec3& center, float radius) const {
+		const glm::vec3 closest = glm::clamp(center, m_Min, m_Max);
+		const glm::vec3 offset = closest - center;
+		return glm::dot(offset, offset) <= radius * radius;
+	}
+
+	bool Ray::Intersects(const AABB& bounds, float maxDistance, float& distance) const {
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		for (int axis = 0; axis < 3; axis++) {
+			if (glm::abs(m_Direction[axis]) < std::numeric_limits<float>::epsilon()) {
+				if (m_Origin[axis] < bounds.m_Min[axis] || m_Origin[axis] > bounds.m_Max[axis]) { return false; }
+				continue;
+			}
+			const float inverse = 1.0f / m_Direction[axis];
+			float t1 = (bounds.m_Min[axis] - m_Origin[axis]) * inverse;
+			float t2 = (bounds.m_Max[axis] - m_Origin[axis]) * inverse;
+			if (t1 > t2) { std::swap(t1, t2); }
+			tMin = std::max(tMin, t1);
+			tMax = std::min(tMax, t2);
+			if (tMin > tMax) { return false; }
+		}
+		distance = tMin;
+		return true;
+	}
+
+	Frustum Frustum::FromMatrix(const glm::mat4& viewProjection) {
+		//Gribb-Hartmann plane extraction, rows of the column major matrix
+		auto row = [&](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+		Frustum frustum;
+		frustum.m_Planes[0] = row(3) + row(0); //left
+		frustum.m_Planes[1] = row(3) - row(0); //right
+		frustum.m_Planes[2] = row(3) + row(1); //top or bottom depending on the y flip
+		frustum.m_Planes[3] = row(3) - row(1);
+		frustum.m_Planes[4] = row(2);          //near, depth is 0 to 1
+		frustum.m_Planes[5] = row(3) - row(2); //far
+		for (auto& plane : frustum.m_Planes) {
+			plane = plane / glm::length(glm::vec3(plane));
+		}
+		return frustum;
+	}
+
+	Frustum::Containment Frustum::Classify(const AABB& bounds) const {
+		const glm::vec3 center = bounds.Center();
+		const glm::vec3 extents = bounds.Extents();
+		Containment result = Containment::Inside;
+		for (const auto& plane : m_Planes) {
+			const glm::vec3 normal = glm::vec3(plane);
+			const float distance = glm::dot(normal, center) + plane.w;
+			const float radius = glm::dot(glm::abs(normal), extents);
+			if (distance < -radius) { return Containment::Outside; }
+			if (distance < radius) { result = Containment::Intersecting; }
+		}
+		return result;
+	}
+
+	bool Frustum::Intersects(const glm::vec3& center, float radius) const {
+		for (const auto& plane : m_Planes) {
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) { return false; }
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <limits>
+
+namespace Florencia {
+
+	struct AABB {
+		glm::vec3 m_Min{ std::numeric_limits<float>::max() };
+		glm::vec3 m_Max{ -std::numeric_limits<float>::max() };
+
+		bool IsValid() const { return m_Min.x <= m_Max.x && m_Min.y <= m_Max.y && m_Min.z <= m_Max.z; }
+		glm::vec3 Center() const { return 0.5f * (m_Min + m_Max); }
+		glm::vec3 Extents() const { return 0.5f * (m_Max - m_Min); }
+
+		void Expand(const glm::vec3& point);
+		AABB Merge(const AABB& other) const;
+		AABB Inflate(float margin) const;
+		AABB Transform(const glm::mat4& matrix) const;
+		float SurfaceArea() const;
+		bool Contains(const AABB& other) const;
+		bool Intersects(const AABB& other) const;
+		bool Intersects(const glm::vec3& center, float radius) const;
+	};
+
+	struct Ray {
+		glm::vec3 m_Origin{ 0.0f };
+		glm::vec3 m_Direction{ 0.0f, 0.0f, 1.0f };
+
+		//Slab test, returns the entry distance along the ray in distance or false if it misses within maxDistance
+		bool Intersects(const AABB& bounds, float maxDistance, float& distance) const;
+	};
+
+	class Frustum {
+	public:
+		enum class Containment { Outside, Intersecting, Inside };
+
+		//Planes are extracted from a Vulkan style (0 to 1 depth) view projection matrix, normals point inwards
+		static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+		Containment Classify(const AABB& bounds) const;
+		bool Intersects(const AABB& bounds) const { return Classify(bounds) != Containment::Outside; }
+		bool Intersects(const glm::vec3& center, float radius) const;
+
+	private:
+		glm::vec4 m_Planes[6];
+	};
+
+}
\ No newline at end of file
@@ -11,10 +11,15 @@ namespace Florencia {
 		device.CreateBuffer(m_BufferSize, usageFlags, memoryPropertyFlags, m_Buffer, m_Memory);
 	}
 
+	void Buffer::SetName(const char* name) {
+		m_Device.SetObjectName(VK_OBJECT_TYPE_BUFFER, m_Buffer, name);
+		m_Device.SetObjectName(VK_OBJECT_TYPE_DEVICE_MEMORY, m_Memory, name);
+	}
+
 	Buffer::~Buffer() {
 		Unmap();
-		vkDestroyBuffer(m_Device.Get(), m_Buffer, nullptr);
-		vkFreeMemory(m_Device.Get(), m_Memory, nullptr);
+		vkDestroyBuffer(m_Device.Get(), m_Buffer, m_Device.GetAllocator());
+		m_Device.FreeMemory(m_Memory);
 	}
 
 	VkResult Buffer::Map(VkDeviceSize size, VkDeviceSize offset) {
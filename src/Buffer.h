@@ -19,6 +19,9 @@ namespace Florencia {
 		VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 		VkResult Invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
+		//Debug utils name of the buffer and its memory
+		void SetName(const char* name);
+
 		void WriteToIndex(void* data, int index);
 		VkResult FlushIndex(int index);
 		VkDescriptorBufferInfo DescriptorInfoForIndex(int index);
@@ -12,6 +12,8 @@ namespace Florencia {
 		m_ProjectionMatrix[3][0] = -(right + left) / (right - left);
 		m_ProjectionMatrix[3][1] = -(bottom + top) / (bottom - top);
 		m_ProjectionMatrix[3][2] = -near / (far - near);
+		m_Near = near;
+		m_Far = far;
 	}
 
 	void Camera::SetPerspectiveProjection(float fovy, float aspect, float near, float far) {
@@ -23,6 +25,8 @@ namespace Florencia {
 		m_ProjectionMatrix[2][2] = far / (far - near);
 		m_ProjectionMatrix[2][3] = 1.0f;
 		m_ProjectionMatrix[3][2] = -(far * near) / (far - near);
+		m_Near = near;
+		m_Far = far;
 	}
 
 	void Camera::SetViewDirection(glm::vec3 position, glm::vec3 direction, glm::vec3 up) {
@@ -117,4 +121,10 @@ namespace Florencia {
 		m_InverseViewMatrix[3][2] = position.z;
 	}
 
+	Ray Camera::ScreenPointToRay(glm::vec2 ndc) const {
+		const glm::vec3 viewDirection{ ndc.x / m_ProjectionMatrix[0][0], ndc.y / m_ProjectionMatrix[1][1], 1.0f };
+		const glm::vec3 worldDirection = glm::vec3(m_InverseViewMatrix * glm::vec4(viewDirection, 0.0f));
+		return Ray{ GetPostition(), glm::normalize(worldDirection) };
+	}
+
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
+#include "Bounds.h"
 
 namespace Florencia {
 
@@ -18,11 +19,18 @@ namespace Florencia {
 		const glm::mat4& GetProjectionMatrix() const { return m_ProjectionMatrix; }
 		const glm::mat4& GetViewMatrix() const { return m_ViewMatrix; }
 		const glm::vec3 GetPostition() const { return glm::vec3(m_InverseViewMatrix[3]);}
+		float GetNearPlane() const { return m_Near; }
+		float GetFarPlane() const { return m_Far; }
+		Frustum GetFrustum() const { return Frustum::FromMatrix(m_ProjectionMatrix * m_ViewMatrix); }
+
+		//Only valid for perspective projections, ndc is in the -1 to 1 range
+		Ray ScreenPointToRay(glm::vec2 ndc) const;
 
 	private:
 		glm::mat4 m_InverseViewMatrix{1.0f};
 		glm::mat4 m_ProjectionMatrix{1.0f};
 		glm::mat4 m_ViewMatrix{1.0f};
+		float m_Near = 0.1f, m_Far = 100.0f;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "CameraPath.h"
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+
+namespace Florencia {
+
+	CameraPath CameraPath::Orbit(float radius, float height, float period, uint32_t keyframeCount) {
+		CameraPath path{};
+		for (uint32_t i = 0; i <= keyframeCount; i++) {
+			float t = static_cast<float>(i) / static_cast<float>(keyframeCount);
+			float angle = t * glm::two_pi<float>();
+			CameraKeyframe keyframe{};
+			keyframe.m_Time = t * period;
+			keyframe.m_Translation = { radius * glm::sin(angle), height, radius * glm::cos(angle) };
+			//Yaw keeps increasing past a full turn so the last segment doesn't interpolate the long way round
+			glm::vec3 forward = glm::normalize(-keyframe.m_Translation);
+			keyframe.m_Rotation = { glm::asin(-forward.y), angle + glm::pi<float>(), 0.0f };
+			path.m_Keyframes.push_back(keyframe);
+		}
+		return path;
+	}
+
+	CameraPath CameraPath::Load(const std::string& path) {
+		std::ifstream file(path);
+		if (!file) throw std::runtime_error("Failed to Open Camera Path " + path);
+		CameraPath cameraPath{};
+		std::string line;
+		while (std::getline(file, line)) {
+			if (line.empty() || line[0] == '#') { continue; }
+			std::istringstream stream(line);
+			CameraKeyframe keyframe{};
+			stream >> keyframe.m_Time >> keyframe.m_Translation.x >> keyframe.m_Translation.y >> keyframe.m_Translation.z
+				>> keyframe.m_Rotation.x >> keyframe.m_Rotation.y >> keyframe.m_Rotation.z;
+			if (stream.fail()) throw std::runtime_error("Malformed Camera Path Keyframe: " + line);
+			if (!cameraPath.m_Keyframes.empty() && keyframe.m_Time < cameraPath.m_Keyframes.back().m_Time) throw std::runtime_error("Camera Path Keyframes Must Be In Increasing Time");
+			cameraPath.m_Keyframes.push_back(keyframe);
+		}
+		if (cameraPath.IsEmpty()) throw std::runtime_error("Camera Path Has No Keyframes: " + path);
+		return cameraPath;
+	}
+
+	void CameraPath::Save(const std::string& path) const {
+		std::ofstream file(path);
+		if (!file) throw std::runtime_error("Failed to Write Camera Path " + path);
+		file << "# time x y z rotationX rotationY rotationZ\n";
+		for (const CameraKeyframe& keyframe : m_Keyframes) {
+			file << keyframe.m_Time << " " << keyframe.m_Translation.x << " " << keyframe.m_Translation.y << " " << keyframe.m_Translation.z << " "
+				<< keyframe.m_Rotation.x << " " << keyframe.m_Rotation.y << " " << keyframe.m_Rotation.z << "\n";
+		}
+	}
+
+	void CameraPath::Record(float time, const TransformComponent& transform) {
+		m_Keyframes.push_back({ time, transform.translation, transform.rotation });
+	}
+
+	void CameraPath::Sample(float time, TransformComponent& transform) const {
+		if (m_Keyframes.empty()) { return; }
+		float duration = GetDuration();
+		if (duration > 0.0f) { time = std::fmod(time, duration); }
+		auto next = std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), time, [](float t, const CameraKeyframe& keyframe) { return t < keyframe.m_Time; });
+		if (next == m_Keyframes.begin() || next == m_Keyframes.end()) {
+			const CameraKeyframe& keyframe = next == m_Keyframes.end() ? m_Keyframes.back() : m_Keyframes.front();
+			transform.translation = keyframe.m_Translation;
+			transform.rotation = keyframe.m_Rotation;
+			return;
+		}
+		const CameraKeyframe& previous = *(next - 1);
+		float span = next->m_Time - previous.m_Time;
+		float t = span > 0.0f ? (time - previous.m_Time) / span : 0.0f;
+		transform.translation = glm::mix(previous.m_Translation, next->m_Translation, t);
+		transform.rotation = glm::mix(previous.m_Rotation, next->m_Rotation, t);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "GameObject.h"
+
+namespace Florencia {
+
+	struct CameraKeyframe {
+		float m_Time = 0.0f;
+		glm::vec3 m_Translation{ 0.0f };
+		glm::vec3 m_Rotation{ 0.0f };
+	};
+
+	//Keyframed viewer transform for reproducible runs, either scripted or recorded from an interactive session
+	class CameraPath {
+	public:
+		//Circles the origin at radius and height, looking at it, one lap every period seconds
+		static CameraPath Orbit(float radius, float height, float period, uint32_t keyframeCount = 64);
+		//One keyframe per line, "time x y z rotationX rotationY rotationZ", in increasing time
+		static CameraPath Load(const std::string& path);
+		void Save(const std::string& path) const;
+
+		//Keyframes must be recorded in increasing time
+		void Record(float time, const TransformComponent& transform);
+		//Interpolates the two keyframes around time, wrapping past the last one
+		void Sample(float time, TransformComponent& transform) const;
+
+		bool IsEmpty() const { return m_Keyframes.empty(); }
+		float GetDuration() const { return m_Keyframes.empty() ? 0.0f : m_Keyframes.back().m_Time; }
+
+	private:
+		std::vector<CameraKeyframe> m_Keyframes;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "ClusteredLighting.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "CpuProfiler.h"
+
+namespace Florencia {
+
+	ClusteredLighting::ClusteredLighting(Device& device, uint32_t frameCount) : m_Device{ device } {
+		m_SetLayout = DescriptorSetLayout::Builder(m_Device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.Build();
+		m_Pool = DescriptorPool::Builder(m_Device)
+			.SetMaxSets(frameCount)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount * 3)
+			.Build();
+
+		m_Clusters.resize(ClusterCount);
+		m_Frames.resize(frameCount);
+		for (auto& frame : m_Frames) {
+			frame.m_Lights = CreateStorageBuffer(sizeof(PointLight), 64, "Cluster Lights");
+			frame.m_Clusters = CreateStorageBuffer(sizeof(ClusterRange), ClusterCount, "Cluster Ranges");
+			frame.m_LightIndices = CreateStorageBuffer(sizeof(uint32_t), 1024, "Cluster Light Indices");
+
+			auto lightsInfo = frame.m_Lights->DescriptorInfo();
+			auto clustersInfo = frame.m_Clusters->DescriptorInfo();
+			auto indicesInfo = frame.m_LightIndices->DescriptorInfo();
+			DescriptorWriter(*m_SetLayout, *m_Pool)
+				.WriteBuffer(0, &lightsInfo)
+				.WriteBuffer(1, &clustersInfo)
+				.WriteBuffer(2, &indicesInfo)
+				.Build(frame.m_DescriptorSet);
+			m_Device.SetObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, frame.m_DescriptorSet, "Clustered Lighting Set");
+		}
+	}
+
+	void ClusteredLighting::Update(int frameIndex, const Camera& camera, const std::vector<PointLight>& lights, GlobalUBO& ubo) {
+		FLORENCIA_PROFILE_SCOPE("ClusteredLighting::Update");
+		float logDepthRange = std::log(camera.GetFarPlane() / camera.GetNearPlane());
+		float sliceScale = DepthSlices / logDepthRange;
+		float sliceBias = -static_cast<float>(DepthSlices) * std::log(camera.GetNearPlane()) / logDepthRange;
+
+		//Count, prefix sum, then fill so the index list is one contiguous array
+		std::fill(m_Clusters.begin(), m_Clusters.end(), ClusterRange{ 0, 0 });
+		m_LightBounds.resize(lights.size());
+		for (size_t i = 0; i < lights.size(); i++) {
+			ClusterBounds& bounds = m_LightBounds[i];
+			if (!FindClusterBounds(camera, lights[i], sliceScale, sliceBias, bounds)) {
+				bounds.m_MinZ = 1;
+				bounds.m_MaxZ = 0;
+				continue;
+			}
+			for (uint32_t z = bounds.m_MinZ; z <= bounds.m_MaxZ; z++)
+				for (uint32_t y = bounds.m_MinY; y <= bounds.m_MaxY; y++)
+					for (uint32_t x = bounds.m_MinX; x <= bounds.m_MaxX; x++) { m_Clusters[x + TilesX * (y + TilesY * z)].m_Count++; }
+		}
+
+		uint32_t offset = 0;
+		for (auto& cluster : m_Clusters) {
+			cluster.m_Offset = offset;
+			offset += cluster.m_Count;
+			cluster.m_Count = 0;
+		}
+
+		m_LightIndices.resize(offset);
+		for (uint32_t i = 0; i < static_cast<uint32_t>(lights.size()); i++) {
+			const ClusterBounds& bounds = m_LightBounds[i];
+			for (uint32_t z = bounds.m_MinZ; z <= bounds.m_MaxZ; z++)
+				for (uint32_t y = bounds.m_MinY; y <= bounds.m_MaxY; y++)
+					for (uint32_t x = bounds.m_MinX; x <= bounds.m_MaxX; x++) {
+						ClusterRange& cluster = m_Clusters[x + TilesX * (y + TilesY * z)];
+						m_LightIndices[cluster.m_Offset + cluster.m_Count++] = i;
+					}
+		}
+
+		Upload(m_Frames[frameIndex], lights);
+
+		ubo.m_ClusterGrid = glm::uvec4(TilesX, TilesY, DepthSlices, static_cast<uint32_t>(lights.size()));
+		ubo.m_ClusterDepth = glm::vec4(sliceScale, sliceBias, 0.0f, 0.0f);
+	}
+
+	bool ClusteredLighting::FindClusterBounds(const Camera& camera, const PointLight& light, float sliceScale, float sliceBias, ClusterBounds& bounds) const {
+		glm::vec3 center = glm::vec3(camera.GetViewMatrix() * glm::vec4(glm::vec3(light.m_Position), 1.0f));
+		float radius = light.m_Position.w;
+		float nearPlane = camera.GetNearPlane();
+		float farPlane = camera.GetFarPlane();
+		if (center.z + radius < nearPlane || center.z - radius > farPlane) { return false; }
+
+		auto slice = [&](float depth) {
+			float value = std::floor(std::log(depth) * sliceScale + sliceBias);
+			return static_cast<uint32_t>(std::clamp(value, 0.0f, static_cast<float>(DepthSlices - 1)));
+		};
+		bounds.m_MinZ = slice(std::max(center.z - radius, nearPlane));
+		bounds.m_MaxZ = slice(std::min(center.z + radius, farPlane));
+
+		//A sphere reaching past the near plane can cover any part of the screen
+		if (center.z - radius <= nearPlane) {
+			bounds.m_MinX = 0;
+			bounds.m_MaxX = TilesX - 1;
+			bounds.m_MinY = 0;
+			bounds.m_MaxY = TilesY - 1;
+			return true;
+		}
+
+		//x / z is monotonic in both over the sphere's view space box, so the extremes are at its corners
+		const glm::mat4& projection = camera.GetProjectionMatrix();
+		glm::vec2 minNdc{ std::numeric_limits<float>::max() };
+		glm::vec2 maxNdc{ -std::numeric_limits<float>::max() };
+		for (int i = 0; i < 4; i++) {
+			float depth = (i & 1) ? center.z + radius : center.z - radius;
+			float offset = (i & 2) ? radius : -radius;
+			glm::vec2 ndc{ projection[0][0] * (center.x + offset) / depth, projection[1][1] * (center.y + offset) / depth };
+			minNdc = glm::min(minNdc, ndc);
+			maxNdc = glm::max(maxNdc, ndc);
+		}
+		if (maxNdc.x < -1.0f || maxNdc.y < -1.0f || minNdc.x > 1.0f || minNdc.y > 1.0f) { return false; }
+
+		auto tile = [](float ndc, uint32_t tileCount) {
+			float value = std::floor((ndc * 0.5f + 0.5f) * tileCount);
+			return static_cast<uint32_t>(std::clamp(value, 0.0f, static_cast<float>(tileCount - 1)));
+		};
+		bounds.m_MinX = tile(minNdc.x, TilesX);
+		bounds.m_MaxX = tile(maxNdc.x, TilesX);
+		bounds.m_MinY = tile(minNdc.y, TilesY);
+		bounds.m_MaxY = tile(maxNdc.y, TilesY);
+		return true;
+	}
+
+	void ClusteredLighting::Upload(FrameResources& frame, const std::vector<PointLight>& lights) {
+		FLORENCIA_PROFILE_SCOPE("ClusteredLighting::Upload");
+		//Buffers only grow, the descriptor set is rewritten when any of them is replaced
+		bool resized = false;
+		if (lights.size() > frame.m_Lights->GetInstanceCount()) {
+			frame.m_Lights = CreateStorageBuffer(sizeof(PointLight), std::max(static_cast<uint32_t>(lights.size()), frame.m_Lights->GetInstanceCount() * 2), "Cluster Lights");
+			resized = true;
+		}
+		if (m_LightIndices.size() > frame.m_LightIndices->GetInstanceCount()) {
+			frame.m_LightIndices = CreateStorageBuffer(sizeof(uint32_t), std::max(static_cast<uint32_t>(m_LightIndices.size()), frame.m_LightIndices->GetInstanceCount() * 2), "Cluster Light Indices");
+			resized = true;
+		}
+		if (resized) {
+			auto lightsInfo = frame.m_Lights->DescriptorInfo();
+			auto clustersInfo = frame.m_Clusters->DescriptorInfo();
+			auto indicesInfo = frame.m_LightIndices->DescriptorInfo();
+			DescriptorWriter(*m_SetLayout, *m_Pool)
+				.WriteBuffer(0, &lightsInfo)
+				.WriteBuffer(1, &clustersInfo)
+				.WriteBuffer(2, &indicesInfo)
+				.Overwrite(frame.m_DescriptorSet);
+		}
+
+		if (!lights.empty()) { frame.m_Lights->WriteToBuffer((void*)lights.data(), lights.size() * sizeof(PointLight)); }
+		frame.m_Clusters->WriteToBuffer(m_Clusters.data(), m_Clusters.size() * sizeof(ClusterRange));
+		if (!m_LightIndices.empty()) { frame.m_LightIndices->WriteToBuffer(m_LightIndices.data(), m_LightIndices.size() * sizeof(uint32_t)); }
+		frame.m_Lights->Flush();
+		frame.m_Clusters->Flush();
+		frame.m_LightIndices->Flush();
+	}
+
+	std::unique_ptr<Buffer> ClusteredLighting::CreateStorageBuffer(VkDeviceSize instanceSize, uint32_t instanceCount, const char* name) {
+		auto buffer = std::make_unique<Buffer>(m_Device, instanceSize, instanceCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+		buffer->SetName(name);
+		buffer->Map();
+		return buffer;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Descriptors.h"
+#include "FrameInfo.h"
+#include "Buffer.h"
+#include "Device.h"
+
+namespace Florencia {
+
+	//Bins point lights into a froxel grid of screen tiles by exponential depth slices on the cpu
+	//Shaders find their cluster from the fragment's view position and only loop over the lights listed for it
+	//Descriptor set layout, all storage buffers read by the fragment stage:
+	//binding 0 PointLight[], binding 1 uvec2[] offset and count into binding 2 per cluster, binding 2 uint[] light indices
+	class ClusteredLighting {
+	public:
+		static constexpr uint32_t TilesX = 16;
+		static constexpr uint32_t TilesY = 9;
+		static constexpr uint32_t DepthSlices = 24;
+		static constexpr uint32_t ClusterCount = TilesX * TilesY * DepthSlices;
+
+		ClusteredLighting(Device& device, uint32_t frameCount);
+
+		ClusteredLighting(const ClusteredLighting&) = delete;
+		ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+		//Only valid for perspective cameras, buffers of this frame index must no longer be in use by the gpu
+		void Update(int frameIndex, const Camera& camera, const std::vector<PointLight>& lights, GlobalUBO& ubo);
+
+		VkDescriptorSetLayout GetDescriptorSetLayout() const { return m_SetLayout->GetDescriptorSetLayout(); }
+		VkDescriptorSet GetDescriptorSet(int frameIndex) const { return m_Frames[frameIndex].m_DescriptorSet; }
+		uint32_t GetLightIndexCount() const { return static_cast<uint32_t>(m_LightIndices.size()); }
+
+	private:
+		struct ClusterRange {
+			uint32_t m_Offset;
+			uint32_t m_Count;
+		};
+
+		struct ClusterBounds {
+			uint32_t m_MinX, m_MaxX;
+			uint32_t m_MinY, m_MaxY;
+			uint32_t m_MinZ, m_MaxZ;
+		};
+
+		struct FrameResources {
+			std::unique_ptr<Buffer> m_Lights;
+			std::unique_ptr<Buffer> m_Clusters;
+			std::unique_ptr<Buffer> m_LightIndices;
+			VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+		};
+
+		bool FindClusterBounds(const Camera& camera, const PointLight& light, float sliceScale, float sliceBias, ClusterBounds& bounds) const;
+		void Upload(FrameResources& frame, const std::vector<PointLight>& lights);
+		std::unique_ptr<Buffer> CreateStorageBuffer(VkDeviceSize instanceSize, uint32_t instanceCount, const char* name);
+
+		Device& m_Device;
+		std::unique_ptr<DescriptorSetLayout> m_SetLayout;
+		std::unique_ptr<DescriptorPool> m_Pool;
+		std::vector<FrameResources> m_Frames;
+
+		std::vector<ClusterBounds> m_LightBounds;
+		std::vector<ClusterRange> m_Clusters;
+		std::vector<uint32_t> m_LightIndices;
+	};
+
+}
\ No newline at end of file
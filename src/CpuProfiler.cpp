@@ -0,0 +1,137 @@
+#include "CpuProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Florencia {
+
+	namespace {
+
+		constexpr uint32_t ChunkSize = 16384;
+
+		//Only the owning thread writes, m_Count is published after the event so a reader never sees a half written one
+		struct EventChunk {
+			CpuProfileEvent m_Events[ChunkSize];
+			std::atomic<uint32_t> m_Count{ 0 };
+			std::atomic<EventChunk*> m_Next{ nullptr };
+		};
+
+		struct ThreadBuffer {
+			uint32_t m_ThreadIndex = 0;
+			std::string m_Name;
+			std::unique_ptr<EventChunk> m_Head = std::make_unique<EventChunk>();
+			EventChunk* m_Tail = m_Head.get();
+
+			~ThreadBuffer() {
+				EventChunk* chunk = m_Head->m_Next.load();
+				while (chunk != nullptr) {
+					EventChunk* next = chunk->m_Next.load();
+					delete chunk;
+					chunk = next;
+				}
+			}
+		};
+
+		//Buffers outlive the threads that wrote them so their events can still be written out
+		//The first event starts just before the registry is created, so times relative to m_Origin are signed
+		struct ProfilerRegistry {
+			std::mutex m_Mutex;
+			std::vector<std::unique_ptr<ThreadBuffer>> m_Threads;
+			uint64_t m_Origin = CpuProfiler::Now();
+		};
+
+		ProfilerRegistry& GetRegistry() {
+			static ProfilerRegistry registry;
+			return registry;
+		}
+
+		thread_local ThreadBuffer* t_Buffer = nullptr;
+
+		ThreadBuffer& GetThreadBuffer() {
+			if (t_Buffer == nullptr) {
+				ProfilerRegistry& registry = GetRegistry();
+				std::lock_guard<std::mutex> lock(registry.m_Mutex);
+				registry.m_Threads.push_back(std::make_unique<ThreadBuffer>());
+				t_Buffer = registry.m_Threads.back().get();
+				t_Buffer->m_ThreadIndex = static_cast<uint32_t>(registry.m_Threads.size());
+			}
+			return *t_Buffer;
+		}
+
+		std::string Quote(const std::string& text) {
+			std::string quoted = "\"";
+			for (char c : text) {
+				if (c == '"' || c == '\\') { quoted += '\\'; }
+				quoted += c;
+			}
+			return quoted + "\"";
+		}
+
+	}
+
+	uint64_t CpuProfiler::Now() {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	void CpuProfiler::Record(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds) {
+		ThreadBuffer& buffer = GetThreadBuffer();
+		uint32_t count = buffer.m_Tail->m_Count.load(std::memory_order_relaxed);
+		if (count == ChunkSize) {
+			EventChunk* chunk = new EventChunk();
+			buffer.m_Tail->m_Next.store(chunk, std::memory_order_release);
+			buffer.m_Tail = chunk;
+			count = 0;
+		}
+		buffer.m_Tail->m_Events[count] = { name, startNanoseconds, endNanoseconds };
+		buffer.m_Tail->m_Count.store(count + 1, std::memory_order_release);
+	}
+
+	void CpuProfiler::SetThreadName(const std::string& name) {
+		ThreadBuffer& buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(GetRegistry().m_Mutex);
+		buffer.m_Name = name;
+	}
+
+	size_t CpuProfiler::GetEventCount() {
+		ProfilerRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.m_Mutex);
+		size_t count = 0;
+		for (const auto& thread : registry.m_Threads) {
+			for (EventChunk* chunk = thread->m_Head.get(); chunk != nullptr; chunk = chunk->m_Next.load(std::memory_order_acquire)) {
+				count += chunk->m_Count.load(std::memory_order_acquire);
+			}
+		}
+		return count;
+	}
+
+	//Threads may keep recording while this runs, events published after their chunk was visited are left out
+	void CpuProfiler::WriteTrace(const std::string& path) {
+		std::ofstream file(path);
+		if (!file) throw std::runtime_error("Failed to Write Cpu Trace " + path);
+
+		ProfilerRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.m_Mutex);
+		file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+		file << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"Cpu\"}}";
+		for (const auto& thread : registry.m_Threads) {
+			std::string name = thread->m_Name.empty() ? "Thread " + std::to_string(thread->m_ThreadIndex) : thread->m_Name;
+			file << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread->m_ThreadIndex << ", \"args\": {\"name\": " << Quote(name) << "}}";
+			for (EventChunk* chunk = thread->m_Head.get(); chunk != nullptr; chunk = chunk->m_Next.load(std::memory_order_acquire)) {
+				uint32_t count = chunk->m_Count.load(std::memory_order_acquire);
+				for (uint32_t i = 0; i < count; i++) {
+					const CpuProfileEvent& event = chunk->m_Events[i];
+					file << ",\n{\"name\": " << Quote(event.m_Name) << ", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread->m_ThreadIndex
+						<< ", \"ts\": " << static_cast<double>(static_cast<int64_t>(event.m_StartNanoseconds - registry.m_Origin)) / 1000.0
+						<< ", \"dur\": " << static_cast<double>(event.m_EndNanoseconds - event.m_StartNanoseconds) / 1000.0 << "}";
+				}
+			}
+		}
+		file << "\n]}\n";
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Florencia {
+
+	struct CpuProfileEvent {
+		const char* m_Name;
+		uint64_t m_StartNanoseconds;
+		uint64_t m_EndNanoseconds;
+	};
+
+	//Every thread appends to its own chunked event buffer without locking, the registry lock is only taken when a thread
+	//records its first event, names itself or a trace is written
+	//Zones are placed with the macros below, which compile to nothing unless FLORENCIA_ENABLE_PROFILING is defined
+	class CpuProfiler {
+	public:
+#ifdef FLORENCIA_ENABLE_PROFILING
+		static constexpr bool Enabled = true;
+#else
+		static constexpr bool Enabled = false;
+#endif
+
+		//steady_clock, converting rdtsc ticks would need a calibration per machine
+		static uint64_t Now();
+		//name must outlive the profiler, string literals in practice
+		static void Record(const char* name, uint64_t startNanoseconds, uint64_t endNanoseconds);
+		//Shown as the name of the calling thread's track, threads without one are named by their index
+		static void SetThreadName(const std::string& name);
+
+		//Chrome trace event JSON with one track per thread, opens in chrome://tracing and Perfetto
+		static void WriteTrace(const std::string& path);
+		static size_t GetEventCount();
+	};
+
+	class CpuProfileScope {
+	public:
+		CpuProfileScope(const char* name) : m_Name{ name }, m_Start{ CpuProfiler::Now() } {}
+		~CpuProfileScope() { CpuProfiler::Record(m_Name, m_Start, CpuProfiler::Now()); }
+
+		CpuProfileScope(const CpuProfileScope&) = delete;
+		CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+	private:
+		const char* m_Name;
+		uint64_t m_Start;
+	};
+
+}
+
+#define FLORENCIA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define FLORENCIA_PROFILE_CONCAT(a, b) FLORENCIA_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef FLORENCIA_ENABLE_PROFILING
+	#define FLORENCIA_PROFILE_SCOPE(name) ::Florencia::CpuProfileScope FLORENCIA_PROFILE_CONCAT(profileScope, __LINE__){ name }
+	#define FLORENCIA_PROFILE_THREAD(name) ::Florencia::CpuProfiler::SetThreadName(name)
+#else
+	#define FLORENCIA_PROFILE_SCOPE(name) ((void)0)
+	#define FLORENCIA_PROFILE_THREAD(name) ((void)0)
+#endif
\ No newline at end of file
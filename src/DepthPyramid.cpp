@@ -0,0 +1,92 @@
+#include "DepthPyramid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Florencia {
+
+	void DepthPyramid::Build(const float* depth, uint32_t width, uint32_t height, const glm::mat4& viewProjection) {
+		m_ViewProjection = viewProjection;
+		if (m_Levels.empty()) { m_Levels.resize(1); }
+		Level& base = m_Levels[0];
+		base.m_Width = std::max(1u, width);
+		base.m_Height = std::max(1u, height);
+		base.m_Depth.assign(depth, depth + static_cast<size_t>(base.m_Width) * base.m_Height);
+		BuildMipChain();
+	}
+
+	void DepthPyramid::BuildMipChain() {
+		size_t levelCount = 1;
+		while (true) {
+			const Level& previous = m_Levels[levelCount - 1];
+			if (previous.m_Width == 1 && previous.m_Height == 1) { break; }
+			if (m_Levels.size() <= levelCount) { m_Levels.emplace_back(); }
+
+			//previous may be invalidated by emplace_back, take it again
+			const Level& source = m_Levels[levelCount - 1];
+			Level& level = m_Levels[levelCount];
+			level.m_Width = std::max(1u, (source.m_Width + 1) / 2);
+			level.m_Height = std::max(1u, (source.m_Height + 1) / 2);
+			level.m_Depth.resize(static_cast<size_t>(level.m_Width) * level.m_Height);
+			for (uint32_t y = 0; y < level.m_Height; y++) {
+				for (uint32_t x = 0; x < level.m_Width; x++) {
+					//Odd sized sources fold their last row/column into the final texel
+					uint32_t x0 = x * 2, y0 = y * 2;
+					uint32_t x1 = std::min(source.m_Width - 1, x0 + 1 + ((x == level.m_Width - 1) ? source.m_Width % 2 : 0));
+					uint32_t y1 = std::min(source.m_Height - 1, y0 + 1 + ((y == level.m_Height - 1) ? source.m_Height % 2 : 0));
+					level.m_Depth[y * level.m_Width + x] = SampleMax(source, x0, y0, x1, y1);
+				}
+			}
+			levelCount++;
+		}
+		m_Levels.resize(levelCount);
+	}
+
+	float DepthPyramid::SampleMax(const Level& level, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) const {
+		float farthest = 0.0f;
+		for (uint32_t y = y0; y <= y1; y++) {
+			for (uint32_t x = x0; x <= x1; x++) { farthest = std::max(farthest, level.m_Depth[y * level.m_Width + x]); }
+		}
+		return farthest;
+	}
+
+	bool DepthPyramid::IsOccluded(const AABB& bounds) const {
+		if (!IsValid()) { return false; }
+
+		glm::vec2 uvMin{ 1.0f }, uvMax{ 0.0f };
+		float nearestDepth = 1.0f;
+		for (int corner = 0; corner < 8; corner++) {
+			glm::vec3 point{
+				(corner & 1) ? bounds.m_Max.x : bounds.m_Min.x,
+				(corner & 2) ? bounds.m_Max.y : bounds.m_Min.y,
+				(corner & 4) ? bounds.m_Max.z : bounds.m_Min.z
+			};
+			glm::vec4 clip = m_ViewProjection * glm::vec4(point, 1.0f);
+			//Anything crossing the near plane can't be tested reliably
+			if (clip.w <= std::numeric_limits<float>::epsilon()) { return false; }
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			glm::vec2 uv{ ndc.x * 0.5f + 0.5f, ndc.y * 0.5f + 0.5f };
+			uvMin = glm::min(uvMin, uv);
+			uvMax = glm::max(uvMax, uv);
+			nearestDepth = std::min(nearestDepth, ndc.z);
+		}
+		uvMin = glm::clamp(uvMin, glm::vec2(0.0f), glm::vec2(1.0f));
+		uvMax = glm::clamp(uvMax, glm::vec2(0.0f), glm::vec2(1.0f));
+		if (uvMin.x >= uvMax.x || uvMin.y >= uvMax.y) { return false; }
+
+		//Pick the level where the rectangle spans about four texels, coarser levels reject too many thin occluders
+		const Level& base = m_Levels[0];
+		float pixelWidth = (uvMax.x - uvMin.x) * base.m_Width;
+		float pixelHeight = (uvMax.y - uvMin.y) * base.m_Height;
+		size_t levelIndex = static_cast<size_t>(std::max(0.0f, std::ceil(std::log2(std::max(pixelWidth, pixelHeight) * 0.25f))));
+		levelIndex = std::min(levelIndex, m_Levels.size() - 1);
+
+		const Level& level = m_Levels[levelIndex];
+		uint32_t x0 = std::min(level.m_Width - 1, static_cast<uint32_t>(uvMin.x * level.m_Width));
+		uint32_t y0 = std::min(level.m_Height - 1, static_cast<uint32_t>(uvMin.y * level.m_Height));
+		uint32_t x1 = std::min(level.m_Width - 1, static_cast<uint32_t>(uvMax.x * level.m_Width));
+		uint32_t y1 = std::min(level.m_Height - 1, static_cast<uint32_t>(uvMax.y * level.m_Height));
+
+		return nearestDepth > SampleMax(level, x0, y0, x1, y1);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+
+namespace Florencia {
+
+	//Hierarchical-Z pyramid, every texel of level n holds the farthest depth of the 2x2 texels below it in level n-1
+	//Built on the cpu from a reduced depth readback, tests are made in the space of the view projection the depth was rendered with
+	class DepthPyramid {
+	public:
+		//depth becomes level 0 as is, it must already hold the farthest depth of every block of the attachment it covers
+		void Build(const float* depth, uint32_t width, uint32_t height, const glm::mat4& viewProjection);
+
+		bool IsValid() const { return !m_Levels.empty(); }
+		bool IsOccluded(const AABB& bounds) const;
+
+	private:
+		struct Level {
+			uint32_t m_Width = 0;
+			uint32_t m_Height = 0;
+			std::vector<float> m_Depth;
+		};
+
+		void BuildMipChain();
+		float SampleMax(const Level& level, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) const;
+
+		std::vector<Level> m_Levels;
+		glm::mat4 m_ViewProjection{ 1.0f };
+	};
+
+}
\ No newline at end of file
@@ -55,13 +55,13 @@ namespace Florencia {
 		descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
 		descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
 
-		if (vkCreateDescriptorSetLayout(m_Device.Get(), &descriptorSetLayoutInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS) {
+		if (vkCreateDescriptorSetLayout(m_Device.Get(), &descriptorSetLayoutInfo, m_Device.GetAllocator(), &m_DescriptorSetLayout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create descriptor set layout!");
 		}
 	}
 
 	DescriptorSetLayout::~DescriptorSetLayout() {
-		vkDestroyDescriptorSetLayout(m_Device.Get(), m_DescriptorSetLayout, nullptr);
+		vkDestroyDescriptorSetLayout(m_Device.Get(), m_DescriptorSetLayout, m_Device.GetAllocator());
 	}
 
 	//DescriptorPool
@@ -73,13 +73,13 @@ namespace Florencia {
 		descriptorPoolInfo.maxSets = maxSets;
 		descriptorPoolInfo.flags = poolFlags;
 
-		if (vkCreateDescriptorPool(m_Device.Get(), &descriptorPoolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS) {
+		if (vkCreateDescriptorPool(m_Device.Get(), &descriptorPoolInfo, m_Device.GetAllocator(), &m_DescriptorPool) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create descriptor pool!");
 		}
 	}
 
 	DescriptorPool::~DescriptorPool() {
-		vkDestroyDescriptorPool(m_Device.Get(), m_DescriptorPool, nullptr);
+		vkDestroyDescriptorPool(m_Device.Get(), m_DescriptorPool, m_Device.GetAllocator());
 	}
 
 	bool DescriptorPool::AllocateDescriptor(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor) const {
@@ -104,7 +104,9 @@ namespace Florencia {
 	}
 
 	//DescriptorWriter
-	DescriptorWriter::DescriptorWriter(DescriptorSetLayout& setLayout, DescriptorPool& pool) : m_Pool(pool), m_SetLayout(setLayout) {}
+	DescriptorWriter::DescriptorWriter(DescriptorSetLayout& setLayout, DescriptorPool& pool, FrameArena* arena) : m_Pool(pool), m_SetLayout(setLayout), m_Writes(FrameAllocator<VkWriteDescriptorSet>{ arena }) {
+		m_Writes.reserve(setLayout.m_Bindings.size());
+	}
 
 	DescriptorWriter& DescriptorWriter::WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo) {
 		if(m_SetLayout.m_Bindings.count(binding) != 1) {
@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 
+#include "FrameArena.h"
 #include "Device.h"
 
 namespace Florencia {
@@ -69,7 +70,8 @@ namespace Florencia {
 
 	class DescriptorWriter {
 	public:
-		DescriptorWriter(DescriptorSetLayout& setLayout, DescriptorPool& pool);
+		//Writers created while recording a frame pass its arena, the writes are then never heap allocated
+		DescriptorWriter(DescriptorSetLayout& setLayout, DescriptorPool& pool, FrameArena* arena = nullptr);
 
 		DescriptorWriter& WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo);
 		DescriptorWriter& WriteImage(uint32_t binding, VkDescriptorImageInfo* imageInfo);
@@ -79,7 +81,7 @@ namespace Florencia {
 	private:
 		DescriptorPool& m_Pool;
 		DescriptorSetLayout& m_SetLayout;
-		std::vector<VkWriteDescriptorSet> m_Writes;
+		FrameVector<VkWriteDescriptorSet> m_Writes;
 	};
 
 }
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "Device.h"
 #include <unordered_set>
 #include <iostream>
+#include <filesystem>
+#include <fstream>
 #include <cstring>
+#include <chrono>
+#include <array>
 #include <set>
+#include <algorithm>
 
 namespace Florencia
 {
@@ -37,26 +42,37 @@ namespace Florencia
 	}
 
 	// class member functions
-	Device::Device(Window &window) : m_Window{window}
+	Device::Device(Window &window) : m_Window{window}, m_Headless{window.IsHeadless()}
 	{
 		CreateInstance();
 		// setupDebugMessenger();
-		CreateSurface();
+		if (!m_Headless)
+		{
+			CreateSurface();
+		}
 		PickPhysicalDevice();
 		CreateLogicalDevice();
+		CreateTimelineSemaphore();
+		CreatePipelineCache();
 		CreateCommandPool();
 	}
 
 	Device::~Device()
 	{
-		vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
-		vkDestroyDevice(m_Device, nullptr);
+		SavePipelineCache();
+		vkDestroyPipelineCache(m_Device, m_PipelineCache, m_Allocator);
+		vkDestroyCommandPool(m_Device, m_CommandPool, m_Allocator);
+		vkDestroySemaphore(m_Device, m_Timeline, m_Allocator);
+		vkDestroyDevice(m_Device, m_Allocator);
 		if (m_EnableValidationLayers)
 		{
-			DestroyDebugUtilsMessengerEXT(m_Instance, m_DebugMessenger, nullptr);
+			DestroyDebugUtilsMessengerEXT(m_Instance, m_DebugMessenger, m_Allocator);
 		}
-		vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
-		vkDestroyInstance(m_Instance, nullptr);
+		if (m_Surface != VK_NULL_HANDLE)
+		{
+			vkDestroySurfaceKHR(m_Instance, m_Surface, m_Allocator);
+		}
+		vkDestroyInstance(m_Instance, m_Allocator);
 	}
 
 	void Device::CreateInstance()
@@ -71,11 +87,12 @@ namespace Florencia
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "Test Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		appInfo.apiVersion = VK_API_VERSION_1_2;
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 		createInfo.pApplicationInfo = &appInfo;
 		auto extensions = GetRequiredExtensions();
+		m_DebugUtilsEnabled = std::find_if(extensions.begin(), extensions.end(), [](const char* extension) { return strcmp(extension, VK_EXT_DEBUG_UTILS_EXTENSION_NAME) == 0; }) != extensions.end();
 		createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
 		createInfo.ppEnabledExtensionNames = extensions.data();
 		VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo;
@@ -92,11 +109,41 @@ namespace Florencia
 			createInfo.enabledLayerCount = 0;
 			createInfo.pNext = nullptr;
 		}
-		if (vkCreateInstance(&createInfo, nullptr, &m_Instance) != VK_SUCCESS)
+		if (vkCreateInstance(&createInfo, m_Allocator, &m_Instance) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create instance!");
 		}
 		HasGflwRequiredInstanceExtensions();
+		if (m_DebugUtilsEnabled)
+		{
+			m_SetObjectName = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetInstanceProcAddr(m_Instance, "vkSetDebugUtilsObjectNameEXT");
+			m_CmdBeginLabel = (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(m_Instance, "vkCmdBeginDebugUtilsLabelEXT");
+			m_CmdEndLabel = (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(m_Instance, "vkCmdEndDebugUtilsLabelEXT");
+			//Labels are only useful in pairs
+			if (m_CmdBeginLabel == nullptr || m_CmdEndLabel == nullptr)
+			{
+				m_CmdBeginLabel = nullptr;
+				m_CmdEndLabel = nullptr;
+			}
+		}
+	}
+
+	void Device::NameObject(VkObjectType type, uint64_t handle, const char *name)
+	{
+		VkDebugUtilsObjectNameInfoEXT nameInfo = {};
+		nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+		nameInfo.objectType = type;
+		nameInfo.objectHandle = handle;
+		nameInfo.pObjectName = name;
+		m_SetObjectName(m_Device, &nameInfo);
+	}
+
+	void Device::BeginLabel(VkCommandBuffer commandBuffer, const char *name)
+	{
+		VkDebugUtilsLabelEXT label = {};
+		label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+		label.pLabelName = name;
+		m_CmdBeginLabel(commandBuffer, &label);
 	}
 
 	void Device::PickPhysicalDevice()
@@ -141,15 +188,65 @@ namespace Florencia
 			queueCreateInfo.pQueuePriorities = &queuePriority;
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		//Optional, only used for profiling
+		deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+		m_SupportsPipelineStatistics = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+		//Optional extensions, each one enabled adds its feature struct to the chain
+		std::vector<const char *> extensions = m_Headless ? std::vector<const char *>{} : m_DeviceExtensions;
+		//Frame and upload synchronization, core in 1.2 and checked by IsDeviceSuitable
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		timelineFeatures.timelineSemaphore = VK_TRUE;
+		void *featureChain = &timelineFeatures;
+		//Pipelines are linked from shared library parts when available
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures = {};
+		libraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		libraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+		m_SupportsGraphicsPipelineLibrary = CheckGraphicsPipelineLibrarySupport();
+		if (m_SupportsGraphicsPipelineLibrary)
+		{
+			extensions.insert(extensions.end(), m_PipelineLibraryExtensions.begin(), m_PipelineLibraryExtensions.end());
+			libraryFeatures.pNext = featureChain;
+			featureChain = &libraryFeatures;
+		}
+		//Lets the swapchain render without a render pass or framebuffers
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+		dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+		dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+		m_SupportsDynamicRendering = CheckDynamicRenderingSupport();
+		if (m_SupportsDynamicRendering)
+		{
+			extensions.insert(extensions.end(), m_DynamicRenderingExtensions.begin(), m_DynamicRenderingExtensions.end());
+			dynamicRenderingFeatures.pNext = featureChain;
+			featureChain = &dynamicRenderingFeatures;
+		}
+		//Only used to measure when frames reach the display
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+		presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+		presentIdFeatures.presentId = VK_TRUE;
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+		presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+		presentWaitFeatures.presentWait = VK_TRUE;
+		m_SupportsPresentWait = CheckPresentWaitSupport();
+		if (m_SupportsPresentWait)
+		{
+			extensions.insert(extensions.end(), m_PresentWaitExtensions.begin(), m_PresentWaitExtensions.end());
+			presentIdFeatures.pNext = featureChain;
+			presentWaitFeatures.pNext = &presentIdFeatures;
+			featureChain = &presentWaitFeatures;
+		}
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = featureChain;
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(m_DeviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = m_DeviceExtensions.data();
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+		createInfo.ppEnabledExtensionNames = extensions.data();
 		// might not really be necessary anymore because device specific validation layers
 		// have been deprecated
 		if (m_EnableValidationLayers)
@@ -161,12 +258,114 @@ namespace Florencia
 		{
 			createInfo.enabledLayerCount = 0;
 		}
-		if (vkCreateDevice(m_PhysicalDevice, &createInfo, nullptr, &m_Device) != VK_SUCCESS)
+		if (vkCreateDevice(m_PhysicalDevice, &createInfo, m_Allocator, &m_Device) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create logical device!");
 		}
 		vkGetDeviceQueue(m_Device, indices.m_GraphicsFamily, 0, &m_GraphicsQueue);
 		vkGetDeviceQueue(m_Device, indices.m_PresentFamily, 0, &m_PresentQueue);
+		if (m_SupportsDynamicRendering)
+		{
+			m_CmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(m_Device, "vkCmdBeginRenderingKHR");
+			m_CmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(m_Device, "vkCmdEndRenderingKHR");
+			m_SupportsDynamicRendering = m_CmdBeginRendering != nullptr && m_CmdEndRendering != nullptr;
+		}
+		if (m_SupportsPresentWait)
+		{
+			m_WaitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(m_Device, "vkWaitForPresentKHR");
+			m_SupportsPresentWait = m_WaitForPresent != nullptr;
+		}
+	}
+
+	void Device::CreateTimelineSemaphore()
+	{
+		VkSemaphoreTypeCreateInfo typeInfo = {};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+		VkSemaphoreCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		createInfo.pNext = &typeInfo;
+		if (vkCreateSemaphore(m_Device, &createInfo, m_Allocator, &m_Timeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create timeline semaphore!");
+		}
+	}
+
+	void Device::CreatePipelineCache()
+	{
+		std::vector<char> data;
+		std::ifstream file{ PipelineCachePath, std::ios::ate | std::ios::binary };
+		if (file.is_open())
+		{
+			data.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(data.data(), data.size());
+			if (!file || !IsPipelineCacheCompatible(data))
+			{
+				std::cout << "pipeline cache: ignoring " << PipelineCachePath << ", it was written by a different device or driver" << std::endl;
+				data.clear();
+			}
+		}
+
+		VkPipelineCacheCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		createInfo.initialDataSize = data.size();
+		createInfo.pInitialData = data.empty() ? nullptr : data.data();
+		if (vkCreatePipelineCache(m_Device, &createInfo, m_Allocator, &m_PipelineCache) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+		m_PipelineCacheWarm = !data.empty();
+	}
+
+	// The header layout is fixed by the spec, a cache from another device or driver version must not be handed to the driver
+	bool Device::IsPipelineCacheCompatible(const std::vector<char>& data)
+	{
+		VkPipelineCacheHeaderVersionOne header{};
+		if (data.size() < sizeof(header))
+		{
+			return false;
+		}
+		std::memcpy(&header, data.data(), sizeof(header));
+		return header.headerSize >= sizeof(header) && header.headerSize <= data.size() &&
+			header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			header.vendorID == properties.vendorID &&
+			header.deviceID == properties.deviceID &&
+			std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+
+	// Written to a temporary file first and renamed over the old cache, so a crash mid write never leaves a truncated cache behind
+	void Device::SavePipelineCache()
+	{
+		size_t size = 0;
+		if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, nullptr) != VK_SUCCESS || size == 0)
+		{
+			return;
+		}
+		std::vector<char> data(size);
+		if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, data.data()) != VK_SUCCESS)
+		{
+			return;
+		}
+
+		std::string temporaryPath = std::string(PipelineCachePath) + ".tmp";
+		{
+			std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+			file.write(data.data(), size);
+			if (!file)
+			{
+				std::cerr << "pipeline cache: failed to write " << temporaryPath << '\n';
+				return;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, PipelineCachePath, error);
+		if (error)
+		{
+			std::cerr << "pipeline cache: failed to replace " << PipelineCachePath << ": " << error.message() << '\n';
+			std::filesystem::remove(temporaryPath, error);
+		}
 	}
 
 	void Device::CreateCommandPool()
@@ -179,27 +378,28 @@ namespace Florencia
 		poolInfo.flags =
 			VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-		if (vkCreateCommandPool(m_Device, &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
+		if (vkCreateCommandPool(m_Device, &poolInfo, m_Allocator, &m_CommandPool) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create command pool!");
 		}
 	}
 
-	void Device::CreateSurface() { m_Window.CreateWindowSurface(m_Instance, &m_Surface); }
+	void Device::CreateSurface() { m_Window.CreateWindowSurface(m_Instance, m_Allocator, &m_Surface); }
 
 	bool Device::IsDeviceSuitable(VkPhysicalDevice device)
 	{
 		QueueFamilyIndices indices = FindQueueFamilies(device);
 		bool extensionsSupported = CheckDeviceExtensionSupport(device);
-		bool swapChainAdequate = false;
-		if (extensionsSupported)
+		//Headless devices render into offscreen targets, they never need a surface to present to
+		bool swapChainAdequate = m_Headless;
+		if (extensionsSupported && !m_Headless)
 		{
 			SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
 			swapChainAdequate = !swapChainSupport.m_Formats.empty() && !swapChainSupport.m_PresentModes.empty();
 		}
 		VkPhysicalDeviceFeatures supportedFeatures;
 		vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
-		return indices.IsComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+		return indices.IsComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy && CheckTimelineSemaphoreSupport(device);
 	}
 
 	void Device::PopulateDebugMessengerCreateInfo(
@@ -219,7 +419,7 @@ namespace Florencia
 			return;
 		VkDebugUtilsMessengerCreateInfoEXT createInfo;
 		PopulateDebugMessengerCreateInfo(createInfo);
-		if (CreateDebugUtilsMessengerEXT(m_Instance, &createInfo, nullptr, &m_DebugMessenger) != VK_SUCCESS)
+		if (CreateDebugUtilsMessengerEXT(m_Instance, &createInfo, m_Allocator, &m_DebugMessenger) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to set up debug messenger!");
 		}
@@ -252,17 +452,38 @@ namespace Florencia
 
 	std::vector<const char *> Device::GetRequiredExtensions()
 	{
-		uint32_t glfwExtensionCount = 0;
-		const char **glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-		std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
-		if (m_EnableValidationLayers)
+		std::vector<const char *> extensions;
+		if (!m_Headless)
+		{
+			uint32_t glfwExtensionCount = 0;
+			const char **glfwExtensions;
+			glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+			extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		}
+		//Also enabled without validation when available, so names and labels reach capture tools
+		if (m_EnableValidationLayers || CheckInstanceExtensionSupport(VK_EXT_DEBUG_UTILS_EXTENSION_NAME))
 		{
 			extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 		}
 		return extensions;
 	}
 
+	bool Device::CheckInstanceExtensionSupport(const char *extension)
+	{
+		uint32_t extensionCount = 0;
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> extensions(extensionCount);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+		for (const auto &available : extensions)
+		{
+			if (strcmp(available.extensionName, extension) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void Device::HasGflwRequiredInstanceExtensions()
 	{
 		uint32_t extensionCount = 0;
@@ -288,13 +509,15 @@ namespace Florencia
 		}
 	}
 
-	bool Device::CheckDeviceExtensionSupport(VkPhysicalDevice device)
+	bool Device::CheckDeviceExtensionSupport(VkPhysicalDevice device) { return m_Headless || CheckDeviceExtensionSupport(device, m_DeviceExtensions); }
+
+	bool Device::CheckDeviceExtensionSupport(VkPhysicalDevice device, const std::vector<const char *> &extensions)
 	{
 		uint32_t extensionCount;
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
-		std::set<std::string> requiredExtensions(m_DeviceExtensions.begin(), m_DeviceExtensions.end());
+		std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
 		for (const auto &extension : availableExtensions)
 		{
 			requiredExtensions.erase(extension.extensionName);
@@ -302,6 +525,78 @@ namespace Florencia
 		return requiredExtensions.empty();
 	}
 
+	bool Device::CheckGraphicsPipelineLibrarySupport()
+	{
+		if (properties.apiVersion < VK_API_VERSION_1_1 || !CheckDeviceExtensionSupport(m_PhysicalDevice, m_PipelineLibraryExtensions))
+		{
+			return false;
+		}
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures = {};
+		libraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &libraryFeatures;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features);
+
+		VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties = {};
+		libraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+		VkPhysicalDeviceProperties2 deviceProperties = {};
+		deviceProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		deviceProperties.pNext = &libraryProperties;
+		vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &deviceProperties);
+		return libraryFeatures.graphicsPipelineLibrary == VK_TRUE && libraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+	}
+
+	bool Device::CheckTimelineSemaphoreSupport(VkPhysicalDevice device)
+	{
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(device, &deviceProperties);
+		if (deviceProperties.apiVersion < VK_API_VERSION_1_2)
+		{
+			return false;
+		}
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &timelineFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &features);
+		return timelineFeatures.timelineSemaphore == VK_TRUE;
+	}
+
+	bool Device::CheckPresentWaitSupport()
+	{
+		if (m_Headless || !CheckDeviceExtensionSupport(m_PhysicalDevice, m_PresentWaitExtensions))
+		{
+			return false;
+		}
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+		presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+		presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+		presentWaitFeatures.pNext = &presentIdFeatures;
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &presentWaitFeatures;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features);
+		return presentIdFeatures.presentId == VK_TRUE && presentWaitFeatures.presentWait == VK_TRUE;
+	}
+
+	bool Device::CheckDynamicRenderingSupport()
+	{
+		if (properties.apiVersion < VK_API_VERSION_1_2 || !CheckDeviceExtensionSupport(m_PhysicalDevice, m_DynamicRenderingExtensions))
+		{
+			return false;
+		}
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+		dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &dynamicRenderingFeatures;
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features);
+		return dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+	}
+
 	QueueFamilyIndices Device::FindQueueFamilies(VkPhysicalDevice device)
 	{
 		QueueFamilyIndices indices;
@@ -317,8 +612,12 @@ namespace Florencia
 				indices.m_GraphicsFamily = i;
 				indices.m_GraphicsFamilyHasValue = true;
 			}
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
+			//Without a surface nothing is presented, the present queue is just the graphics queue
+			VkBool32 presentSupport = m_Headless && indices.m_GraphicsFamilyHasValue && indices.m_GraphicsFamily == static_cast<uint32_t>(i);
+			if (!m_Headless)
+			{
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
+			}
 			if (queueFamily.queueCount > 0 && presentSupport)
 			{
 				indices.m_PresentFamily = i;
@@ -401,7 +700,7 @@ namespace Florencia
 		bufferInfo.size = size;
 		bufferInfo.usage = usage;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		if (vkCreateBuffer(m_Device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+		if (vkCreateBuffer(m_Device, &bufferInfo, m_Allocator, &buffer) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create vertex buffer!");
 		}
@@ -411,13 +710,48 @@ namespace Florencia
 		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
-		if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+		if (vkAllocateMemory(m_Device, &allocInfo, m_Allocator, &bufferMemory) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to allocate vertex buffer memory!");
 		}
+		RecordAllocation(bufferMemory, memRequirements.size);
 		vkBindBufferMemory(m_Device, buffer, bufferMemory, 0);
 	}
 
+	void Device::FreeMemory(VkDeviceMemory memory)
+	{
+		if (memory == VK_NULL_HANDLE)
+		{
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_MemoryMutex);
+			auto allocation = m_Allocations.find(memory);
+			if (allocation != m_Allocations.end())
+			{
+				m_MemoryStatistics.m_AllocatedBytes -= allocation->second;
+				m_MemoryStatistics.m_AllocationCount--;
+				m_Allocations.erase(allocation);
+			}
+		}
+		vkFreeMemory(m_Device, memory, m_Allocator);
+	}
+
+	DeviceMemoryStatistics Device::GetMemoryStatistics()
+	{
+		std::lock_guard<std::mutex> lock(m_MemoryMutex);
+		return m_MemoryStatistics;
+	}
+
+	void Device::RecordAllocation(VkDeviceMemory memory, VkDeviceSize size)
+	{
+		std::lock_guard<std::mutex> lock(m_MemoryMutex);
+		m_Allocations[memory] = size;
+		m_MemoryStatistics.m_AllocationCount++;
+		m_MemoryStatistics.m_AllocatedBytes += size;
+		m_MemoryStatistics.m_PeakAllocatedBytes = std::max(m_MemoryStatistics.m_PeakAllocatedBytes, m_MemoryStatistics.m_AllocatedBytes);
+	}
+
 	VkCommandBuffer Device::BeginSingleTimeCommands()
 	{
 		VkCommandBufferAllocateInfo allocInfo{};
@@ -441,11 +775,95 @@ namespace Florencia
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
-		vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(m_GraphicsQueue);
+		//Waits for this upload only, vkQueueWaitIdle would also wait for every frame in flight to be presented
+		WaitForValue(SubmitGraphics(submitInfo));
 		vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &commandBuffer);
 	}
 
+	uint64_t Device::SubmitGraphics(const VkSubmitInfo &submitInfo)
+	{
+		constexpr uint32_t maxSignalSemaphores = 8;
+		if (submitInfo.signalSemaphoreCount >= maxSignalSemaphores)
+		{
+			throw std::runtime_error("Too Many Signal Semaphores In One Submission");
+		}
+		std::array<VkSemaphore, maxSignalSemaphores> signalSemaphores{};
+		std::array<uint64_t, maxSignalSemaphores> signalValues{};
+		std::copy(submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount, signalSemaphores.begin());
+
+		std::lock_guard<std::mutex> lock(m_SubmitMutex);
+		uint64_t value = m_LastSubmittedValue.load() + 1;
+		//Values of binary semaphores in the same submission are ignored
+		signalSemaphores[submitInfo.signalSemaphoreCount] = m_Timeline;
+		signalValues[submitInfo.signalSemaphoreCount] = value;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.pNext = submitInfo.pNext;
+		timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount + 1;
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+		VkSubmitInfo timelineSubmitInfo = submitInfo;
+		timelineSubmitInfo.pNext = &timelineInfo;
+		timelineSubmitInfo.signalSemaphoreCount = submitInfo.signalSemaphoreCount + 1;
+		timelineSubmitInfo.pSignalSemaphores = signalSemaphores.data();
+		if (vkQueueSubmit(m_GraphicsQueue, 1, &timelineSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit to the graphics queue!");
+		}
+		m_LastSubmittedValue = value;
+		return value;
+	}
+
+	bool Device::IsComplete(uint64_t value)
+	{
+		if (value <= m_CompletedValue.load())
+		{
+			return true;
+		}
+		uint64_t completed = 0;
+		vkGetSemaphoreCounterValue(m_Device, m_Timeline, &completed);
+		RecordCompletedValue(completed);
+		return value <= completed;
+	}
+
+	void Device::RecordCompletedValue(uint64_t completed)
+	{
+		//Other threads may have seen a later value in the meantime
+		uint64_t known = m_CompletedValue.load();
+		while (completed > known && !m_CompletedValue.compare_exchange_weak(known, completed)) {}
+	}
+
+	void Device::WaitForValue(uint64_t value)
+	{
+		if (IsComplete(value))
+		{
+			return;
+		}
+		auto start = std::chrono::high_resolution_clock::now();
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &m_Timeline;
+		waitInfo.pValues = &value;
+		if (vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to wait for the timeline semaphore!");
+		}
+		auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+		m_TimelineWaitCount++;
+		m_TimelineWaitNanoseconds += static_cast<uint64_t>(waited.count());
+		RecordCompletedValue(value);
+	}
+
+	TimelineWaitStatistics Device::GetTimelineWaitStatistics() const
+	{
+		TimelineWaitStatistics statistics{};
+		statistics.m_WaitCount = m_TimelineWaitCount.load();
+		statistics.m_WaitMilliseconds = static_cast<double>(m_TimelineWaitNanoseconds.load()) / 1000000.0;
+		return statistics;
+	}
+
 	void Device::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 	{
 		VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
@@ -481,7 +899,7 @@ namespace Florencia
 		VkImage &image,
 		VkDeviceMemory &imageMemory)
 	{
-		if (vkCreateImage(m_Device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+		if (vkCreateImage(m_Device, &imageInfo, m_Allocator, &image) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create image!");
 		}
@@ -491,10 +909,11 @@ namespace Florencia
 		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
-		if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+		if (vkAllocateMemory(m_Device, &allocInfo, m_Allocator, &imageMemory) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to allocate image memory!");
 		}
+		RecordAllocation(imageMemory, memRequirements.size);
 		if (vkBindImageMemory(m_Device, image, imageMemory, 0) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to bind image memory!");
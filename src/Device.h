@@ -1,6 +1,11 @@
 #pragma once
 #include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
+#include "AllocationTracker.h"
 #include "Window.h"
 
 namespace Florencia {
@@ -18,6 +23,19 @@ namespace Florencia {
 		bool IsComplete() { return m_GraphicsFamilyHasValue && m_PresentFamilyHasValue; }
 	};
 
+	//Cpu waits on the timeline that actually blocked, waiting for work that had already completed is not counted
+	struct TimelineWaitStatistics {
+		uint64_t m_WaitCount = 0;
+		double m_WaitMilliseconds = 0.0;
+	};
+
+	//Device memory allocated through CreateBuffer and CreateImageWithInfo and not yet released with FreeMemory
+	struct DeviceMemoryStatistics {
+		uint64_t m_AllocationCount = 0;
+		VkDeviceSize m_AllocatedBytes = 0;
+		VkDeviceSize m_PeakAllocatedBytes = 0;
+	};
+
 	class Device {
 	public:
 		Device(Window& window);
@@ -30,10 +48,47 @@ namespace Florencia {
 		Device& operator=(const Device&) = delete;
 
 		VkDevice Get() { return m_Device; }
+		//Host allocation callbacks for every object created on this device, nullptr leaves the driver to its own allocator
+		const VkAllocationCallbacks* GetAllocator() const { return m_Allocator; }
 		VkSurfaceKHR GetSurface() { return m_Surface; }
+		//Created for a headless window, there is no surface and the swapchain renders into offscreen targets
+		bool IsHeadless() const { return m_Headless; }
 		VkQueue PresentQueue() { return m_PresentQueue; }
 		VkQueue GraphicsQueue() { return m_GraphicsQueue; }
 		VkCommandPool GetCommandPool() { return m_CommandPool; }
+		//Shared by every pipeline, loaded from PipelineCachePath at startup and written back on destruction
+		VkPipelineCache GetPipelineCache() { return m_PipelineCache; }
+		//False when the cache started empty because there was no valid file for this device
+		bool IsPipelineCacheWarm() const { return m_PipelineCacheWarm; }
+		bool SupportsPipelineStatistics() const { return m_SupportsPipelineStatistics; }
+		//Only reported when the driver also links libraries quickly, otherwise whole pipelines are cheaper
+		bool SupportsGraphicsPipelineLibrary() const { return m_SupportsGraphicsPipelineLibrary; }
+		bool SupportsDynamicRendering() const { return m_SupportsDynamicRendering; }
+		//Presents can then be tagged with an id and waited on until they reach the display
+		bool SupportsPresentWait() const { return m_SupportsPresentWait; }
+
+		//VK_KHR_dynamic_rendering entry points, only valid when SupportsDynamicRendering
+		void CmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR* renderingInfo) { m_CmdBeginRendering(commandBuffer, renderingInfo); }
+		void CmdEndRendering(VkCommandBuffer commandBuffer) { m_CmdEndRendering(commandBuffer); }
+		//VK_KHR_present_wait, only valid when SupportsPresentWait
+		VkResult WaitForPresent(VkSwapchainKHR swapChain, uint64_t presentId, uint64_t timeout) { return m_WaitForPresent(m_Device, swapChain, presentId, timeout); }
+
+		//VK_EXT_debug_utils names and labels, shown by validation messages and capture tools instead of raw handles
+		//Each call is a null check when the extension is absent
+		bool SupportsDebugUtils() const { return m_SetObjectName != nullptr; }
+		template<typename Handle>
+		void SetObjectName(VkObjectType type, Handle handle, const char* name) { if (m_SetObjectName != nullptr) { NameObject(type, (uint64_t)handle, name); } }
+		//Regions must begin and end in the same command buffer, and within one subpass when begun inside a render pass
+		void CmdBeginLabel(VkCommandBuffer commandBuffer, const char* name) { if (m_CmdBeginLabel != nullptr) { BeginLabel(commandBuffer, name); } }
+		void CmdEndLabel(VkCommandBuffer commandBuffer) { if (m_CmdEndLabel != nullptr) { m_CmdEndLabel(commandBuffer); } }
+
+		//Every graphics queue submission goes through SubmitGraphics and signals the timeline semaphore with the next value,
+		//so any subsystem can tell whether a frame, upload or readback it submitted has completed from the returned value
+		uint64_t SubmitGraphics(const VkSubmitInfo& submitInfo);
+		uint64_t GetLastSubmittedValue() const { return m_LastSubmittedValue.load(); }
+		bool IsComplete(uint64_t value);
+		void WaitForValue(uint64_t value);
+		TimelineWaitStatistics GetTimelineWaitStatistics() const;
 
 		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 		QueueFamilyIndices FindPhysicalQueueFamilies() { return FindQueueFamilies(m_PhysicalDevice); }
@@ -47,9 +102,14 @@ namespace Florencia {
 		void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 		void CreateImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
 		void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+		//Frees memory from CreateBuffer or CreateImageWithInfo, keeping GetMemoryStatistics in step
+		void FreeMemory(VkDeviceMemory memory);
+		DeviceMemoryStatistics GetMemoryStatistics();
 
 		VkPhysicalDeviceProperties properties;
 		bool m_EnableValidationLayers = true;
+		//Relative to the working directory, like the build output
+		static constexpr const char* PipelineCachePath = "pipeline_cache.bin";
 	private:
 		void CreateSurface();
 		void CreateInstance();
@@ -57,29 +117,89 @@ namespace Florencia {
 		void PickPhysicalDevice();
 		void SetupDebugMessenger();
 		void CreateLogicalDevice();
+		void CreateTimelineSemaphore();
+		void RecordCompletedValue(uint64_t completed);
+		void RecordAllocation(VkDeviceMemory memory, VkDeviceSize size);
+		void CreatePipelineCache();
+		void SavePipelineCache();
 
 		// helper functions
 		bool CheckValidationLayerSupport();
+		bool CheckInstanceExtensionSupport(const char* extension);
 		void HasGflwRequiredInstanceExtensions();
 		bool IsDeviceSuitable(VkPhysicalDevice device);
 		std::vector<const char*> GetRequiredExtensions();
 		bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+		bool CheckDeviceExtensionSupport(VkPhysicalDevice device, const std::vector<const char*>& extensions);
+		bool CheckGraphicsPipelineLibrarySupport();
+		bool CheckDynamicRenderingSupport();
+		bool CheckPresentWaitSupport();
+		bool CheckTimelineSemaphoreSupport(VkPhysicalDevice device);
+		bool IsPipelineCacheCompatible(const std::vector<char>& data);
 		QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
 		SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device);
 		void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
+		void NameObject(VkObjectType type, uint64_t handle, const char* name);
+		void BeginLabel(VkCommandBuffer commandBuffer, const char* name);
 
 		Window& m_Window;
+		bool m_Headless = false;
+		const VkAllocationCallbacks* m_Allocator = AllocationTracker::GetVulkanCallbacks();
 		VkInstance m_Instance;
 		VkCommandPool m_CommandPool;
+		VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+		bool m_PipelineCacheWarm = false;
 		VkDebugUtilsMessengerEXT m_DebugMessenger;
+		bool m_DebugUtilsEnabled = false;
+		PFN_vkSetDebugUtilsObjectNameEXT m_SetObjectName = nullptr;
+		PFN_vkCmdBeginDebugUtilsLabelEXT m_CmdBeginLabel = nullptr;
+		PFN_vkCmdEndDebugUtilsLabelEXT m_CmdEndLabel = nullptr;
 		VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
+		bool m_SupportsPipelineStatistics = false;
+		bool m_SupportsGraphicsPipelineLibrary = false;
+		bool m_SupportsDynamicRendering = false;
+		PFN_vkCmdBeginRenderingKHR m_CmdBeginRendering = nullptr;
+		PFN_vkCmdEndRenderingKHR m_CmdEndRendering = nullptr;
+		bool m_SupportsPresentWait = false;
+		PFN_vkWaitForPresentKHR m_WaitForPresent = nullptr;
 
 		VkDevice m_Device;
-		VkSurfaceKHR m_Surface;
+		VkSurfaceKHR m_Surface = VK_NULL_HANDLE;
 		VkQueue m_GraphicsQueue;
 		VkQueue m_PresentQueue;
+
+		VkSemaphore m_Timeline = VK_NULL_HANDLE;
+		//Held while a value is assigned and submitted, values have to reach the queue in increasing order
+		std::mutex m_SubmitMutex;
+		std::atomic<uint64_t> m_LastSubmittedValue{ 0 };
+		std::atomic<uint64_t> m_CompletedValue{ 0 };
+		std::atomic<uint64_t> m_TimelineWaitCount{ 0 };
+		std::atomic<uint64_t> m_TimelineWaitNanoseconds{ 0 };
+
+		//Buffers are also created by pipeline build and upload jobs
+		std::mutex m_MemoryMutex;
+		std::unordered_map<VkDeviceMemory, VkDeviceSize> m_Allocations;
+		DeviceMemoryStatistics m_MemoryStatistics;
 		
 		const std::vector<const char*> m_ValidationLayers = { "VK_LAYER_KHRONOS_validation" };
 		const std::vector<const char*> m_DeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+		const std::vector<const char*> m_PipelineLibraryExtensions = { VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME };
+		//Its dependencies, depth stencil resolve and create render pass 2, are core in 1.2
+		const std::vector<const char*> m_DynamicRenderingExtensions = { VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME };
+		const std::vector<const char*> m_PresentWaitExtensions = { VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME };
+	};
+
+	//Labels everything recorded while it lives
+	class DebugLabelScope {
+	public:
+		DebugLabelScope(Device& device, VkCommandBuffer commandBuffer, const char* name) : m_Device{ device }, m_CommandBuffer{ commandBuffer } { m_Device.CmdBeginLabel(commandBuffer, name); }
+		~DebugLabelScope() { m_Device.CmdEndLabel(m_CommandBuffer); }
+
+		DebugLabelScope(const DebugLabelScope&) = delete;
+		DebugLabelScope& operator=(const DebugLabelScope&) = delete;
+
+	private:
+		Device& m_Device;
+		VkCommandBuffer m_CommandBuffer;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "FrameArena.h"
+#include <algorithm>
+
+namespace Florencia {
+
+	namespace {
+
+		//Aligns the address rather than the offset, the blocks themselves are only aligned for max_align_t
+		size_t AlignedOffset(const std::byte* base, size_t offset, size_t alignment) {
+			uintptr_t address = reinterpret_cast<uintptr_t>(base) + offset;
+			uintptr_t aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+			return offset + static_cast<size_t>(aligned - address);
+		}
+
+	}
+
+	FrameArena::FrameArena(size_t capacity, uint32_t frameCount) : m_Frames(frameCount) {
+		for (Block& block : m_Frames) {
+			block.m_Memory = std::make_unique<std::byte[]>(capacity);
+			block.m_Size = capacity;
+		}
+		m_Current = &m_Frames[0];
+	}
+
+	void FrameArena::BeginFrame(int frameIndex) {
+		Block& block = m_Frames[frameIndex];
+		if (!block.m_Overflow.empty()) {
+			block.m_Size = std::max(block.m_Size * 2, block.m_Used + block.m_OverflowBytes);
+			block.m_Memory = std::make_unique<std::byte[]>(block.m_Size);
+			block.m_Overflow.clear();
+			block.m_OverflowBytes = 0;
+		}
+		block.m_Used = 0;
+		m_Current = &block;
+	}
+
+	void* FrameArena::Allocate(size_t size, size_t alignment) {
+		Block& block = *m_Current;
+		size_t offset = AlignedOffset(block.m_Memory.get(), block.m_Used, alignment);
+		if (offset + size <= block.m_Size) {
+			block.m_Used = offset + size;
+			m_PeakBytes = std::max(m_PeakBytes, block.m_Used + block.m_OverflowBytes);
+			return block.m_Memory.get() + offset;
+		}
+
+		//Every spill gets its own block, they are only kept until the block is grown
+		block.m_Overflow.push_back(std::make_unique<std::byte[]>(size + alignment));
+		block.m_OverflowBytes += size + alignment;
+		m_OverflowCount++;
+		m_PeakBytes = std::max(m_PeakBytes, block.m_Used + block.m_OverflowBytes);
+		std::byte* memory = block.m_Overflow.back().get();
+		return memory + AlignedOffset(memory, 0, alignment);
+	}
+
+	size_t FrameArena::GetCapacity() const {
+		size_t capacity = 0;
+		for (const Block& block : m_Frames) { capacity += block.m_Size; }
+		return capacity;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Florencia {
+
+	//Linear allocator for memory that only lives for one frame, with one block per frame in flight. Allocating bumps an offset,
+	//nothing is freed until BeginFrame comes back around to the same frame index and releases the whole block at once
+	//A frame that doesn't fit spills into heap blocks, the next BeginFrame for that index grows its block to cover them,
+	//so after a few frames of the same workload nothing touches the heap. Only the thread recording the frame may use it
+	class FrameArena {
+	public:
+		FrameArena(size_t capacity, uint32_t frameCount);
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		//Releases everything allocated the last time frameIndex began, and everything allocated after this goes into its block
+		void BeginFrame(int frameIndex);
+
+		//alignment is a power of two
+		void* Allocate(size_t size, size_t alignment);
+		template<typename T>
+		T* Allocate(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+		size_t GetCapacity() const;
+		//Most bytes any single frame has allocated, spilled ones included
+		size_t GetPeakBytes() const { return m_PeakBytes; }
+		//Heap blocks taken because a frame outgrew its block, should stop increasing once the workload is steady
+		uint32_t GetOverflowCount() const { return m_OverflowCount; }
+
+	private:
+		struct Block {
+			std::unique_ptr<std::byte[]> m_Memory;
+			size_t m_Size = 0;
+			size_t m_Used = 0;
+			std::vector<std::unique_ptr<std::byte[]>> m_Overflow;
+			size_t m_OverflowBytes = 0;
+		};
+
+		std::vector<Block> m_Frames;
+		Block* m_Current = nullptr;
+		size_t m_PeakBytes = 0;
+		uint32_t m_OverflowCount = 0;
+	};
+
+	//Standard allocator over a FrameArena, deallocate does nothing since the arena releases the memory when its frame comes around
+	//again. Without an arena it falls back to the global heap, so containers that are only sometimes per frame can use one type
+	template<typename T>
+	class FrameAllocator {
+	public:
+		using value_type = T;
+
+		FrameAllocator() = default;
+		FrameAllocator(FrameArena* arena) : m_Arena{ arena } {}
+		template<typename U>
+		FrameAllocator(const FrameAllocator<U>& other) : m_Arena{ other.GetArena() } {}
+
+		T* allocate(size_t count) {
+			if (m_Arena == nullptr) { return static_cast<T*>(::operator new(count * sizeof(T))); }
+			return m_Arena->Allocate<T>(count);
+		}
+		void deallocate(T* memory, size_t) {
+			if (m_Arena == nullptr) { ::operator delete(memory); }
+		}
+
+		FrameArena* GetArena() const { return m_Arena; }
+
+		template<typename U>
+		bool operator==(const FrameAllocator<U>& other) const { return m_Arena == other.GetArena(); }
+		template<typename U>
+		bool operator!=(const FrameAllocator<U>& other) const { return m_Arena != other.GetArena(); }
+
+	private:
+		FrameArena* m_Arena = nullptr;
+	};
+
+	template<typename T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "FrameCapture.h"
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace Florencia {
+
+	FrameCapture::FrameCapture(Device& device, uint32_t frameCount, const std::string& pathPrefix)
+		: m_Device{ device }, m_PathPrefix{ pathPrefix }, m_Readbacks(frameCount), m_Pending(frameCount) {}
+
+	void FrameCapture::Record(VkCommandBuffer commandBuffer, int frameIndex, VkImage image, VkExtent2D extent, VkFormat format) {
+		VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+		if (m_Readbacks[frameIndex] == nullptr || m_Readbacks[frameIndex]->GetBufferSize() != size) {
+			m_Readbacks[frameIndex] = std::make_unique<Buffer>(m_Device, size, 1, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			m_Readbacks[frameIndex]->Map();
+		}
+
+		//The final layout transition happens at the end of the render pass, all commands is the only stage that chains with it
+		VkImageMemoryBarrier toTransfer{};
+		toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		toTransfer.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.image = image;
+		toTransfer.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { extent.width, extent.height, 1 };
+		vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Readbacks[frameIndex]->GetBuffer(), 1, &region);
+
+		VkBufferMemoryBarrier toHost{};
+		toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.buffer = m_Readbacks[frameIndex]->GetBuffer();
+		toHost.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+		m_Pending[frameIndex] = { true, m_NextFrameNumber++, extent, format };
+	}
+
+	void FrameCapture::Write(int frameIndex) {
+		PendingFrame& pending = m_Pending[frameIndex];
+		if (!pending.m_Recorded) { return; }
+		pending.m_Recorded = false;
+
+		std::ostringstream path;
+		path << m_PathPrefix << std::setw(5) << std::setfill('0') << pending.m_FrameNumber << ".ppm";
+		std::ofstream file(path.str(), std::ios::binary);
+		if (!file) throw std::runtime_error("Failed to Open Capture File " + path.str());
+		file << "P6\n" << pending.m_Extent.width << " " << pending.m_Extent.height << "\n255\n";
+
+		//Pixels are stored as they were rendered, already srgb encoded, only bgra needs swizzling
+		bool bgra = pending.m_Format == VK_FORMAT_B8G8R8A8_SRGB || pending.m_Format == VK_FORMAT_B8G8R8A8_UNORM;
+		const uint8_t* pixels = static_cast<const uint8_t*>(m_Readbacks[frameIndex]->GetMappedMemory());
+		std::vector<uint8_t> row(static_cast<size_t>(pending.m_Extent.width) * 3);
+		for (uint32_t y = 0; y < pending.m_Extent.height; y++) {
+			const uint8_t* source = pixels + static_cast<size_t>(y) * pending.m_Extent.width * 4;
+			for (uint32_t x = 0; x < pending.m_Extent.width; x++) {
+				row[x * 3 + 0] = source[x * 4 + (bgra ? 2 : 0)];
+				row[x * 3 + 1] = source[x * 4 + 1];
+				row[x * 3 + 2] = source[x * 4 + (bgra ? 0 : 2)];
+			}
+			file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+		}
+		m_WrittenFrames++;
+	}
+
+	void FrameCapture::WriteAll() {
+		for (size_t i = 0; i < m_Pending.size(); i++) { Write(static_cast<int>(i)); }
+	}
+
+}
\ No newline at end of file
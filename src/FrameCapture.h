@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Buffer.h"
+
+namespace Florencia {
+
+	//Copies the finished color image of each frame into a host visible buffer of its frame slot, the copy is written out
+	//as a binary ppm once the timeline has passed that frame, named <prefix><frame number>.ppm
+	class FrameCapture {
+	public:
+		FrameCapture(Device& device, uint32_t frameCount, const std::string& pathPrefix);
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		//Must be recorded outside of a render pass, with the image already in TRANSFER_SRC_OPTIMAL
+		void Record(VkCommandBuffer commandBuffer, int frameIndex, VkImage image, VkExtent2D extent, VkFormat format);
+		//Writes the copy recorded for this frame index, the frame must have completed
+		void Write(int frameIndex);
+		//Writes every pending copy, every recorded frame must have completed
+		void WriteAll();
+
+		uint32_t GetWrittenFrameCount() const { return m_WrittenFrames; }
+
+	private:
+		struct PendingFrame {
+			bool m_Recorded = false;
+			uint32_t m_FrameNumber = 0;
+			VkExtent2D m_Extent{};
+			VkFormat m_Format = VK_FORMAT_UNDEFINED;
+		};
+
+		Device& m_Device;
+		std::string m_PathPrefix;
+		std::vector<std::unique_ptr<Buffer>> m_Readbacks;
+		std::vector<PendingFrame> m_Pending;
+		uint32_t m_NextFrameNumber = 0;
+		uint32_t m_WrittenFrames = 0;
+	};
+
+}
\ No newline at end of file
@@ -1,14 +1,16 @@
 #pragma once
+#include "SpatialIndex.h"
+#include "FrameArena.h"
 #include "GameObject.h"
 #include "Camera.h"
 
-#define MAX_LIGHTS 10
-
 namespace Florencia {
 
+	class OcclusionCuller;
+
 	struct PointLight {
-		glm::vec4 m_Position{};
-		glm::vec4 m_Color{};
+		glm::vec4 m_Position{}; //4th component is the cutoff radius
+		glm::vec4 m_Color{}; //4th component is light intensity
 	};
 
 	struct GlobalUBO {
@@ -16,8 +18,16 @@ namespace Florencia {
 		glm::mat4 m_ViewMatrix{1.0f};
 		glm::mat4 m_InverseViewMatrix{1.0f};
 		glm::vec4 m_AmbientLightColor{0.0f, 0.0f, 0.0f, 0.0f}; //4th component is light intensity
-		PointLight m_PointLights[MAX_LIGHTS];
-		int numLights;
+		glm::uvec4 m_ClusterGrid{ 0 }; //Tiles across, tiles down and depth slices, 4th component is the light count
+		glm::vec4 m_ClusterDepth{ 0.0f }; //Depth slice of a view depth is log(depth) * x + y
+	};
+
+	//Commands the render systems recorded this frame
+	struct RenderStatistics {
+		uint32_t m_DrawCalls = 0;
+		uint32_t m_PipelineBinds = 0;
+		uint32_t m_DescriptorSetBinds = 0;
+		uint32_t m_VertexBufferBinds = 0;
 	};
 
 	struct FrameInfo {
@@ -26,7 +36,15 @@ namespace Florencia {
 		float m_FrameTime;
 		VkCommandBuffer m_CommandBuffer;
 		VkDescriptorSet m_GlobalDescriptorSet;
-		GameObject::Map_t& m_GameObjects;
+		VkDescriptorSet m_LightingDescriptorSet;
+		Registry& m_Registry;
+		SpatialIndex& m_SpatialIndex;
+		//Scratch memory for anything that doesn't outlive the frame, see FrameArena
+		FrameArena& m_FrameArena;
+		OcclusionCuller* m_OcclusionCuller = nullptr;
+		//Last pipeline bound to m_CommandBuffer, lets systems skip rebinding a pipeline they share
+		VkPipeline m_BoundPipeline = VK_NULL_HANDLE;
+		RenderStatistics m_Statistics{};
 	};
 
 }
\ No newline at end of file
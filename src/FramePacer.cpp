@@ -0,0 +1,68 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+namespace Florencia {
+
+	namespace {
+
+		//Weight of the newest sample in the running averages the deadline is predicted from
+		constexpr double PredictionWeight = 0.1;
+
+		double Milliseconds(std::chrono::high_resolution_clock::duration duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+		//The first sample is taken as is so the prediction doesn't start out at zero
+		void AddToPrediction(double& prediction, double sample) { prediction = prediction == 0.0 ? sample : prediction + (sample - prediction) * PredictionWeight; }
+
+		void AddToAverage(double& average, uint32_t count, double sample) { average += (sample - average) / static_cast<double>(count); }
+
+	}
+
+	void FramePacer::SleepUntilDeadline() {
+		if (m_Presented) {
+			double startAfter = m_PresentIntervalMilliseconds - m_WorkMilliseconds - SafetyMarginMilliseconds;
+			auto deadline = m_LastPresentTime + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(startAfter));
+			if (deadline > Clock::now()) { std::this_thread::sleep_until(deadline); }
+		}
+		m_WakeTime = Clock::now();
+	}
+
+	void FramePacer::InputSampled() { m_InputTime = Clock::now(); }
+
+	void FramePacer::FramePresented() {
+		Clock::time_point now = Clock::now();
+		if (m_Presented) { AddToPrediction(m_PresentIntervalMilliseconds, Milliseconds(now - m_LastPresentTime)); }
+		//Only known once SleepUntilDeadline has been called
+		if (m_WakeTime != Clock::time_point{}) { AddToPrediction(m_WorkMilliseconds, Milliseconds(now - m_WakeTime)); }
+		m_LastPresentTime = now;
+		m_Presented = true;
+
+		double inputToPresent = Milliseconds(now - m_InputTime);
+		AddToAverage(m_Statistics.m_AverageInputToPresentMilliseconds, ++m_Statistics.m_PresentedFrames, inputToPresent);
+		m_Statistics.m_MaxInputToPresentMilliseconds = std::max(m_Statistics.m_MaxInputToPresentMilliseconds, inputToPresent);
+
+		uint64_t presentId = m_Renderer.GetLastPresentId();
+		if (presentId != 0) { m_PendingPresents.push_back({ presentId, m_Renderer.GetSwapChainRecreationCount(), m_InputTime }); }
+		PollDisplayedFrames();
+	}
+
+	//Never blocks, a zero timeout only tells whether each present has reached the display yet
+	void FramePacer::PollDisplayedFrames() {
+		while (!m_PendingPresents.empty()) {
+			const PendingPresent& pending = m_PendingPresents.front();
+			if (pending.m_SwapChainGeneration != m_Renderer.GetSwapChainRecreationCount()) {
+				m_PendingPresents.erase(m_PendingPresents.begin());
+				continue;
+			}
+			VkResult result = m_Renderer.WaitForPresent(pending.m_PresentId, 0);
+			if (result == VK_TIMEOUT) { return; }
+			if (result == VK_SUCCESS) {
+				AddToAverage(m_Statistics.m_AverageInputToDisplayMilliseconds, ++m_Statistics.m_DisplayedFrames, Milliseconds(Clock::now() - pending.m_InputTime));
+			}
+			m_PendingPresents.erase(m_PendingPresents.begin());
+		}
+	}
+
+}
\ No newline at end of file
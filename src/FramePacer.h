@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+#include "Renderer.h"
+
+namespace Florencia {
+
+	//Input to present is measured up to the return of vkQueuePresentKHR, input to display needs VK_KHR_present_wait
+	//and is only seen once per frame loop iteration, so it can be late by up to one iteration
+	struct FrameLatencyStatistics {
+		uint32_t m_PresentedFrames = 0;
+		double m_AverageInputToPresentMilliseconds = 0.0;
+		double m_MaxInputToPresentMilliseconds = 0.0;
+		uint32_t m_DisplayedFrames = 0;
+		double m_AverageInputToDisplayMilliseconds = 0.0;
+	};
+
+	//Measures how long after its input was read each frame is presented and predicts how late the next frame can start
+	class FramePacer {
+	public:
+		static constexpr double SafetyMarginMilliseconds = 1.0;
+
+		FramePacer(Renderer& renderer) : m_Renderer{ renderer } {}
+
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		//Sleeps until the latest start that still presents SafetyMarginMilliseconds before the next present is due, never
+		//longer than one present interval, the prediction averages recent present intervals and the time from waking to presenting
+		void SleepUntilDeadline();
+		//Call right after reading the input the frame is built from
+		void InputSampled();
+		//Call after Renderer::EndFrame of the frame whose input was sampled last
+		void FramePresented();
+
+		FrameLatencyStatistics GetStatistics() const { return m_Statistics; }
+
+	private:
+		using Clock = std::chrono::high_resolution_clock;
+
+		struct PendingPresent {
+			uint64_t m_PresentId;
+			uint32_t m_SwapChainGeneration;
+			Clock::time_point m_InputTime;
+		};
+
+		void PollDisplayedFrames();
+
+		Renderer& m_Renderer;
+		Clock::time_point m_InputTime{};
+		Clock::time_point m_WakeTime{};
+		Clock::time_point m_LastPresentTime{};
+		bool m_Presented = false;
+		double m_PresentIntervalMilliseconds = 0.0;
+		double m_WorkMilliseconds = 0.0;
+		//Only frames in flight worth of presents are ever pending, unlike a deque the vector stops allocating once it has grown
+		std::vector<PendingPresent> m_PendingPresents;
+		FrameLatencyStatistics m_Statistics{};
+	};
+
+}
\ No newline at end of file
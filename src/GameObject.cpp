@@ -32,12 +32,16 @@ namespace Florencia {
 		};
 	}
 
-	GameObject GameObject::CreatePointLight(float intensity, float radius, glm::vec3 color) {
-		GameObject pointLight = GameObject::CreateGameObject();
-		pointLight.m_Color = {color.r, color.g, color.b, 0.0};
-		pointLight.m_Transform.scale.x = radius;
-		pointLight.m_PointLight = std::make_unique<PointLightComponent>();
-		pointLight.m_PointLight->m_LightIntensity = intensity;
+	GameObject GameObject::CreateGameObject(Registry& registry) {
+		GameObject gameObject{ registry, registry.Create() };
+		gameObject.AddComponent<TransformComponent>();
+		return gameObject;
+	}
+
+	GameObject GameObject::CreatePointLight(Registry& registry, float intensity, float radius, glm::vec3 color) {
+		GameObject pointLight = GameObject::CreateGameObject(registry);
+		pointLight.Transform().scale.x = radius;
+		pointLight.AddComponent<PointLightComponent>(intensity, color);
 		return pointLight;
 	}
 
@@ -1,7 +1,7 @@
 #pragma once
 #include <memory>
-#include <unordered_map>
 #include <glm/gtc/matrix_transform.hpp>
+#include "Registry.h"
 #include "Model.h"
 
 namespace Florencia {
@@ -10,6 +10,8 @@ namespace Florencia {
 		glm::vec3 translation{ 0.0f };
 		glm::vec3 scale{ 1.0f };
 		glm::vec3 rotation{ 0.0f };
+		//Set by GameObject::Transform, SpatialIndex::Update refits the bounds of moved entities and clears it
+		bool m_Moved = true;
 
 		//Matrix multiplication of "Translation * RotationX * RotationZ * RotationY * Scale"
 		//Rotations are Tait-bryan angles of "Y(1), X(2), Z(3)"
@@ -17,39 +19,59 @@ namespace Florencia {
 		glm::mat3 NormalMatrix();
 	};
 
+	struct ModelComponent {
+		std::shared_ptr<Model> m_Model{};
+	};
+
+	//Selects the World shader variant, features a material turns off are compiled out through specialization constants
+	struct MaterialComponent {
+		bool m_Lit = true;
+		bool m_Specular = true;
+		float m_Shininess = 32.0f;
+	};
+
 	struct PointLightComponent {
+		//Intensity falls off with 1/d^2, past the range it contributes less than LightCutoff
+		static constexpr float LightCutoff = 0.01f;
+
 		float m_LightIntensity = 1.0f;
+		glm::vec3 m_Color{ 1.0f };
+
+		float Range() const { return glm::sqrt(m_LightIntensity / LightCutoff); }
 	};
 
+	//Thin handle over an entity in a Registry, components are stored densely per type by the registry
 	class GameObject {
 	public:
-		using ID_t = unsigned int;
-		using Map_t = std::unordered_map<ID_t, GameObject>;
+		using ID_t = Entity;
 
-		GameObject(const GameObject&) = delete;
-		GameObject& operator=(const GameObject&) = delete;
-		GameObject(GameObject&&) = default;
-		GameObject& operator=(GameObject&&) = default;
+		GameObject(Registry& registry, Entity entity) : m_Registry{ &registry }, m_Entity{ entity } {}
 
-		static GameObject CreateGameObject() {
-			static ID_t currentID = 0;
-			return GameObject{ currentID++ };
-		}
+		static GameObject CreateGameObject(Registry& registry);
+		static GameObject CreatePointLight(Registry& registry, float intensity = 10.0f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.0f));
 
-		static GameObject CreatePointLight(float intensity = 10.0f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.0f));
+		const ID_t GetID() const { return m_Entity; }
+		void Destroy() { m_Registry->Destroy(m_Entity); }
 
-		const ID_t GetID() { return m_ID; }
+		//Flags the transform as moved, write transforms through here rather than the registry so the SpatialIndex sees the change
+		TransformComponent& Transform() {
+			auto& transform = m_Registry->Get<TransformComponent>(m_Entity);
+			transform.m_Moved = true;
+			return transform;
+		}
 
-		glm::vec4 m_Color{};
-		TransformComponent m_Transform;
+		template<typename T, typename... Args>
+		T& AddComponent(Args&&... args) { return m_Registry->Emplace<T>(m_Entity, std::forward<Args>(args)...); }
 
-		//optional components
-		std::shared_ptr<Model> m_Model{};
-		std::unique_ptr<PointLightComponent> m_PointLight = nullptr;
+		template<typename T>
+		T& GetComponent() { return m_Registry->Get<T>(m_Entity); }
+
+		template<typename T>
+		bool HasComponent() const { return m_Registry->Has<T>(m_Entity); }
 
 	private:
-		GameObject(ID_t objId) : m_ID{ objId } {}
-		ID_t m_ID;
+		Registry* m_Registry;
+		Entity m_Entity;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "GpuProfiler.h"
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+
+namespace Florencia {
+
+	namespace {
+
+		//Results are written in bit order, so the members of GpuPipelineStatistics follow it
+		constexpr VkQueryPipelineStatisticFlags StatisticFlags =
+			VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+		std::string Quote(const char* text) {
+			std::string quoted = "\"";
+			for (const char* c = text; *c != '\0'; c++) {
+				if (*c == '"' || *c == '\\') { quoted += '\\'; }
+				quoted += *c;
+			}
+			return quoted + "\"";
+		}
+
+	}
+
+	GpuProfiler::GpuProfiler(Device& device, uint32_t frameCount) : m_Device{ device }, m_Frames(frameCount) {
+		//Guarantees every graphics queue supports timestamps, so the queue family doesn't have to be checked
+		if (!m_Device.properties.limits.timestampComputeAndGraphics) { return; }
+		m_NanosecondsPerTick = m_Device.properties.limits.timestampPeriod;
+
+		for (FrameQueries& frame : m_Frames) {
+			VkQueryPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			poolInfo.queryCount = MaxScopes * 2;
+			if (vkCreateQueryPool(m_Device.Get(), &poolInfo, m_Device.GetAllocator(), &frame.m_Timestamps) != VK_SUCCESS) throw std::runtime_error("Failed to Create Timestamp Query Pool");
+			frame.m_Scopes.reserve(MaxScopes);
+
+			if (!SupportsStatistics()) { continue; }
+			poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+			poolInfo.queryCount = MaxScopes;
+			poolInfo.pipelineStatistics = StatisticFlags;
+			if (vkCreateQueryPool(m_Device.Get(), &poolInfo, m_Device.GetAllocator(), &frame.m_Statistics) != VK_SUCCESS) throw std::runtime_error("Failed to Create Pipeline Statistics Query Pool");
+		}
+		m_TimestampResults.resize(MaxScopes * 2);
+		m_Resolved.reserve(MaxScopes);
+		m_Supported = true;
+	}
+
+	GpuProfiler::~GpuProfiler() {
+		for (FrameQueries& frame : m_Frames) {
+			vkDestroyQueryPool(m_Device.Get(), frame.m_Timestamps, m_Device.GetAllocator());
+			vkDestroyQueryPool(m_Device.Get(), frame.m_Statistics, m_Device.GetAllocator());
+		}
+	}
+
+	bool GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, int frameIndex) {
+		if (!m_Supported) { return false; }
+		FrameQueries& frame = m_Frames[frameIndex];
+		bool resolved = Resolve(frame);
+
+		frame.m_Scopes.clear();
+		vkCmdResetQueryPool(commandBuffer, frame.m_Timestamps, 0, MaxScopes * 2);
+		if (frame.m_Statistics != VK_NULL_HANDLE) { vkCmdResetQueryPool(commandBuffer, frame.m_Statistics, 0, MaxScopes); }
+		m_CurrentFrame = frameIndex;
+		m_Depth = 0;
+		m_ActiveStatisticsScope = UINT32_MAX;
+		BeginScope(commandBuffer, "Frame");
+		return resolved;
+	}
+
+	void GpuProfiler::EndFrame(VkCommandBuffer commandBuffer) {
+		if (m_CurrentFrame < 0) { return; }
+		EndScope(commandBuffer, 0);
+		m_CurrentFrame = -1;
+	}
+
+	uint32_t GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name, bool statistics) {
+		if (m_CurrentFrame < 0) { return UINT32_MAX; }
+		FrameQueries& frame = m_Frames[m_CurrentFrame];
+		if (frame.m_Scopes.size() == MaxScopes) { return UINT32_MAX; }
+
+		uint32_t scope = static_cast<uint32_t>(frame.m_Scopes.size());
+		statistics = statistics && frame.m_Statistics != VK_NULL_HANDLE && m_ActiveStatisticsScope == UINT32_MAX;
+		frame.m_Scopes.push_back({ name, m_Depth++, statistics });
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.m_Timestamps, scope * 2);
+		if (statistics) {
+			vkCmdBeginQuery(commandBuffer, frame.m_Statistics, scope, 0);
+			m_ActiveStatisticsScope = scope;
+		}
+		return scope;
+	}
+
+	void GpuProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+		if (m_CurrentFrame < 0 || scope == UINT32_MAX) { return; }
+		FrameQueries& frame = m_Frames[m_CurrentFrame];
+		if (m_ActiveStatisticsScope == scope) {
+			vkCmdEndQuery(commandBuffer, frame.m_Statistics, scope);
+			m_ActiveStatisticsScope = UINT32_MAX;
+		}
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.m_Timestamps, scope * 2 + 1);
+		m_Depth--;
+	}
+
+	//Called once the slot's last submission has completed, without VK_QUERY_RESULT_WAIT_BIT a frame that somehow isn't
+	//available yet is dropped instead of stalling
+	bool GpuProfiler::Resolve(FrameQueries& frame) {
+		m_Resolved.clear();
+		uint32_t scopeCount = static_cast<uint32_t>(frame.m_Scopes.size());
+		if (scopeCount == 0) { return false; }
+		if (vkGetQueryPoolResults(m_Device.Get(), frame.m_Timestamps, 0, scopeCount * 2, scopeCount * 2 * sizeof(uint64_t), m_TimestampResults.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) { return false; }
+
+		uint64_t origin = m_TimestampResults[0];
+		if (m_TraceEnabled && !m_TraceStarted) {
+			m_TraceOrigin = origin;
+			m_TraceStarted = true;
+		}
+		for (uint32_t i = 0; i < scopeCount; i++) {
+			const ScopeRecord& record = frame.m_Scopes[i];
+			uint64_t begin = m_TimestampResults[i * 2], end = m_TimestampResults[i * 2 + 1];
+			GpuScopeResult result{};
+			result.m_Name = record.m_Name;
+			result.m_Depth = record.m_Depth;
+			result.m_StartMilliseconds = static_cast<double>(begin - origin) * m_NanosecondsPerTick / 1000000.0;
+			result.m_Milliseconds = static_cast<double>(end - begin) * m_NanosecondsPerTick / 1000000.0;
+			if (record.m_Statistics) {
+				uint64_t values[4];
+				result.m_HasStatistics = vkGetQueryPoolResults(m_Device.Get(), frame.m_Statistics, i, 1, sizeof(values), values, sizeof(values), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS;
+				if (result.m_HasStatistics) { result.m_Statistics = { values[0], values[1], values[2], values[3] }; }
+			}
+			m_Resolved.push_back(result);
+			Accumulate(result);
+			if (m_TraceEnabled) { m_TraceEvents.push_back({ record.m_Name, static_cast<double>(begin - m_TraceOrigin) * m_NanosecondsPerTick / 1000.0, result.m_Milliseconds * 1000.0 }); }
+		}
+		return true;
+	}
+
+	void GpuProfiler::Accumulate(const GpuScopeResult& result) {
+		size_t index = 0;
+		while (index < m_Averages.size() && m_Averages[index].m_Name != result.m_Name) { index++; }
+		if (index == m_Averages.size()) {
+			m_Averages.push_back({ result.m_Name });
+			m_Histories.push_back({});
+		}
+
+		GpuScopeAverage& average = m_Averages[index];
+		AverageHistory& history = m_Histories[index];
+		history.m_Milliseconds[history.m_Next] = result.m_Milliseconds;
+		history.m_FragmentShaderInvocations[history.m_Next] = static_cast<double>(result.m_Statistics.m_FragmentShaderInvocations);
+		history.m_Next = (history.m_Next + 1) % AverageWindow;
+		average.m_SampleCount = std::min(average.m_SampleCount + 1, AverageWindow);
+
+		double milliseconds = 0.0, invocations = 0.0;
+		for (uint32_t i = 0; i < average.m_SampleCount; i++) {
+			milliseconds += history.m_Milliseconds[i];
+			invocations += history.m_FragmentShaderInvocations[i];
+		}
+		average.m_AverageMilliseconds = milliseconds / average.m_SampleCount;
+		average.m_AverageFragmentShaderInvocations = invocations / average.m_SampleCount;
+	}
+
+	bool GpuProfiler::GetResolvedStatistics(const char* name, GpuPipelineStatistics& statistics) const {
+		bool found = false;
+		statistics = {};
+		for (const GpuScopeResult& result : m_Resolved) {
+			if (!result.m_HasStatistics || std::strcmp(name, result.m_Name) != 0) { continue; }
+			statistics.m_InputAssemblyVertices += result.m_Statistics.m_InputAssemblyVertices;
+			statistics.m_VertexShaderInvocations += result.m_Statistics.m_VertexShaderInvocations;
+			statistics.m_ClippingPrimitives += result.m_Statistics.m_ClippingPrimitives;
+			statistics.m_FragmentShaderInvocations += result.m_Statistics.m_FragmentShaderInvocations;
+			found = true;
+		}
+		return found;
+	}
+
+	//Complete events on one track, the viewer nests them by their time ranges
+	void GpuProfiler::WriteTrace(const std::string& path) const {
+		std::ofstream file(path);
+		if (!file) throw std::runtime_error("Failed to Write Gpu Trace " + path);
+		file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+		file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": " << Quote(m_Device.properties.deviceName) << "}}";
+		for (const TraceEvent& event : m_TraceEvents) {
+			file << ",\n{\"name\": " << Quote(event.m_Name) << ", \"cat\": \"gpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": " << event.m_StartMicroseconds
+				<< ", \"dur\": " << event.m_DurationMicroseconds << "}";
+		}
+		file << "\n]}\n";
+	}
+
+}
\ No newline at end of file
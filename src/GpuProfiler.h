@@ -0,0 +1,135 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Device.h"
+
+namespace Florencia {
+
+	struct GpuPipelineStatistics {
+		uint64_t m_InputAssemblyVertices = 0;
+		uint64_t m_VertexShaderInvocations = 0;
+		uint64_t m_ClippingPrimitives = 0;
+		uint64_t m_FragmentShaderInvocations = 0;
+	};
+
+	//One scope of a resolved frame, times are relative to the start of that frame
+	struct GpuScopeResult {
+		const char* m_Name = nullptr;
+		uint32_t m_Depth = 0;
+		double m_StartMilliseconds = 0.0;
+		double m_Milliseconds = 0.0;
+		bool m_HasStatistics = false;
+		GpuPipelineStatistics m_Statistics{};
+	};
+
+	//Mean over the last AverageWindow frames a scope was recorded in
+	struct GpuScopeAverage {
+		std::string m_Name;
+		double m_AverageMilliseconds = 0.0;
+		double m_AverageFragmentShaderInvocations = 0.0;
+		uint32_t m_SampleCount = 0;
+	};
+
+	//Timestamp and pipeline statistics query pools per frame in flight, a frame's queries are read when its slot comes around
+	//again, after the renderer has waited for that slot, so resolving never blocks on the gpu
+	//Scope names must outlive the profiler, string literals in practice
+	class GpuProfiler {
+	public:
+		static constexpr uint32_t MaxScopes = 64;
+		static constexpr uint32_t AverageWindow = 64;
+
+		GpuProfiler(Device& device, uint32_t frameCount);
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		bool IsSupported() const { return m_Supported; }
+		bool SupportsStatistics() const { return m_Device.SupportsPipelineStatistics(); }
+
+		//Resolves the last frame recorded with this frame index and opens the "Frame" scope around everything recorded after it,
+		//must be recorded outside of a render pass, true when a frame was resolved
+		bool BeginFrame(VkCommandBuffer commandBuffer, int frameIndex);
+		void EndFrame(VkCommandBuffer commandBuffer);
+
+		//Statistics queries can't nest or span subpasses, they are skipped for a scope opened while another one gathers them
+		uint32_t BeginScope(VkCommandBuffer commandBuffer, const char* name, bool statistics = false);
+		void EndScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+		//Scopes of the frame resolved by the last BeginFrame in the order they were opened, the first is the whole frame
+		const std::vector<GpuScopeResult>& GetResolvedFrame() const { return m_Resolved; }
+		double GetResolvedFrameMilliseconds() const { return m_Resolved.empty() ? 0.0 : m_Resolved.front().m_Milliseconds; }
+		//Sums every scope of the resolved frame with this name that gathered statistics, false if there is none
+		bool GetResolvedStatistics(const char* name, GpuPipelineStatistics& statistics) const;
+		const std::vector<GpuScopeAverage>& GetAverages() const { return m_Averages; }
+
+		//Keeps every resolved scope from now on so WriteTrace can write them as a Chrome trace (chrome://tracing or Perfetto)
+		void EnableTrace() { m_TraceEnabled = true; }
+		void WriteTrace(const std::string& path) const;
+
+	private:
+		struct ScopeRecord {
+			const char* m_Name;
+			uint32_t m_Depth;
+			bool m_Statistics;
+		};
+
+		struct FrameQueries {
+			VkQueryPool m_Timestamps = VK_NULL_HANDLE;
+			VkQueryPool m_Statistics = VK_NULL_HANDLE;
+			std::vector<ScopeRecord> m_Scopes;
+		};
+
+		struct AverageHistory {
+			double m_Milliseconds[AverageWindow];
+			double m_FragmentShaderInvocations[AverageWindow];
+			uint32_t m_Next = 0;
+		};
+
+		struct TraceEvent {
+			const char* m_Name;
+			double m_StartMicroseconds;
+			double m_DurationMicroseconds;
+		};
+
+		bool Resolve(FrameQueries& frame);
+		void Accumulate(const GpuScopeResult& result);
+
+		Device& m_Device;
+		bool m_Supported = false;
+		double m_NanosecondsPerTick = 1.0;
+		std::vector<FrameQueries> m_Frames;
+		int m_CurrentFrame = -1;
+		uint32_t m_Depth = 0;
+		uint32_t m_ActiveStatisticsScope = UINT32_MAX;
+
+		std::vector<GpuScopeResult> m_Resolved;
+		std::vector<uint64_t> m_TimestampResults;
+		std::vector<GpuScopeAverage> m_Averages;
+		std::vector<AverageHistory> m_Histories;
+
+		bool m_TraceEnabled = false;
+		bool m_TraceStarted = false;
+		uint64_t m_TraceOrigin = 0;
+		std::vector<TraceEvent> m_TraceEvents;
+	};
+
+	//Records a scope for as long as it lives
+	class GpuScope {
+	public:
+		GpuScope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name, bool statistics = false)
+			: m_Profiler{ profiler }, m_CommandBuffer{ commandBuffer }, m_Scope{ profiler.BeginScope(commandBuffer, name, statistics) } {}
+		~GpuScope() { m_Profiler.EndScope(m_CommandBuffer, m_Scope); }
+
+		GpuScope(const GpuScope&) = delete;
+		GpuScope& operator=(const GpuScope&) = delete;
+
+	private:
+		GpuProfiler& m_Profiler;
+		VkCommandBuffer m_CommandBuffer;
+		uint32_t m_Scope;
+	};
+
+}
\ No newline at end of file
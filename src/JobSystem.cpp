@@ -0,0 +1,116 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include "CpuProfiler.h"
+
+namespace Florencia {
+
+	JobSystem::JobSystem(uint32_t workerCount) {
+		if (workerCount == 0) {
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+		m_Workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++) {
+			m_Workers.emplace_back([this, i]() {
+				FLORENCIA_PROFILE_THREAD("Worker " + std::to_string(i));
+				WorkerLoop();
+			});
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+		}
+		m_Condition.notify_all();
+		for (auto& worker : m_Workers) { worker.join(); }
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& func) {
+		if (count == 0) { return; }
+		grainSize = std::max(grainSize, 1u);
+		uint32_t chunkCount = (count + grainSize - 1) / grainSize;
+		if (chunkCount == 1) {
+			func(0, count);
+			return;
+		}
+
+		//Chunks capture a pointer to this and their range, small enough for std::function to store without allocating
+		struct ParallelForState {
+			const std::function<void(uint32_t, uint32_t)>& m_Func;
+			std::atomic<uint32_t> m_Remaining;
+			std::mutex m_DoneMutex;
+			std::condition_variable m_Done;
+		};
+		ParallelForState state{ func, chunkCount };
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+			uint32_t begin = chunk * grainSize;
+			uint32_t end = std::min(begin + grainSize, count);
+			ParallelForState* shared = &state;
+			Enqueue([shared, begin, end]() {
+				shared->m_Func(begin, end);
+				//Decremented under the lock so the waiter can't return and destroy the mutex while it is still held
+				std::lock_guard<std::mutex> lock(shared->m_DoneMutex);
+				if (shared->m_Remaining.fetch_sub(1) == 1) { shared->m_Done.notify_one(); }
+			});
+		}
+
+		//Help drain the queue instead of blocking, the chunks of this call may be the only work left
+		while (state.m_Remaining.load() > 0 && TryRunOne()) {}
+		std::unique_lock<std::mutex> lock(state.m_DoneMutex);
+		state.m_Done.wait(lock, [&]() { return state.m_Remaining.load() == 0; });
+	}
+
+	void JobSystem::Enqueue(std::function<void()> job) {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push_back(std::move(job));
+		}
+		m_Condition.notify_one();
+	}
+
+	std::function<void()> JobSystem::PopJob() {
+		std::function<void()> job = std::move(m_Jobs[m_NextJob++]);
+		if (!HasJobs()) {
+			m_Jobs.clear();
+			m_NextJob = 0;
+		}
+		//Producers can keep the queue from ever running empty, dropping the run jobs once they are the larger half keeps it bounded
+		//and moves fewer jobs than were popped since the last compaction
+		else if (m_NextJob >= MinJobsBeforeCompact && m_NextJob * 2 >= m_Jobs.size()) {
+			m_Jobs.erase(m_Jobs.begin(), m_Jobs.begin() + m_NextJob);
+			m_NextJob = 0;
+		}
+		return job;
+	}
+
+	bool JobSystem::TryRunOne() {
+		std::function<void()> job;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!HasJobs()) { return false; }
+			job = PopJob();
+		}
+		job();
+		return true;
+	}
+
+	void JobSystem::WorkerLoop() {
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_Stopping || HasJobs(); });
+				if (m_Stopping && !HasJobs()) { return; }
+				job = PopJob();
+			}
+			FLORENCIA_PROFILE_SCOPE("JobSystem::Job");
+			job();
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+namespace Florencia {
+
+	//Fixed pool of worker threads, jobs are taken in submission order
+	class JobSystem {
+	public:
+		//0 uses one worker per hardware thread minus the calling thread
+		JobSystem(uint32_t workerCount = 0);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		template<typename Func>
+		auto Submit(Func&& func) -> std::future<decltype(func())> {
+			using Result = decltype(func());
+			auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+			std::future<Result> future = task->get_future();
+			Enqueue([task]() { (*task)(); });
+			return future;
+		}
+
+		//Calls func(begin, end) over [0, count) in chunks of at most grainSize, the calling thread helps until every chunk is done
+		void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& func);
+
+		uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+	private:
+		void Enqueue(std::function<void()> job);
+		//Call with m_Mutex held and a job queued
+		std::function<void()> PopJob();
+		bool HasJobs() const { return m_NextJob < m_Jobs.size(); }
+		bool TryRunOne();
+		void WorkerLoop();
+
+		//Keeps a short queue from being compacted every few pops
+		static constexpr size_t MinJobsBeforeCompact = 64;
+
+		std::vector<std::thread> m_Workers;
+		//Queued from m_NextJob on, cleared whenever it runs empty and compacted when the run jobs outnumber the queued ones,
+		//so its capacity is reused where a deque would keep allocating and freeing blocks as jobs pass through
+		std::vector<std::function<void()>> m_Jobs;
+		size_t m_NextJob = 0;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping = false;
+	};
+
+}
\ No newline at end of file
@@ -3,26 +3,66 @@
 #include <cassert>
 
 #include "../vendor/TinyObjLoader/TinyObjLoader.h"
-#include "Utilities.h"
 
 #ifndef EngineDir
 	#define ENGINE_DIRECTORY "../"
 #endif
 
-namespace std {
+namespace Florencia {
 
-	template <>
-	struct hash<Florencia::Model::Vertex> {
-		size_t operator()(const Florencia::Model::Vertex& vertex) const {
-			size_t seed = 0;
-			Florencia::HashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-			return seed;
+	namespace {
+
+		//Flattens the obj's per attribute indices into one vertex per unique combination
+		void BuildVertices(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, std::vector<Model::Vertex>& vertices, std::vector<uint32_t>& indices) {
+			using Vertex = Model::Vertex;
+			vertices.clear();
+			indices.clear();
+			std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+			for (const auto& shape : shapes) {
+				for (const auto& index : shape.mesh.indices) {
+					Vertex vertex{};
+					if (index.vertex_index >= 0) {
+						vertex.position = {
+							attrib.vertices[3 * index.vertex_index + 0],
+							attrib.vertices[3 * index.vertex_index + 1],
+							attrib.vertices[3 * index.vertex_index + 2],
+							1.0f
+						};
+
+						vertex.color = {
+							attrib.colors[3 * index.vertex_index + 0],
+							attrib.colors[3 * index.vertex_index + 1],
+							attrib.colors[3 * index.vertex_index + 2],
+							1.0f
+						};
+					}
+
+					if (index.normal_index >= 0) {
+						vertex.normal = {
+							attrib.normals[3 * index.normal_index + 0],
+							attrib.normals[3 * index.normal_index + 1],
+							attrib.normals[3 * index.normal_index + 2],
+							0.0f
+						};
+					}
+
+					if (index.texcoord_index >= 0) {
+						vertex.uv = {
+							attrib.texcoords[2 * index.texcoord_index + 0],
+							attrib.texcoords[2 * index.texcoord_index + 1]
+						};
+					}
+
+					if (uniqueVertices.count(vertex) == 0) {
+						uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+						vertices.push_back(std::move(vertex));
+					}
+					indices.push_back(uniqueVertices[vertex]);
+				}
+			}
 		}
-	};
 
-}
-
-namespace Florencia {
+	}
 
 	void Model::Data::LoadModel(const std::string& filepath) {
 		tinyobj::attrib_t attrib;
@@ -32,55 +72,21 @@ namespace Florencia {
 
 		std::string enginePath = ENGINE_DIRECTORY + filepath;
 		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &error, enginePath.data())) { throw std::runtime_error(warn + error); }
+		BuildVertices(attrib, shapes, vertices, indices);
+	}
 
-		vertices.clear();
-		indices.clear();
-		std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-		for (const auto& shape : shapes) {
-			for (const auto& index : shape.mesh.indices) {
-				Vertex vertex{};
-				if (index.vertex_index >= 0) {
-					vertex.position = {
-						attrib.vertices[3 * index.vertex_index + 0],
-						attrib.vertices[3 * index.vertex_index + 1],
-						attrib.vertices[3 * index.vertex_index + 2],
-						1.0f
-					};
-
-					vertex.color = {
-						attrib.colors[3 * index.vertex_index + 0],
-						attrib.colors[3 * index.vertex_index + 1],
-						attrib.colors[3 * index.vertex_index + 2],
-						1.0f
-					};
-				}
-
-				if (index.normal_index >= 0) {
-					vertex.normal = {
-						attrib.normals[3 * index.normal_index + 0],
-						attrib.normals[3 * index.normal_index + 1],
-						attrib.normals[3 * index.normal_index + 2],
-						0.0f
-					};
-				}
-
-				if (index.texcoord_index >= 0) {
-					vertex.uv = {
-						attrib.texcoords[2 * index.texcoord_index + 0],
-						attrib.texcoords[2 * index.texcoord_index + 1]
-					};
-				}
+	void Model::Data::LoadModel(std::istream& stream) {
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, error;
 
-				if (uniqueVertices.count(vertex) == 0) {
-					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-					vertices.push_back(std::move(vertex));
-				}
-				indices.push_back(uniqueVertices[vertex]);
-			}
-		}
+		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &error, &stream)) { throw std::runtime_error(warn + error); }
+		BuildVertices(attrib, shapes, vertices, indices);
 	}
 
 	Model::Model(Device& device, const Data& builder) : m_Device{ device } {
+		for (const auto& vertex : builder.vertices) { m_Bounds.Expand(glm::vec3(vertex.position)); }
 		AllocateVertexBuffers(builder.vertices);
 		AllocateIndexBuffers(builder.indices);
 	}
@@ -90,7 +96,15 @@ namespace Florencia {
 	std::shared_ptr<Model> Model::CreateModelFromFile(Device& device, const std::string& filepath) {
 		Data data{};
 		data.LoadModel(filepath);
-		return std::make_shared<Model>(device, data);
+		auto model = std::make_shared<Model>(device, data);
+		model->SetName(filepath);
+		return model;
+	}
+
+	void Model::SetName(const std::string& name) {
+		if (!m_Device.SupportsDebugUtils()) { return; }
+		m_VertexBuffer->SetName((name + " Vertices").c_str());
+		if (m_HasIndexBuffer) { m_IndexBuffer->SetName((name + " Indices").c_str()); }
 	}
 
 	void Model::Bind(VkCommandBuffer commandBuffer) {
@@ -6,11 +6,14 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <istream>
 
 #include <glm/gtx/hash.hpp>
 #include <glm/glm.hpp>
 #include "Device.h"
 #include "Buffer.h"
+#include "Bounds.h"
+#include "Utilities.h"
 
 namespace Florencia {
 
@@ -35,6 +38,8 @@ namespace Florencia {
 			std::vector<uint32_t> indices{};
 
 			void LoadModel(const std::string& filepath);
+			//Same as loading a file without its materials, lets obj text be parsed from memory
+			void LoadModel(std::istream& stream);
 		};
 
 		Model(Device& device, const Data& builder);
@@ -46,15 +51,34 @@ namespace Florencia {
 		void Bind(VkCommandBuffer commandBuffer);
 		void Draw(VkCommandBuffer commandBuffer);
 
+		const AABB& GetBounds() const { return m_Bounds; }
+
 		static std::shared_ptr<Model> CreateModelFromFile(Device& device, const std::string& filepath);
+		//Names the vertex and index buffers after name
+		void SetName(const std::string& name);
 	private:
 		void AllocateVertexBuffers(const std::vector<Vertex>& vertices);
 		void AllocateIndexBuffers(const std::vector<uint32_t>& indices);
 
 		Device& m_Device;
+		AABB m_Bounds{};
 		bool m_HasIndexBuffer{ false };
 		uint32_t m_VertexCount, m_IndexCount;
 		std::unique_ptr<Buffer> m_VertexBuffer, m_IndexBuffer;
 	};
 
+}
+
+namespace std {
+
+	//Lets loaders deduplicate vertices with an unordered_map
+	template <>
+	struct hash<Florencia::Model::Vertex> {
+		size_t operator()(const Florencia::Model::Vertex& vertex) const {
+			size_t seed = 0;
+			Florencia::HashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+			return seed;
+		}
+	};
+
 }
\ No newline at end of file
@@ -6,31 +6,32 @@
 
 namespace Florencia {
 
-	void ObjectController::MoveInPlaneXZ(GLFWwindow* window, float timestep, GameObject& object) {
+	void ObjectController::MoveInPlaneXZ(const Window& window, float timestep, GameObject& object) {
+		TransformComponent& transform = object.Transform();
 		glm::vec3 rotate{ 0 };
-		if (glfwGetKey(window, (int)KeyMappings::LookRight) == GLFW_PRESS) { rotate.y += 1.0f; }
-		if (glfwGetKey(window, (int)KeyMappings::LookLeft) == GLFW_PRESS) { rotate.y -= 1.0f; }
+		if (window.IsKeyPressed((int)KeyMappings::LookRight)) { rotate.y += 1.0f; }
+		if (window.IsKeyPressed((int)KeyMappings::LookLeft)) { rotate.y -= 1.0f; }
 
-		if (glfwGetKey(window, (int)KeyMappings::LookUp) == GLFW_PRESS) { rotate.x += 1.0f; }
-		if (glfwGetKey(window, (int)KeyMappings::LookDown) == GLFW_PRESS) { rotate.x -= 1.0f; }
+		if (window.IsKeyPressed((int)KeyMappings::LookUp)) { rotate.x += 1.0f; }
+		if (window.IsKeyPressed((int)KeyMappings::LookDown)) { rotate.x -= 1.0f; }
 
-		if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon()) { object.m_Transform.rotation += m_LookSpeed * timestep * glm::normalize(rotate); }
-		object.m_Transform.rotation.x = glm::clamp(object.m_Transform.rotation.x, -1.5f, 1.5f);
-		object.m_Transform.rotation.y = glm::mod(object.m_Transform.rotation.y, 2 * glm::pi<float>());
+		if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon()) { transform.rotation += m_LookSpeed * timestep * glm::normalize(rotate); }
+		transform.rotation.x = glm::clamp(transform.rotation.x, -1.5f, 1.5f);
+		transform.rotation.y = glm::mod(transform.rotation.y, 2 * glm::pi<float>());
 
-		const glm::vec3 forward{ sin(object.m_Transform.rotation.y), 0.0f, cos(object.m_Transform.rotation.y) },
+		const glm::vec3 forward{ sin(transform.rotation.y), 0.0f, cos(transform.rotation.y) },
 			right{ forward.z, 0.0f, -forward.x },
 			up{ 0.0f, -1.0f, 0.0f };
 
 		glm::vec3 moveDir{ 0.0f };
-		if (glfwGetKey(window, (int)KeyMappings::MoveForeward) == GLFW_PRESS) { moveDir += forward; }
-		if (glfwGetKey(window, (int)KeyMappings::MoveBackward) == GLFW_PRESS) { moveDir -= forward; }
-		if (glfwGetKey(window, (int)KeyMappings::MoveRight) == GLFW_PRESS) { moveDir += right; }
-		if (glfwGetKey(window, (int)KeyMappings::MoveLeft) == GLFW_PRESS) { moveDir -= right; }
-		if (glfwGetKey(window, (int)KeyMappings::MoveUp) == GLFW_PRESS) { moveDir += up; }
-		if (glfwGetKey(window, (int)KeyMappings::MoveDown) == GLFW_PRESS) { moveDir -= up; }
-
-		if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) { object.m_Transform.translation += m_MoveSpeed * timestep * glm::normalize(moveDir); }
+		if (window.IsKeyPressed((int)KeyMappings::MoveForeward)) { moveDir += forward; }
+		if (window.IsKeyPressed((int)KeyMappings::MoveBackward)) { moveDir -= forward; }
+		if (window.IsKeyPressed((int)KeyMappings::MoveRight)) { moveDir += right; }
+		if (window.IsKeyPressed((int)KeyMappings::MoveLeft)) { moveDir -= right; }
+		if (window.IsKeyPressed((int)KeyMappings::MoveUp)) { moveDir += up; }
+		if (window.IsKeyPressed((int)KeyMappings::MoveDown)) { moveDir -= up; }
+
+		if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) { transform.translation += m_MoveSpeed * timestep * glm::normalize(moveDir); }
 	}
 
 }
\ No newline at end of file
@@ -20,7 +20,7 @@ namespace Florencia {
 			LookDown = GLFW_KEY_DOWN
 		};
 
-		void MoveInPlaneXZ(GLFWwindow* window, float timestep, GameObject& object);
+		void MoveInPlaneXZ(const Window& window, float timestep, GameObject& object);
 
 	private:
 		float m_MoveSpeed{ 3.0f }, m_LookSpeed{ 1.5f };
@@ -0,0 +1,205 @@
+#include "OcclusionCulling.h"
+#include <stdexcept>
+
+#include "CpuProfiler.h"
+#include "Pipeline.h"
+
+namespace Florencia {
+
+	namespace {
+
+		//Matches the push constant block in DepthReduce.comp
+		struct DepthReducePush {
+			glm::uvec2 m_SourceSize;
+			glm::uvec2 m_ReducedSize;
+			uint32_t m_Scale;
+		};
+
+		constexpr uint32_t DepthReduceGroupSize = 8;
+
+	}
+
+	OccluderComponent OccluderComponent::FromModelData(const Model::Data& data) {
+		OccluderComponent occluder{};
+		occluder.m_Vertices.reserve(data.vertices.size());
+		for (const auto& vertex : data.vertices) { occluder.m_Vertices.push_back(glm::vec3(vertex.position)); }
+		occluder.m_Indices = data.indices;
+		if (occluder.m_Indices.empty()) {
+			occluder.m_Indices.resize(occluder.m_Vertices.size());
+			for (uint32_t i = 0; i < occluder.m_Indices.size(); i++) { occluder.m_Indices[i] = i; }
+		}
+		return occluder;
+	}
+
+	HiZOcclusionCuller::HiZOcclusionCuller(Device& device, Renderer& renderer) : m_Device{ device }, m_Renderer{ renderer } {
+		uint32_t framesInFlight = renderer.GetFramesInFlight();
+		m_Readbacks.resize(framesInFlight);
+		m_SetLayout = DescriptorSetLayout::Builder(m_Device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.Build();
+		m_Pool = DescriptorPool::Builder(m_Device)
+			.SetMaxSets(framesInFlight)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight)
+			.Build();
+
+		//Only read with texelFetch, filtering and addressing never apply
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		if (vkCreateSampler(m_Device.Get(), &samplerInfo, m_Device.GetAllocator(), &m_Sampler) != VK_SUCCESS) { throw std::runtime_error("Failed to Create Depth Reduce Sampler"); }
+		m_Device.SetObjectName(VK_OBJECT_TYPE_SAMPLER, m_Sampler, "Depth Reduce Sampler");
+
+		CreatePipeline();
+	}
+
+	HiZOcclusionCuller::~HiZOcclusionCuller() {
+		vkDestroyPipeline(m_Device.Get(), m_Pipeline, m_Device.GetAllocator());
+		vkDestroyPipelineLayout(m_Device.Get(), m_PipelineLayout, m_Device.GetAllocator());
+		vkDestroySampler(m_Device.Get(), m_Sampler, m_Device.GetAllocator());
+	}
+
+	void HiZOcclusionCuller::CreatePipeline() {
+		VkDescriptorSetLayout setLayout = m_SetLayout->GetDescriptorSetLayout();
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(DepthReducePush);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if (vkCreatePipelineLayout(m_Device.Get(), &pipelineLayoutInfo, m_Device.GetAllocator(), &m_PipelineLayout) != VK_SUCCESS) { throw std::runtime_error("Failed to Create Pipeline Layout"); }
+
+		VkShaderModule shaderModule;
+		Pipeline::CreateShaderModule(m_Device, &shaderModule, Pipeline::ReadFile("assets/shaders/DepthReduce.comp.spv"));
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = shaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = m_PipelineLayout;
+		VkResult result = vkCreateComputePipelines(m_Device.Get(), m_Device.GetPipelineCache(), 1, &pipelineInfo, m_Device.GetAllocator(), &m_Pipeline);
+		vkDestroyShaderModule(m_Device.Get(), shaderModule, m_Device.GetAllocator());
+		if (result != VK_SUCCESS) { throw std::runtime_error("Failed to Create Depth Reduce Pipeline"); }
+		m_Device.SetObjectName(VK_OBJECT_TYPE_PIPELINE, m_Pipeline, "Depth Reduce");
+	}
+
+	void HiZOcclusionCuller::BeginFrame(FrameInfo& frameInfo) {
+		FLORENCIA_PROFILE_SCOPE("HiZOcclusionCuller::BeginFrame");
+		Readback& readback = m_Readbacks[frameInfo.m_FrameIndex];
+		if (!readback.m_Pending) { return; }
+		readback.m_Pending = false;
+		m_Pyramid.Build(static_cast<const float*>(readback.m_Buffer->GetMappedMemory()), readback.m_Extent.width, readback.m_Extent.height, readback.m_ViewProjection);
+	}
+
+	void HiZOcclusionCuller::EndFrame(FrameInfo& frameInfo) {
+		FLORENCIA_PROFILE_SCOPE("HiZOcclusionCuller::EndFrame");
+		Readback& readback = m_Readbacks[frameInfo.m_FrameIndex];
+		VkExtent2D extent = m_Renderer.GetSwapChainExtent();
+		if (extent.width == 0 || extent.height == 0) { return; }
+
+		//Each reduced texel covers a whole block of depth texels so the reduction stays conservative
+		uint32_t scale = 1;
+		while (extent.width / scale > MaxReducedWidth) { scale *= 2; }
+		VkExtent2D reduced{ (extent.width + scale - 1) / scale, (extent.height + scale - 1) / scale };
+
+		uint32_t texelCount = reduced.width * reduced.height;
+		if (readback.m_Buffer == nullptr || readback.m_Buffer->GetInstanceCount() < texelCount) {
+			readback.m_Buffer = std::make_unique<Buffer>(
+				m_Device,
+				sizeof(float),
+				texelCount,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			readback.m_Buffer->SetName("Reduced Depth Readback");
+			readback.m_Buffer->Map();
+		}
+		readback.m_Extent = reduced;
+		readback.m_ViewProjection = frameInfo.m_Camera.GetProjectionMatrix() * frameInfo.m_Camera.GetViewMatrix();
+		readback.m_Pending = true;
+
+		//The depth image changes with the swapchain image, so the set is rewritten every frame
+		VkDescriptorImageInfo depthInfo{ m_Sampler, m_Renderer.GetCurrentDepthImageView(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+		VkDescriptorBufferInfo reducedInfo = readback.m_Buffer->DescriptorInfo();
+		DescriptorWriter writer{ *m_SetLayout, *m_Pool, &frameInfo.m_FrameArena };
+		writer.WriteImage(0, &depthInfo).WriteBuffer(1, &reducedInfo);
+		if (readback.m_DescriptorSet == VK_NULL_HANDLE) {
+			if (!writer.Build(readback.m_DescriptorSet)) { throw std::runtime_error("Failed to Allocate Depth Reduce Descriptor Set"); }
+			m_Device.SetObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, readback.m_DescriptorSet, "Depth Reduce Set");
+		}
+		else {
+			writer.Overwrite(readback.m_DescriptorSet);
+		}
+
+		DebugLabelScope label{ m_Device, frameInfo.m_CommandBuffer, "Depth Reduce" };
+		VkImageMemoryBarrier toShaderRead{};
+		toShaderRead.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toShaderRead.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		toShaderRead.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		toShaderRead.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		toShaderRead.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		toShaderRead.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toShaderRead.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toShaderRead.image = m_Renderer.GetCurrentDepthImage();
+		toShaderRead.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (m_Renderer.GetDepthFormat() != VK_FORMAT_D32_SFLOAT) { toShaderRead.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT; }
+		toShaderRead.subresourceRange.levelCount = 1;
+		toShaderRead.subresourceRange.layerCount = 1;
+		vkCmdPipelineBarrier(frameInfo.m_CommandBuffer, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShaderRead);
+
+		DepthReducePush push{ { extent.width, extent.height }, { reduced.width, reduced.height }, scale };
+		vkCmdBindPipeline(frameInfo.m_CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+		vkCmdBindDescriptorSets(frameInfo.m_CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &readback.m_DescriptorSet, 0, nullptr);
+		vkCmdPushConstants(frameInfo.m_CommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DepthReducePush), &push);
+		vkCmdDispatch(frameInfo.m_CommandBuffer, (reduced.width + DepthReduceGroupSize - 1) / DepthReduceGroupSize, (reduced.height + DepthReduceGroupSize - 1) / DepthReduceGroupSize, 1);
+
+		VkBufferMemoryBarrier toHost{};
+		toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		toHost.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.buffer = readback.m_Buffer->GetBuffer();
+		toHost.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(frameInfo.m_CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost, 0, nullptr);
+	}
+
+	bool HiZOcclusionCuller::IsVisible(Entity entity, const AABB& worldBounds) {
+		if (!m_Pyramid.IsValid()) { return true; }
+		if (entity.m_Index >= m_OccludedStreaks.size()) { m_OccludedStreaks.resize(entity.m_Index + 1); }
+
+		OccludedStreak& streak = m_OccludedStreaks[entity.m_Index];
+		if (streak.m_Generation != entity.m_Generation) { streak = { entity.m_Generation, 0 }; }
+		if (!m_Pyramid.IsOccluded(worldBounds)) {
+			streak.m_Frames = 0;
+			return true;
+		}
+		if (streak.m_Frames < OccludedFramesBeforeCull) { streak.m_Frames++; }
+		return streak.m_Frames < OccludedFramesBeforeCull;
+	}
+
+	SoftwareOcclusionCuller::SoftwareOcclusionCuller(JobSystem& jobs, uint32_t width, uint32_t height) : m_Jobs{ jobs }, m_Rasterizer{ width, height } {}
+
+	void SoftwareOcclusionCuller::BeginFrame(FrameInfo& frameInfo) {
+		FLORENCIA_PROFILE_SCOPE("SoftwareOcclusionCuller::BeginFrame");
+		m_Rasterizer.Begin(frameInfo.m_Camera.GetProjectionMatrix() * frameInfo.m_Camera.GetViewMatrix());
+		frameInfo.m_Registry.Query<OccluderComponent, TransformComponent>().Each([&](Entity entity, OccluderComponent& occluder, TransformComponent& transform) {
+			m_Rasterizer.AddOccluder(occluder.m_Vertices.data(), occluder.m_Indices.data(), static_cast<uint32_t>(occluder.m_Indices.size()), transform.Mat4());
+		});
+		m_Rasterizer.Rasterize(&m_Jobs);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "SoftwareRasterizer.h"
+#include "DepthPyramid.h"
+#include "Descriptors.h"
+#include "FrameInfo.h"
+#include "Renderer.h"
+#include "Buffer.h"
+#include "Device.h"
+
+namespace Florencia {
+
+	//CPU copy of a mesh that the software rasterizer draws as an occluder, keep these to a handful of large simple meshes
+	struct OccluderComponent {
+		std::vector<glm::vec3> m_Vertices{};
+		std::vector<uint32_t> m_Indices{};
+
+		static OccluderComponent FromModelData(const Model::Data& data);
+	};
+
+	class OcclusionCuller {
+	public:
+		virtual ~OcclusionCuller() = default;
+
+		//Called after BeginFrame, the timeline has reached the last submission of this frame index so its resources are free
+		virtual void BeginFrame(FrameInfo& frameInfo) {}
+		//Called after the swapchain render pass has ended, before the command buffer is submitted
+		virtual void EndFrame(FrameInfo& frameInfo) {}
+		virtual bool IsVisible(Entity entity, const AABB& worldBounds) = 0;
+	};
+
+	//Reduces the depth attachment on the gpu every frame and reads back only the reduced level, the rest of the Hi-Z pyramid
+	//is built on the cpu from it once the frame has completed
+	//Results are as many frames old as there are frames in flight, so an object is only culled after it tested occluded on consecutive frames
+	//This stands in for two-phase culling, re-testing culled objects against the current frame's depth needs gpu issued draws
+	class HiZOcclusionCuller : public OcclusionCuller {
+	public:
+		static constexpr uint8_t OccludedFramesBeforeCull = 2;
+		//Widest the reduced depth gets, full resolution is never needed for object sized queries
+		static constexpr uint32_t MaxReducedWidth = 512;
+
+		HiZOcclusionCuller(Device& device, Renderer& renderer);
+		~HiZOcclusionCuller();
+
+		HiZOcclusionCuller(const HiZOcclusionCuller&) = delete;
+		HiZOcclusionCuller& operator=(const HiZOcclusionCuller&) = delete;
+
+		void BeginFrame(FrameInfo& frameInfo) override;
+		void EndFrame(FrameInfo& frameInfo) override;
+		bool IsVisible(Entity entity, const AABB& worldBounds) override;
+
+	private:
+		struct Readback {
+			std::unique_ptr<Buffer> m_Buffer;
+			VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+			//Of the reduced depth, not the attachment
+			VkExtent2D m_Extent{ 0, 0 };
+			glm::mat4 m_ViewProjection{ 1.0f };
+			bool m_Pending = false;
+		};
+
+		//The generation keeps an entity that reuses a destroyed one's index from inheriting its streak
+		struct OccludedStreak {
+			uint32_t m_Generation = 0;
+			uint8_t m_Frames = 0;
+		};
+
+		void CreatePipeline();
+
+		Device& m_Device;
+		Renderer& m_Renderer;
+		std::unique_ptr<DescriptorSetLayout> m_SetLayout;
+		std::unique_ptr<DescriptorPool> m_Pool;
+		VkSampler m_Sampler = VK_NULL_HANDLE;
+		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_Pipeline = VK_NULL_HANDLE;
+		DepthPyramid m_Pyramid;
+		std::vector<Readback> m_Readbacks;
+		std::vector<OccludedStreak> m_OccludedStreaks;
+	};
+
+	//Rasterizes every OccluderComponent into a small depth buffer at the start of the frame, needs nothing back from the gpu
+	class SoftwareOcclusionCuller : public OcclusionCuller {
+	public:
+		SoftwareOcclusionCuller(JobSystem& jobs, uint32_t width = 256, uint32_t height = 192);
+
+		SoftwareOcclusionCuller(const SoftwareOcclusionCuller&) = delete;
+		SoftwareOcclusionCuller& operator=(const SoftwareOcclusionCuller&) = delete;
+
+		void BeginFrame(FrameInfo& frameInfo) override;
+		bool IsVisible(Entity entity, const AABB& worldBounds) override { return !m_Rasterizer.IsOccluded(worldBounds); }
+
+	private:
+		JobSystem& m_Jobs;
+		SoftwareRasterizer m_Rasterizer;
+	};
+
+}
\ No newline at end of file
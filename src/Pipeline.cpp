@@ -8,21 +8,172 @@
 
 namespace Florencia {
 
+	void PipelineStateKey::Append(const std::string& value) {
+		Append(value.size());
+		Append(value.data(), value.size());
+	}
+
+	void PipelineStateKey::Append(const void* data, size_t size) {
+		const char* bytes = static_cast<const char*>(data);
+		m_Bytes.insert(m_Bytes.end(), bytes, bytes + size);
+		m_Hash = HashBytes(data, size, m_Hash);
+	}
+
+	PipelineStateKey PipelineConfigInfo::Key(VkGraphicsPipelineLibraryFlagsEXT parts) const {
+		PipelineStateKey key{};
+		key.Append(parts);
+
+		if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT) {
+			key.Append(bindingDescriptions.size());
+			for (const auto& binding : bindingDescriptions) {
+				key.Append(binding.binding);
+				key.Append(binding.stride);
+				key.Append(binding.inputRate);
+			}
+			key.Append(attributeDescriptions.size());
+			for (const auto& attribute : attributeDescriptions) {
+				key.Append(attribute.location);
+				key.Append(attribute.binding);
+				key.Append(attribute.format);
+				key.Append(attribute.offset);
+			}
+			key.Append(inputAssemblyInfo.topology);
+			key.Append(inputAssemblyInfo.primitiveRestartEnable);
+		}
+
+		if (parts & ~VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT) {
+			key.Append(renderPass);
+			key.Append(subpass);
+			key.Append(colorAttachmentFormats.size());
+			for (VkFormat format : colorAttachmentFormats) { key.Append(format); }
+			key.Append(depthAttachmentFormat);
+			key.Append(dynamicStateInfo.dynamicStateCount);
+			key.Append(dynamicStateInfo.pDynamicStates, dynamicStateInfo.dynamicStateCount * sizeof(VkDynamicState));
+		}
+
+		if (parts & (VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)) {
+			key.Append(pipelineLayout);
+			key.Append(specializationInfo.mapEntryCount);
+			for (uint32_t i = 0; i < specializationInfo.mapEntryCount; i++) {
+				key.Append(specializationInfo.pMapEntries[i].constantID);
+				key.Append(specializationInfo.pMapEntries[i].offset);
+				key.Append(specializationInfo.pMapEntries[i].size);
+			}
+			if (specializationInfo.mapEntryCount > 0) { key.Append(specializationInfo.pData, specializationInfo.dataSize); }
+		}
+
+		if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) {
+			key.Append(viewportInfo.viewportCount);
+			key.Append(viewportInfo.scissorCount);
+			key.Append(rasterizationInfo.depthClampEnable);
+			key.Append(rasterizationInfo.rasterizerDiscardEnable);
+			key.Append(rasterizationInfo.polygonMode);
+			key.Append(rasterizationInfo.cullMode);
+			key.Append(rasterizationInfo.frontFace);
+			key.Append(rasterizationInfo.depthBiasEnable);
+			key.Append(rasterizationInfo.depthBiasConstantFactor);
+			key.Append(rasterizationInfo.depthBiasClamp);
+			key.Append(rasterizationInfo.depthBiasSlopeFactor);
+			key.Append(rasterizationInfo.lineWidth);
+		}
+
+		if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) {
+			key.Append(depthStencilInfo.depthTestEnable);
+			key.Append(depthStencilInfo.depthWriteEnable);
+			key.Append(depthStencilInfo.depthCompareOp);
+			key.Append(depthStencilInfo.depthBoundsTestEnable);
+			key.Append(depthStencilInfo.stencilTestEnable);
+			for (const VkStencilOpState* stencil : { &depthStencilInfo.front, &depthStencilInfo.back }) {
+				key.Append(stencil->failOp);
+				key.Append(stencil->passOp);
+				key.Append(stencil->depthFailOp);
+				key.Append(stencil->compareOp);
+				key.Append(stencil->compareMask);
+				key.Append(stencil->writeMask);
+				key.Append(stencil->reference);
+			}
+			key.Append(depthStencilInfo.minDepthBounds);
+			key.Append(depthStencilInfo.maxDepthBounds);
+			key.Append(multisampleInfo.sampleShadingEnable);
+			key.Append(multisampleInfo.minSampleShading);
+		}
+
+		if (parts & (VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT)) {
+			key.Append(multisampleInfo.rasterizationSamples);
+		}
+
+		if (parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT) {
+			key.Append(multisampleInfo.alphaToCoverageEnable);
+			key.Append(multisampleInfo.alphaToOneEnable);
+			key.Append(colorBlendInfo.logicOpEnable);
+			key.Append(colorBlendInfo.logicOp);
+			key.Append(colorBlendInfo.attachmentCount);
+			for (uint32_t i = 0; i < colorBlendInfo.attachmentCount; i++) {
+				const VkPipelineColorBlendAttachmentState& attachment = colorBlendInfo.pAttachments[i];
+				key.Append(attachment.blendEnable);
+				key.Append(attachment.srcColorBlendFactor);
+				key.Append(attachment.dstColorBlendFactor);
+				key.Append(attachment.colorBlendOp);
+				key.Append(attachment.srcAlphaBlendFactor);
+				key.Append(attachment.dstAlphaBlendFactor);
+				key.Append(attachment.alphaBlendOp);
+				key.Append(attachment.colorWriteMask);
+			}
+			key.Append(colorBlendInfo.blendConstants, sizeof(colorBlendInfo.blendConstants));
+		}
+		return key;
+	}
+
 	Pipeline::Pipeline(Device& device, const PipelineConfigInfo& info, const std::string& vertPath, const std::string& fragPath)
 		:m_Device{ device } {
-		CreateGraphicsPipeline(info, vertPath, fragPath);
+		CreateShaderModule(m_Device, &m_VertShaderModule, ReadFile(vertPath));
+		if (!fragPath.empty()) { CreateShaderModule(m_Device, &m_FragShaderModule, ReadFile(fragPath)); }
+		m_GraphicsPipeline = CreateGraphicsPipeline(m_Device, info, m_VertShaderModule, m_FragShaderModule, nullptr, 0);
+		if (m_Device.SupportsDebugUtils()) { SetName((vertPath + " " + fragPath).c_str()); }
+	}
+
+	Pipeline::Pipeline(Device& device, const PipelineConfigInfo& info, VkShaderModule vertModule, VkShaderModule fragModule)
+		:m_Device{ device } {
+		m_GraphicsPipeline = CreateGraphicsPipeline(m_Device, info, vertModule, fragModule, nullptr, 0);
+	}
+
+	Pipeline::Pipeline(Device& device, VkPipelineLayout pipelineLayout, const std::vector<VkPipeline>& libraries)
+		:m_Device{ device } {
+		VkPipelineLibraryCreateInfoKHR libraryInfo{};
+		libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		libraryInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+		libraryInfo.pLibraries = libraries.data();
+
+		//Every piece of state comes from the libraries, linking without link time optimization keeps this cheap
+		VkGraphicsPipelineCreateInfo graphicsInfo{};
+		graphicsInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		graphicsInfo.pNext = &libraryInfo;
+		graphicsInfo.layout = pipelineLayout;
+		graphicsInfo.basePipelineIndex = -1;
+		graphicsInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		if (vkCreateGraphicsPipelines(m_Device.Get(), m_Device.GetPipelineCache(), 1, &graphicsInfo, m_Device.GetAllocator(), &m_GraphicsPipeline) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to Link Graphics Pipeline Library");
+		}
 	}
 
 	Pipeline::~Pipeline() {
-		vkDestroyShaderModule(m_Device.Get(), m_VertShaderModule, nullptr);
-		vkDestroyShaderModule(m_Device.Get(), m_FragShaderModule, nullptr);
-		vkDestroyPipeline(m_Device.Get(), m_GraphicsPipeline, nullptr);
+		vkDestroyShaderModule(m_Device.Get(), m_VertShaderModule, m_Device.GetAllocator());
+		vkDestroyShaderModule(m_Device.Get(), m_FragShaderModule, m_Device.GetAllocator());
+		vkDestroyPipeline(m_Device.Get(), m_GraphicsPipeline, m_Device.GetAllocator());
 	}
 
 	void Pipeline::Bind(VkCommandBuffer commandBuffer) {
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
 	}
 
+	bool Pipeline::Bind(VkCommandBuffer commandBuffer, VkPipeline& boundPipeline) {
+		if (boundPipeline == m_GraphicsPipeline) { return false; }
+		Bind(commandBuffer);
+		boundPipeline = m_GraphicsPipeline;
+		return true;
+	}
+
 	void Pipeline::DefaultPipelineConfigInfo(PipelineConfigInfo& info) {
 		info.inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 		info.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
@@ -105,6 +256,18 @@ namespace Florencia {
 		info.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 	}
 
+	void Pipeline::DepthOnlyPipelineConfigInfo(PipelineConfigInfo& info) {
+		info.colorBlendAttachment.colorWriteMask = 0;
+		info.attributeDescriptions = { info.attributeDescriptions[0] };
+	}
+
+	void Pipeline::RenderTargetConfigInfo(PipelineConfigInfo& info, const RenderTargetInfo& target) {
+		info.renderPass = target.renderPass;
+		if (target.renderPass != VK_NULL_HANDLE) { return; }
+		info.colorAttachmentFormats = { target.colorFormat };
+		info.depthAttachmentFormat = target.depthFormat;
+	}
+
 	std::vector<char> Pipeline::ReadFile(const std::string& filepath) {
 		std::string enginePath = ENGINE_DIRECTORY + filepath;
 		std::ifstream file{ enginePath, std::ios::ate | std::ios::binary };
@@ -122,36 +285,47 @@ namespace Florencia {
 		return buffer;
 	}
 
-	void Pipeline::CreateGraphicsPipeline(const PipelineConfigInfo& info, const std::string& vertPath, const std::string& fragPath) {
+	VkPipeline Pipeline::CreateLibrary(Device& device, const PipelineConfigInfo& info, VkGraphicsPipelineLibraryFlagsEXT parts, VkShaderModule vertModule, VkShaderModule fragModule) {
+		VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+		libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+		libraryInfo.flags = parts;
+
+		//State and stages outside of parts are ignored, so the modules are only passed to the parts that own them
+		if (!(parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT)) { vertModule = VK_NULL_HANDLE; }
+		if (!(parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)) { fragModule = VK_NULL_HANDLE; }
+		return CreateGraphicsPipeline(device, info, vertModule, fragModule, &libraryInfo, VK_PIPELINE_CREATE_LIBRARY_BIT_KHR);
+	}
+
+	VkPipeline Pipeline::CreateGraphicsPipeline(Device& device, const PipelineConfigInfo& info, VkShaderModule vertModule, VkShaderModule fragModule, const void* pNext, VkPipelineCreateFlags flags) {
 		if(info.pipelineLayout == VK_NULL_HANDLE) {
 			throw std::runtime_error("Cannot Create Graphics Pipeline: No Pipeline Layout Provided");
 		}
-		if(info.renderPass == VK_NULL_HANDLE) {
-			throw std::runtime_error("Cannot Create Graphics Pipeline: No RenderPass Provided");
+		if(info.renderPass == VK_NULL_HANDLE && info.colorAttachmentFormats.empty() && info.depthAttachmentFormat == VK_FORMAT_UNDEFINED) {
+			throw std::runtime_error("Cannot Create Graphics Pipeline: No RenderPass Or Attachment Formats Provided");
 		}
 
-		auto vertCode = ReadFile(vertPath);
-		auto fragCode = ReadFile(fragPath);
-
-		CreateShaderModule(&m_VertShaderModule, vertCode);
-		CreateShaderModule(&m_FragShaderModule, fragCode);
+		//Without a render pass the attachment formats are chained in front of the caller's pNext for dynamic rendering
+		VkPipelineRenderingCreateInfoKHR renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+		renderingInfo.pNext = pNext;
+		renderingInfo.colorAttachmentCount = static_cast<uint32_t>(info.colorAttachmentFormats.size());
+		renderingInfo.pColorAttachmentFormats = info.colorAttachmentFormats.data();
+		renderingInfo.depthAttachmentFormat = info.depthAttachmentFormat;
+		if (info.renderPass == VK_NULL_HANDLE) { pNext = &renderingInfo; }
 
 		VkPipelineShaderStageCreateInfo shaderStages[2];
-		shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		shaderStages[0].module = m_VertShaderModule;
-		shaderStages[0].pName = "main";
-		shaderStages[0].flags = 0;
-		shaderStages[0].pNext = nullptr;
-		shaderStages[0].pSpecializationInfo = nullptr;
-
-		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		shaderStages[1].module = m_FragShaderModule;
-		shaderStages[1].pName = "main";
-		shaderStages[1].flags = 0;
-		shaderStages[1].pNext = nullptr;
-		shaderStages[1].pSpecializationInfo = nullptr;
+		uint32_t stageCount = 0;
+		for (auto [stage, shaderModule] : { std::make_pair(VK_SHADER_STAGE_VERTEX_BIT, vertModule), std::make_pair(VK_SHADER_STAGE_FRAGMENT_BIT, fragModule) }) {
+			if (shaderModule == VK_NULL_HANDLE) { continue; }
+			VkPipelineShaderStageCreateInfo& shaderStage = shaderStages[stageCount++];
+			shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			shaderStage.stage = stage;
+			shaderStage.module = shaderModule;
+			shaderStage.pName = "main";
+			shaderStage.flags = 0;
+			shaderStage.pNext = nullptr;
+			shaderStage.pSpecializationInfo = info.specializationInfo.mapEntryCount > 0 ? &info.specializationInfo : nullptr;
+		}
 
 		auto& bindingDescriptions = info.bindingDescriptions;
 		auto& attributeDescriptions = info.attributeDescriptions;
@@ -164,7 +338,7 @@ namespace Florencia {
 
 		VkGraphicsPipelineCreateInfo graphicsInfo{};
 		graphicsInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		graphicsInfo.stageCount = 2;
+		graphicsInfo.stageCount = stageCount;
 		graphicsInfo.pStages = shaderStages;
 		graphicsInfo.pVertexInputState = &vertInputInfo;
 		graphicsInfo.pInputAssemblyState = &info.inputAssemblyInfo;
@@ -174,9 +348,9 @@ namespace Florencia {
 		graphicsInfo.pColorBlendState = &info.colorBlendInfo;
 		graphicsInfo.pDepthStencilState = &info.depthStencilInfo;
 		graphicsInfo.pDynamicState = &info.dynamicStateInfo;
-		graphicsInfo.flags = 0;
+		graphicsInfo.flags = flags;
 
-		graphicsInfo.pNext = nullptr;
+		graphicsInfo.pNext = pNext;
 		graphicsInfo.pTessellationState = nullptr;
 
 		graphicsInfo.layout = info.pipelineLayout;
@@ -186,19 +360,21 @@ namespace Florencia {
 		graphicsInfo.basePipelineIndex = -1;
 		graphicsInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-		if (vkCreateGraphicsPipelines(m_Device.Get(), VK_NULL_HANDLE, 1, &graphicsInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS) {
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(device.Get(), device.GetPipelineCache(), 1, &graphicsInfo, device.GetAllocator(), &pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to Create Graphics Pipeline");
 		}
+		return pipeline;
 	}
 
-	void Pipeline::CreateShaderModule(VkShaderModule* shaderModule, const std::vector<char>& code) {
+	void Pipeline::CreateShaderModule(Device& device, VkShaderModule* shaderModule, const std::vector<char>& code) {
 		VkShaderModuleCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 		createInfo.codeSize = code.size();
 		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 		createInfo.pNext = nullptr;
 		createInfo.flags = 0;
-		if (vkCreateShaderModule(m_Device.Get(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
+		if (vkCreateShaderModule(device.Get(), &createInfo, device.GetAllocator(), shaderModule) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to Create Shader Module");
 		}
 	}
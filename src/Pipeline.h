@@ -1,12 +1,46 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <type_traits>
 
 #include "Device.h"
 #include "Model.h"
+#include "Utilities.h"
 
 namespace Florencia {
 
+	//Byte serialization of pipeline state, two pipelines with equal keys are interchangeable
+	class PipelineStateKey {
+	public:
+		//Scalars only so struct padding never ends up in the key
+		template<typename T>
+		void Append(const T& value) {
+			static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>, "Append structs field by field");
+			Append(&value, sizeof(T));
+		}
+		void Append(const std::string& value);
+		void Append(const void* data, size_t size);
+
+		uint64_t Hash() const { return m_Hash; }
+		bool operator==(const PipelineStateKey& other) const { return m_Hash == other.m_Hash && m_Bytes == other.m_Bytes; }
+		bool operator!=(const PipelineStateKey& other) const { return !(*this == other); }
+
+		struct Hasher {
+			size_t operator()(const PipelineStateKey& key) const { return static_cast<size_t>(key.Hash()); }
+		};
+
+	private:
+		std::vector<char> m_Bytes;
+		uint64_t m_Hash = HashBytes(nullptr, 0);
+	};
+
+	//What a pipeline renders into, with renderPass left VK_NULL_HANDLE it targets dynamic rendering with these formats
+	struct RenderTargetInfo {
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+		VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+	};
+
 	struct PipelineConfigInfo {
 		PipelineConfigInfo() = default;
 		PipelineConfigInfo(const PipelineConfigInfo&) = delete;
@@ -26,29 +60,61 @@ namespace Florencia {
 		VkPipelineLayout pipelineLayout = nullptr;
 		VkRenderPass renderPass = nullptr;
 		uint32_t subpass = 0;
+		//Attachment formats for dynamic rendering, only used when renderPass is VK_NULL_HANDLE
+		std::vector<VkFormat> colorAttachmentFormats{};
+		VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+		//Applied to every stage, stages ignore constant ids they don't declare, no entries means no specialization
+		VkSpecializationInfo specializationInfo{};
+
+		static constexpr VkGraphicsPipelineLibraryFlagsEXT AllLibraryParts = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT
+			| VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT | VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+		//Covers only the state the given library parts are built from, shader modules are not part of the key
+		//Pointed at data (blend attachments, dynamic states, specialization data) is read through the create info pointers
+		PipelineStateKey Key(VkGraphicsPipelineLibraryFlagsEXT parts = AllLibraryParts) const;
+		uint64_t Hash() const { return Key().Hash(); }
+		bool operator==(const PipelineConfigInfo& other) const { return Key() == other.Key(); }
+		bool operator!=(const PipelineConfigInfo& other) const { return !(*this == other); }
 	};
 
 	class Pipeline {
 	public:
+		//An empty fragPath creates a pipeline without a fragment stage, for depth only passes
 		Pipeline(Device& device, const PipelineConfigInfo& info, const std::string& vertPath, const std::string& fragPath);
+		//Modules stay owned by the caller and only have to outlive the constructor, fragModule may be VK_NULL_HANDLE
+		Pipeline(Device& device, const PipelineConfigInfo& info, VkShaderModule vertModule, VkShaderModule fragModule);
+		//Links graphics pipeline library parts made with CreateLibrary, together they must cover every part
+		Pipeline(Device& device, VkPipelineLayout pipelineLayout, const std::vector<VkPipeline>& libraries);
 		~Pipeline();
 
 		Pipeline(const Pipeline&) = delete;
 		Pipeline& operator=(const Pipeline&) = delete;
 
 		void Bind(VkCommandBuffer commandBuffer);
+		void SetName(const char* name) { m_Device.SetObjectName(VK_OBJECT_TYPE_PIPELINE, m_GraphicsPipeline, name); }
+		//Skips the bind when this pipeline is already boundPipeline, which is updated to the pipeline bound last, true if it bound
+		bool Bind(VkCommandBuffer commandBuffer, VkPipeline& boundPipeline);
 
 		static void DefaultPipelineConfigInfo(PipelineConfigInfo& info);
 		static void EnableAlphaBlending(PipelineConfigInfo& info);
+		//Position only vertex input and no color writes
+		static void DepthOnlyPipelineConfigInfo(PipelineConfigInfo& info);
+		//Sets the render pass, or the single color and depth attachment formats when target has no render pass
+		static void RenderTargetConfigInfo(PipelineConfigInfo& info, const RenderTargetInfo& target);
 
-	private:
+		//Paths are relative to the engine directory
 		static std::vector<char> ReadFile(const std::string& filepath);
-		void CreateGraphicsPipeline(const PipelineConfigInfo& info, const std::string& vertPath, const std::string& fragPath);
-		void CreateShaderModule(VkShaderModule* shaderModule, const std::vector<char>& code);
+		static void CreateShaderModule(Device& device, VkShaderModule* shaderModule, const std::vector<char>& code);
+		//Needs Device::SupportsGraphicsPipelineLibrary, the caller destroys the library once every pipeline linking it is gone
+		static VkPipeline CreateLibrary(Device& device, const PipelineConfigInfo& info, VkGraphicsPipelineLibraryFlagsEXT parts, VkShaderModule vertModule, VkShaderModule fragModule);
+
+	private:
+		//pNext and flags select between a full pipeline and a library
+		static VkPipeline CreateGraphicsPipeline(Device& device, const PipelineConfigInfo& info, VkShaderModule vertModule, VkShaderModule fragModule, const void* pNext, VkPipelineCreateFlags flags);
 
 		Device& m_Device;
 		VkPipeline m_GraphicsPipeline;
-		VkShaderModule m_VertShaderModule, m_FragShaderModule;
+		VkShaderModule m_VertShaderModule = VK_NULL_HANDLE, m_FragShaderModule = VK_NULL_HANDLE;
 	};
 
 }
\ No newline at end of file
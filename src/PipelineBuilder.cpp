@@ -0,0 +1,194 @@
+#include "PipelineBuilder.h"
+
+namespace Florencia {
+
+	PipelineBuilder::PipelineBuilder(Device& device, JobSystem& jobSystem) : m_Device{ device }, m_JobSystem{ jobSystem } {}
+
+	PipelineBuilder::~PipelineBuilder() {
+		WaitIdle();
+		//Linked pipelines go before the libraries they were linked from
+		m_Pipelines.clear();
+		for (auto& [key, library] : m_Libraries) { vkDestroyPipeline(m_Device.Get(), library, m_Device.GetAllocator()); }
+		for (auto& [hash, shaderModule] : m_ModulesByHash) { vkDestroyShaderModule(m_Device.Get(), shaderModule.m_Module, m_Device.GetAllocator()); }
+	}
+
+	SharedPipeline PipelineBuilder::Build(const PipelineConfigInfo& info, const std::string& vertPath, const std::string& fragPath) {
+		PipelineStateKey key = info.Key();
+		key.Append(vertPath);
+		key.Append(fragPath);
+
+		std::lock_guard<std::mutex> pipelineLock(m_PipelineMutex);
+		auto it = m_Pipelines.find(key);
+		if (it != m_Pipelines.end()) {
+			m_SharedBuilds++;
+			return it->second;
+		}
+
+		auto request = std::make_shared<BuildRequest>();
+		CopyConfigInfo(info, *request);
+		request->m_VertPath = vertPath;
+		request->m_FragPath = fragPath;
+
+		{
+			std::lock_guard<std::mutex> lock(m_PendingMutex);
+			m_PendingBuilds++;
+		}
+		SharedPipeline pipeline = m_JobSystem.Submit([this, request]() {
+			std::shared_ptr<Pipeline> pipeline;
+			try {
+				pipeline = CreatePipeline(*request);
+			}
+			catch (...) {
+				//The exception is handed to the future, the build still has to count as finished
+				FinishBuild();
+				throw;
+			}
+			FinishBuild();
+			return pipeline;
+		}).share();
+		m_Pipelines.emplace(std::move(key), pipeline);
+		return pipeline;
+	}
+
+	std::shared_ptr<Pipeline> PipelineBuilder::CreatePipeline(const BuildRequest& request) {
+		VkShaderModule vertModule = GetShaderModule(request.m_VertPath);
+		VkShaderModule fragModule = request.m_FragPath.empty() ? VK_NULL_HANDLE : GetShaderModule(request.m_FragPath);
+		std::shared_ptr<Pipeline> pipeline;
+		if (!m_Device.SupportsGraphicsPipelineLibrary()) { pipeline = std::make_shared<Pipeline>(m_Device, request.m_Info, vertModule, fragModule); }
+		else {
+			std::vector<VkPipeline> libraries;
+			for (VkGraphicsPipelineLibraryFlagsEXT part : { VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+				VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT }) {
+				libraries.push_back(GetLibrary(request, part, vertModule, fragModule));
+			}
+			pipeline = std::make_shared<Pipeline>(m_Device, request.m_Info.pipelineLayout, libraries);
+		}
+		//Variants of the same shaders share a name, captures tell them apart by their state
+		if (m_Device.SupportsDebugUtils()) { pipeline->SetName((request.m_VertPath + " " + request.m_FragPath).c_str()); }
+		return pipeline;
+	}
+
+	VkPipeline PipelineBuilder::GetLibrary(const BuildRequest& request, VkGraphicsPipelineLibraryFlagsEXT part, VkShaderModule vertModule, VkShaderModule fragModule) {
+		PipelineStateKey key = request.m_Info.Key(part);
+		if (part == VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) { key.Append(vertModule); }
+		if (part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) { key.Append(fragModule); }
+		{
+			std::lock_guard<std::mutex> lock(m_LibraryMutex);
+			auto it = m_Libraries.find(key);
+			if (it != m_Libraries.end()) { return it->second; }
+		}
+
+		//Compiled outside the lock, if another build made the same part meanwhile that one is kept
+		VkPipeline library = Pipeline::CreateLibrary(m_Device, request.m_Info, part, vertModule, fragModule);
+		std::lock_guard<std::mutex> lock(m_LibraryMutex);
+		auto [it, inserted] = m_Libraries.emplace(std::move(key), library);
+		if (!inserted) { vkDestroyPipeline(m_Device.Get(), library, m_Device.GetAllocator()); }
+		return it->second;
+	}
+
+	void PipelineBuilder::FinishBuild() {
+		std::lock_guard<std::mutex> lock(m_PendingMutex);
+		if (--m_PendingBuilds == 0) { m_PendingCondition.notify_all(); }
+	}
+
+	void PipelineBuilder::WaitIdle() {
+		std::unique_lock<std::mutex> lock(m_PendingMutex);
+		m_PendingCondition.wait(lock, [this]() { return m_PendingBuilds == 0; });
+	}
+
+	size_t PipelineBuilder::GetShaderModuleCount() {
+		std::lock_guard<std::mutex> lock(m_ModuleMutex);
+		return m_ModulesByHash.size();
+	}
+
+	size_t PipelineBuilder::GetPipelineCount() {
+		std::lock_guard<std::mutex> lock(m_PipelineMutex);
+		return m_Pipelines.size();
+	}
+
+	uint32_t PipelineBuilder::GetSharedBuildCount() {
+		std::lock_guard<std::mutex> lock(m_PipelineMutex);
+		return m_SharedBuilds;
+	}
+
+	size_t PipelineBuilder::GetLibraryCount() {
+		std::lock_guard<std::mutex> lock(m_LibraryMutex);
+		return m_Libraries.size();
+	}
+
+	void PipelineBuilder::CopyConfigInfo(const PipelineConfigInfo& source, BuildRequest& request) {
+		PipelineConfigInfo& info = request.m_Info;
+		info.bindingDescriptions = source.bindingDescriptions;
+		info.attributeDescriptions = source.attributeDescriptions;
+		info.colorBlendAttachment = source.colorBlendAttachment;
+		info.inputAssemblyInfo = source.inputAssemblyInfo;
+		info.rasterizationInfo = source.rasterizationInfo;
+		info.depthStencilInfo = source.depthStencilInfo;
+		info.multisampleInfo = source.multisampleInfo;
+		info.colorBlendInfo = source.colorBlendInfo;
+		info.dynamicStateInfo = source.dynamicStateInfo;
+		info.viewportInfo = source.viewportInfo;
+		info.pipelineLayout = source.pipelineLayout;
+		info.renderPass = source.renderPass;
+		info.subpass = source.subpass;
+		info.colorAttachmentFormats = source.colorAttachmentFormats;
+		info.depthAttachmentFormat = source.depthAttachmentFormat;
+		info.specializationInfo = source.specializationInfo;
+
+		//Everything the config points at is copied into the request so the caller's storage can go away
+		const VkPipelineColorBlendStateCreateInfo& blend = source.colorBlendInfo;
+		request.m_BlendAttachments.assign(blend.pAttachments, blend.pAttachments + blend.attachmentCount);
+		info.colorBlendInfo.pAttachments = request.m_BlendAttachments.data();
+
+		const VkPipelineDynamicStateCreateInfo& dynamic = source.dynamicStateInfo;
+		info.dynamicStateEnables.assign(dynamic.pDynamicStates, dynamic.pDynamicStates + dynamic.dynamicStateCount);
+		info.dynamicStateInfo.pDynamicStates = info.dynamicStateEnables.data();
+
+		const VkSpecializationInfo& specialization = source.specializationInfo;
+		if (specialization.mapEntryCount > 0) {
+			request.m_SpecializationEntries.assign(specialization.pMapEntries, specialization.pMapEntries + specialization.mapEntryCount);
+			const char* data = static_cast<const char*>(specialization.pData);
+			request.m_SpecializationData.assign(data, data + specialization.dataSize);
+			info.specializationInfo.pMapEntries = request.m_SpecializationEntries.data();
+			info.specializationInfo.pData = request.m_SpecializationData.data();
+		}
+
+		info.inputAssemblyInfo.pNext = nullptr;
+		info.rasterizationInfo.pNext = nullptr;
+		info.depthStencilInfo.pNext = nullptr;
+		info.multisampleInfo.pNext = nullptr;
+		info.multisampleInfo.pSampleMask = nullptr;
+		info.colorBlendInfo.pNext = nullptr;
+		info.dynamicStateInfo.pNext = nullptr;
+		info.viewportInfo.pNext = nullptr;
+	}
+
+	VkShaderModule PipelineBuilder::GetShaderModule(const std::string& path) {
+		{
+			std::lock_guard<std::mutex> lock(m_ModuleMutex);
+			auto it = m_ModulesByPath.find(path);
+			if (it != m_ModulesByPath.end()) { return it->second; }
+		}
+
+		//Read and hashed outside the lock so builds of different shaders don't wait on each other's file reads
+		//Collisions are resolved by comparing the code
+		std::vector<char> code = Pipeline::ReadFile(path);
+		uint64_t hash = HashBytes(code.data(), code.size());
+
+		std::lock_guard<std::mutex> lock(m_ModuleMutex);
+		auto range = m_ModulesByHash.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second.m_Code == code) {
+				m_ModulesByPath[path] = it->second.m_Module;
+				return it->second.m_Module;
+			}
+		}
+
+		VkShaderModule shaderModule;
+		Pipeline::CreateShaderModule(m_Device, &shaderModule, code);
+		m_ModulesByHash.emplace(hash, ShaderModule{ std::move(code), shaderModule });
+		m_ModulesByPath[path] = shaderModule;
+		return shaderModule;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Pipeline.h"
+#include "Device.h"
+
+namespace Florencia {
+
+	using SharedPipeline = std::shared_future<std::shared_ptr<Pipeline>>;
+
+	//Pipeline that may still be compiling, the first Get blocks until it is ready
+	class PendingPipeline {
+	public:
+		PendingPipeline() = default;
+		PendingPipeline(SharedPipeline future) : m_Future{ std::move(future) } {}
+
+		Pipeline& Get() {
+			if (m_Pipeline == nullptr) { m_Pipeline = m_Future.get(); }
+			return *m_Pipeline;
+		}
+
+	private:
+		SharedPipeline m_Future;
+		std::shared_ptr<Pipeline> m_Pipeline;
+	};
+
+	//Compiles pipelines on the job system so render systems can request all of theirs up front and wait once
+	//Shader modules are shared by every pipeline whose SPIR-V has the same contents and live as long as the builder
+	//Requests with the same state and shaders share one pipeline, and with graphics pipeline library support
+	//pipelines are linked from vertex input, pre-rasterization, fragment and output parts that are shared the same way
+	class PipelineBuilder {
+	public:
+		PipelineBuilder(Device& device, JobSystem& jobSystem);
+		~PipelineBuilder();
+
+		PipelineBuilder(const PipelineBuilder&) = delete;
+		PipelineBuilder& operator=(const PipelineBuilder&) = delete;
+
+		//info is copied before this returns, pNext chains and sample masks are not carried over
+		//An empty fragPath builds a pipeline without a fragment stage
+		SharedPipeline Build(const PipelineConfigInfo& info, const std::string& vertPath, const std::string& fragPath);
+
+		//Blocks until every build submitted so far has finished
+		void WaitIdle();
+
+		size_t GetShaderModuleCount();
+		size_t GetPipelineCount();
+		//Build calls answered with an already requested pipeline
+		uint32_t GetSharedBuildCount();
+		size_t GetLibraryCount();
+
+	private:
+		struct BuildRequest {
+			PipelineConfigInfo m_Info;
+			std::vector<VkPipelineColorBlendAttachmentState> m_BlendAttachments;
+			std::vector<VkSpecializationMapEntry> m_SpecializationEntries;
+			std::vector<char> m_SpecializationData;
+			std::string m_VertPath;
+			std::string m_FragPath;
+		};
+
+		struct ShaderModule {
+			std::vector<char> m_Code;
+			VkShaderModule m_Module;
+		};
+
+		static void CopyConfigInfo(const PipelineConfigInfo& source, BuildRequest& request);
+		//Thread safe, the file is only read the first time a path is seen
+		VkShaderModule GetShaderModule(const std::string& path);
+		//Thread safe, parts are keyed by the state they are built from plus the shader that part compiles
+		VkPipeline GetLibrary(const BuildRequest& request, VkGraphicsPipelineLibraryFlagsEXT part, VkShaderModule vertModule, VkShaderModule fragModule);
+		std::shared_ptr<Pipeline> CreatePipeline(const BuildRequest& request);
+		void FinishBuild();
+
+		Device& m_Device;
+		JobSystem& m_JobSystem;
+
+		std::mutex m_ModuleMutex;
+		std::unordered_map<std::string, VkShaderModule> m_ModulesByPath;
+		std::unordered_multimap<uint64_t, ShaderModule> m_ModulesByHash;
+
+		std::mutex m_PipelineMutex;
+		std::unordered_map<PipelineStateKey, SharedPipeline, PipelineStateKey::Hasher> m_Pipelines;
+		uint32_t m_SharedBuilds = 0;
+
+		std::mutex m_LibraryMutex;
+		std::unordered_map<PipelineStateKey, VkPipeline, PipelineStateKey::Hasher> m_Libraries;
+
+		std::mutex m_PendingMutex;
+		std::condition_variable m_PendingCondition;
+		uint32_t m_PendingBuilds = 0;
+	};
+
+}
\ No newline at end of file
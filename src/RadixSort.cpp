@@ -0,0 +1,50 @@
+#include "RadixSort.h"
+#include <cstring>
+
+namespace Florencia {
+
+	const std::vector<uint32_t>& RadixSort::Sort(const float* keys, uint32_t count) {
+		m_Keys.resize(count);
+		m_KeysScratch.resize(count);
+		m_Indices.resize(count);
+		m_IndicesScratch.resize(count);
+
+		uint32_t histograms[4][256] = {};
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t key = FloatToSortable(keys[i]);
+			m_Keys[i] = key;
+			m_Indices[i] = i;
+			for (int pass = 0; pass < 4; pass++) { histograms[pass][(key >> (pass * 8)) & 0xFF]++; }
+		}
+
+		for (int pass = 0; pass < 4; pass++) {
+			uint32_t* histogram = histograms[pass];
+			uint32_t shift = pass * 8;
+			//Every key has the same digit, this pass would not move anything
+			if (count == 0 || histogram[(m_Keys[0] >> shift) & 0xFF] == count) { continue; }
+
+			uint32_t offset = 0;
+			for (int digit = 0; digit < 256; digit++) {
+				uint32_t digitCount = histogram[digit];
+				histogram[digit] = offset;
+				offset += digitCount;
+			}
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t destination = histogram[(m_Keys[i] >> shift) & 0xFF]++;
+				m_KeysScratch[destination] = m_Keys[i];
+				m_IndicesScratch[destination] = m_Indices[i];
+			}
+			m_Keys.swap(m_KeysScratch);
+			m_Indices.swap(m_IndicesScratch);
+		}
+		return m_Indices;
+	}
+
+	uint32_t RadixSort::FloatToSortable(float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		uint32_t mask = (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+		return bits ^ mask;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Florencia {
+
+	//Least significant digit radix sort over float keys, 8 bits per pass
+	//Stable, so equal keys keep the order they were given in, and scratch memory is kept between calls
+	class RadixSort {
+	public:
+		//Returns the indices of keys in ascending key order, valid until the next call
+		const std::vector<uint32_t>& Sort(const float* keys, uint32_t count);
+
+	private:
+		//Maps a float to an unsigned integer with the same ordering, negative values get all bits flipped
+		static uint32_t FloatToSortable(float value);
+
+		std::vector<uint32_t> m_Keys, m_KeysScratch;
+		std::vector<uint32_t> m_Indices, m_IndicesScratch;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "Registry.h"
+
+namespace Florencia {
+
+	Entity Registry::Create() {
+		if (!m_FreeIndices.empty()) {
+			uint32_t index = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+			return Entity{ index, m_Generations[index] };
+		}
+		m_Generations.push_back(0);
+		return Entity{ static_cast<uint32_t>(m_Generations.size() - 1), 0 };
+	}
+
+	void Registry::Destroy(Entity entity) {
+		if (!IsValid(entity)) { return; }
+		for (auto& pool : m_Pools) {
+			if (pool != nullptr) { pool->Remove(entity.m_Index); }
+		}
+		m_Generations[entity.m_Index]++;
+		m_FreeIndices.push_back(entity.m_Index);
+	}
+
+	bool Registry::IsValid(Entity entity) const {
+		return entity.m_Index < m_Generations.size() && m_Generations[entity.m_Index] == entity.m_Generation;
+	}
+
+}
\ No newline at end of file
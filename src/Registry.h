@@ -0,0 +1,226 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <tuple>
+#include <algorithm>
+#include <stdexcept>
+
+namespace Florencia {
+
+	//Stable handle, the generation is bumped every time an index is recycled so stale handles can be detected
+	struct Entity {
+		static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+		uint32_t m_Index = InvalidIndex;
+		uint32_t m_Generation = 0;
+
+		bool operator==(const Entity& other) const { return m_Index == other.m_Index && m_Generation == other.m_Generation; }
+		bool operator!=(const Entity& other) const { return !(*this == other); }
+	};
+
+	class ComponentPoolBase {
+	public:
+		virtual ~ComponentPoolBase() = default;
+		virtual void Remove(uint32_t index) = 0;
+		virtual bool Has(uint32_t index) const = 0;
+		virtual size_t Size() const = 0;
+		virtual const std::vector<Entity>& GetEntities() const = 0;
+	};
+
+	//Sparse set, components live contiguously in m_Components and m_Entities[i] owns m_Components[i]
+	//The sparse side is paged so rare components don't pay for a dense index table of every entity
+	template<typename T>
+	class ComponentPool : public ComponentPoolBase {
+	public:
+		template<typename... Args>
+		T& Emplace(Entity entity, Args&&... args) {
+			uint32_t& slot = SparseSlot(entity.m_Index);
+			if (slot != InvalidSlot) {
+				m_Entities[slot] = entity;
+				m_Components[slot] = T{ std::forward<Args>(args)... };
+				return m_Components[slot];
+			}
+			slot = static_cast<uint32_t>(m_Components.size());
+			m_Entities.push_back(entity);
+			m_Components.push_back(T{ std::forward<Args>(args)... });
+			return m_Components.back();
+		}
+
+		void Remove(uint32_t index) override {
+			if (!Has(index)) { return; }
+			uint32_t& slot = SparseSlot(index);
+			uint32_t last = static_cast<uint32_t>(m_Components.size() - 1);
+			if (slot != last) {
+				m_Components[slot] = std::move(m_Components[last]);
+				m_Entities[slot] = m_Entities[last];
+				SparseSlot(m_Entities[slot].m_Index) = slot;
+			}
+			slot = InvalidSlot;
+			m_Components.pop_back();
+			m_Entities.pop_back();
+		}
+
+		bool Has(uint32_t index) const override {
+			uint32_t page = index / PageSize;
+			if (page >= m_Sparse.size() || m_Sparse[page] == nullptr) { return false; }
+			return m_Sparse[page][index % PageSize] != InvalidSlot;
+		}
+
+		T& Get(uint32_t index) { return m_Components[m_Sparse[index / PageSize][index % PageSize]]; }
+		const T& Get(uint32_t index) const { return m_Components[m_Sparse[index / PageSize][index % PageSize]]; }
+
+		size_t Size() const override { return m_Components.size(); }
+		const std::vector<Entity>& GetEntities() const override { return m_Entities; }
+		std::vector<T>& GetComponents() { return m_Components; }
+
+	private:
+		static constexpr uint32_t PageSize = 4096;
+		static constexpr uint32_t InvalidSlot = std::numeric_limits<uint32_t>::max();
+
+		uint32_t& SparseSlot(uint32_t index) {
+			uint32_t page = index / PageSize;
+			if (page >= m_Sparse.size()) { m_Sparse.resize(page + 1); }
+			if (m_Sparse[page] == nullptr) {
+				m_Sparse[page] = std::make_unique<uint32_t[]>(PageSize);
+				std::fill(m_Sparse[page].get(), m_Sparse[page].get() + PageSize, InvalidSlot);
+			}
+			return m_Sparse[page][index % PageSize];
+		}
+
+		std::vector<std::unique_ptr<uint32_t[]>> m_Sparse;
+		std::vector<Entity> m_Entities;
+		std::vector<T> m_Components;
+	};
+
+	//Iterates every entity that has all of Ts, driven by the smallest pool so sparse components stay cheap to query
+	template<typename... Ts>
+	class View {
+	public:
+		View(ComponentPool<Ts>*... pools) : m_Pools{ pools... } {}
+
+		template<typename Func>
+		void Each(Func&& func) {
+			if (!AllPoolsExist()) { return; }
+			const std::vector<Entity>& entities = SmallestPool()->GetEntities();
+			for (size_t i = 0; i < entities.size(); i++) {
+				Entity entity = entities[i];
+				if (HasAll(entity.m_Index)) { func(entity, std::get<ComponentPool<Ts>*>(m_Pools)->Get(entity.m_Index)...); }
+			}
+		}
+
+		//Upper bound on the number of entities Each will visit
+		size_t SizeHint() const {
+			if (!AllPoolsExist()) { return 0; }
+			return SmallestPool()->Size();
+		}
+
+	private:
+		bool AllPoolsExist() const { return ((std::get<ComponentPool<Ts>*>(m_Pools) != nullptr) && ...); }
+		bool HasAll(uint32_t index) const { return (std::get<ComponentPool<Ts>*>(m_Pools)->Has(index) && ...); }
+
+		const ComponentPoolBase* SmallestPool() const {
+			const ComponentPoolBase* smallest = nullptr;
+			((smallest = (smallest == nullptr || std::get<ComponentPool<Ts>*>(m_Pools)->Size() < smallest->Size()) ? std::get<ComponentPool<Ts>*>(m_Pools) : smallest), ...);
+			return smallest;
+		}
+
+		std::tuple<ComponentPool<Ts>*...> m_Pools;
+	};
+
+	//Single component views walk the dense array directly
+	template<typename T>
+	class View<T> {
+	public:
+		View(ComponentPool<T>* pool) : m_Pool{ pool } {}
+
+		template<typename Func>
+		void Each(Func&& func) {
+			if (m_Pool == nullptr) { return; }
+			const std::vector<Entity>& entities = m_Pool->GetEntities();
+			std::vector<T>& components = m_Pool->GetComponents();
+			for (size_t i = 0; i < components.size(); i++) { func(entities[i], components[i]); }
+		}
+
+		size_t SizeHint() const { return m_Pool == nullptr ? 0 : m_Pool->Size(); }
+
+	private:
+		ComponentPool<T>* m_Pool;
+	};
+
+	class Registry {
+	public:
+		Registry() = default;
+
+		Registry(const Registry&) = delete;
+		Registry& operator=(const Registry&) = delete;
+
+		Entity Create();
+		void Destroy(Entity entity);
+		bool IsValid(Entity entity) const;
+		size_t Size() const { return m_Generations.size() - m_FreeIndices.size(); }
+
+		template<typename T, typename... Args>
+		T& Emplace(Entity entity, Args&&... args) {
+			if (!IsValid(entity)) { throw std::runtime_error("Cannot Add Component To Invalid Entity"); }
+			return GetOrCreatePool<T>().Emplace(entity, std::forward<Args>(args)...);
+		}
+
+		template<typename T>
+		void Remove(Entity entity) {
+			if (auto pool = FindPool<T>(); pool && IsValid(entity)) { pool->Remove(entity.m_Index); }
+		}
+
+		template<typename T>
+		bool Has(Entity entity) const {
+			auto pool = FindPool<T>();
+			return pool && IsValid(entity) && pool->Has(entity.m_Index);
+		}
+
+		template<typename T>
+		T& Get(Entity entity) {
+			if (!Has<T>(entity)) { throw std::runtime_error("Entity Does Not Have Requested Component"); }
+			return FindPool<T>()->Get(entity.m_Index);
+		}
+
+		template<typename T>
+		T* TryGet(Entity entity) { return Has<T>(entity) ? &FindPool<T>()->Get(entity.m_Index) : nullptr; }
+
+		template<typename... Ts>
+		View<Ts...> Query() { return View<Ts...>(FindPool<Ts>()...); }
+
+	private:
+		static uint32_t NextComponentID() {
+			static uint32_t nextID = 0;
+			return nextID++;
+		}
+
+		template<typename T>
+		static uint32_t ComponentID() {
+			static const uint32_t id = NextComponentID();
+			return id;
+		}
+
+		template<typename T>
+		ComponentPool<T>* FindPool() const {
+			uint32_t id = ComponentID<T>();
+			if (id >= m_Pools.size()) { return nullptr; }
+			return static_cast<ComponentPool<T>*>(m_Pools[id].get());
+		}
+
+		template<typename T>
+		ComponentPool<T>& GetOrCreatePool() {
+			uint32_t id = ComponentID<T>();
+			if (id >= m_Pools.size()) { m_Pools.resize(id + 1); }
+			if (m_Pools[id] == nullptr) { m_Pools[id] = std::make_unique<ComponentPool<T>>(); }
+			return *static_cast<ComponentPool<T>*>(m_Pools[id].get());
+		}
+
+		std::vector<std::unique_ptr<ComponentPoolBase>> m_Pools;
+		std::vector<uint32_t> m_Generations;
+		std::vector<uint32_t> m_FreeIndices;
+	};
+
+}
\ No newline at end of file
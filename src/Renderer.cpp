@@ -1,24 +1,58 @@
 #include "Renderer.h"
 #include <stdexcept>
+#include <iostream>
 #include <array>
+#include <algorithm>
+
+#include "CpuProfiler.h"
 
 namespace Florencia {
 
-	Renderer::Renderer(Window& window, Device& device) :m_Window(window), m_Device(device) {
-		RecreateSwapchain();
+	Renderer::Renderer(Window& window, Device& device, const SwapChainProps& props)
+		:m_Window(window), m_Device(device), m_RenderPath(props.Path), m_DynamicRendering(props.DynamicRendering), m_PresentPolicy(props.Present), m_FramesInFlight(props.FramesInFlight) {
+		//The deferred path reads the g-buffer as subpass input attachments, which needs a render pass
+		if (m_DynamicRendering && m_RenderPath == RenderPath::Deferred) throw std::runtime_error("Dynamic Rendering Requires The Forward Render Path");
+		if (m_DynamicRendering && !m_Device.SupportsDynamicRendering()) {
+			std::cout << "Dynamic Rendering: Unsupported, Using A Render Pass\n";
+			m_DynamicRendering = false;
+		}
+		if (!RecreateSwapchain()) throw std::runtime_error("Cannot Create A Swapchain For A Window With No Area");
 		CreateCommandBuffers();
 	}
 
-	Renderer::~Renderer() { FreeCommandBuffers(); }
+	Renderer::~Renderer() {
+		if (m_FrameCapture != nullptr) {
+			m_Device.WaitForValue(m_Device.GetLastSubmittedValue());
+			m_FrameCapture->WriteAll();
+		}
+		FreeCommandBuffers();
+	}
+
+	void Renderer::CaptureFrames(const std::string& pathPrefix) {
+		//Swapchain images can't be copied from, the offscreen targets are left in TRANSFER_SRC_OPTIMAL for this
+		if (!IsHeadless()) throw std::runtime_error("Frame Capture Requires A Headless Window");
+		m_FrameCapture = std::make_unique<FrameCapture>(m_Device, m_FramesInFlight, pathPrefix);
+	}
+
+	void Renderer::WaitForFrame() {
+		FLORENCIA_PROFILE_SCOPE("Renderer::WaitForFrame");
+		if (m_FrameStarted) throw std::runtime_error("Cannot Wait For A Frame While One Is Started");
+		m_SwapChain->waitForFrame();
+	}
 
 	VkCommandBuffer Renderer::BeginFrame() {
+		FLORENCIA_PROFILE_SCOPE("Renderer::BeginFrame");
 		if (m_FrameStarted) throw std::runtime_error("Cannot Begin A Frame While One Is Already Started");
+		if (m_SwapChainOutOfDate && !RecreateSwapchain()) return nullptr;
 		VkResult result = m_SwapChain->acquireNextImage(&m_CurrentImageIndex);
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
 			RecreateSwapchain();
 			return nullptr;
 		}
 		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) throw std::runtime_error("Failed to Aquire Next SwapChain Image");
+		ReleaseRetiredSwapChains();
+		//The acquire waited for this slot's last frame, so its copy is complete
+		if (m_FrameCapture != nullptr) m_FrameCapture->Write(m_CurrentFrameIndex);
 
 		m_FrameStarted = true;
 
@@ -30,8 +64,12 @@ namespace Florencia {
 	}
 
 	void Renderer::EndFrame() {
+		FLORENCIA_PROFILE_SCOPE("Renderer::EndFrame");
 		if (!m_FrameStarted) throw std::runtime_error("Cannot End A Frame While One Is Not Started");
 		VkCommandBuffer commandBuffer = GetCurrentCommandBuffer();
+		if (m_FrameCapture != nullptr) {
+			m_FrameCapture->Record(commandBuffer, m_CurrentFrameIndex, m_SwapChain->getImage(m_CurrentImageIndex), m_SwapChain->getSwapChainExtent(), m_SwapChain->getSwapChainImageFormat());
+		}
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) throw std::runtime_error("Failed to Record Command Buffer");
 
 		VkResult result = m_SwapChain->submitCommandBuffers(&commandBuffer, &m_CurrentImageIndex);
@@ -42,28 +80,33 @@ namespace Florencia {
 		else if (result != VK_SUCCESS) throw std::runtime_error("Failed to Present SwapChain Image");
 
 		m_FrameStarted = false;
-		m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+		m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % m_FramesInFlight;
 	}
 
 	void Renderer::BeginSwapChainRenderPass(VkCommandBuffer buffer) {
 		if (!m_FrameStarted) throw std::runtime_error("Can't Call BeginSwapChainRenderPass If No Frame Is Started");
 		if (buffer != GetCurrentCommandBuffer()) throw std::runtime_error("Can't Call BeginSwapChainRenderPass On Command Buffer From Different Frame");
 
-		VkRenderPassBeginInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = m_SwapChain->getRenderPass();
-		renderPassInfo.framebuffer = m_SwapChain->getFrameBuffer(m_CurrentImageIndex);
+		if (m_DynamicRendering) BeginDynamicRendering(buffer);
+		else {
+			VkRenderPassBeginInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = m_SwapChain->getRenderPass();
+			renderPassInfo.framebuffer = m_SwapChain->getFrameBuffer(m_CurrentImageIndex);
 
-		renderPassInfo.renderArea.offset = { 0, 0 };
-		renderPassInfo.renderArea.extent = m_SwapChain->getSwapChainExtent();
+			renderPassInfo.renderArea.offset = { 0, 0 };
+			renderPassInfo.renderArea.extent = m_SwapChain->getSwapChainExtent();
 
-		std::array<VkClearValue, 2> clearValues{};
-		clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
-		clearValues[1].depthStencil = { 1.0f, 0 };
-		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-		renderPassInfo.pClearValues = clearValues.data();
+			std::array<VkClearValue, 4> clearValues{};
+			clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+			clearValues[1].depthStencil = { 1.0f, 0 };
+			clearValues[2].color = { 0.0f, 0.0f, 0.0f, 0.0f };
+			clearValues[3].color = { 0.0f, 0.0f, 0.0f, 0.0f };
+			renderPassInfo.clearValueCount = m_RenderPath == RenderPath::Deferred ? 4 : 2;
+			renderPassInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+			vkCmdBeginRenderPass(buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		}
 
 		VkViewport viewport{};
 		viewport.x = 0.0f;
@@ -77,15 +120,99 @@ namespace Florencia {
 		vkCmdSetScissor(buffer, 0, 1, &scissor);
 	}
 
+	void Renderer::NextSubpass(VkCommandBuffer buffer) {
+		if (!m_FrameStarted) throw std::runtime_error("Can't Call NextSubpass If No Frame Is Started");
+		if (buffer != GetCurrentCommandBuffer()) throw std::runtime_error("Can't Call NextSubpass On Command Buffer From Different Frame");
+		if (m_DynamicRendering) throw std::runtime_error("Can't Call NextSubpass With Dynamic Rendering");
+
+		vkCmdNextSubpass(buffer, VK_SUBPASS_CONTENTS_INLINE);
+	}
+
 	void Renderer::EndSwapChainRenderPass(VkCommandBuffer buffer) {
 		if (!m_FrameStarted) throw std::runtime_error("Can't Call EndSwapChainRenderPass If No Frame Is Started");
 		if (buffer != GetCurrentCommandBuffer()) throw std::runtime_error("Can't Call EndSwapChainRenderPass On Command Buffer From Different Frame");
 
-		vkCmdEndRenderPass(buffer);
+		if (m_DynamicRendering) EndDynamicRendering(buffer);
+		else vkCmdEndRenderPass(buffer);
+	}
+
+	//Does what the forward render pass does through its layouts and external dependency, the depth ends up in the
+	//same DEPTH_STENCIL_ATTACHMENT_OPTIMAL layout so occlusion readback works the same on both
+	void Renderer::BeginDynamicRendering(VkCommandBuffer buffer) {
+		VkFormat depthFormat = m_SwapChain->getDepthFormat();
+		VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || depthFormat == VK_FORMAT_D24_UNORM_S8_UINT) depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+
+		std::array<VkImageMemoryBarrier, 2> barriers{};
+		barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barriers[0].srcAccessMask = 0;
+		barriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].image = m_SwapChain->getImage(m_CurrentImageIndex);
+		barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+		//The previous frame on this image may still be testing against or reducing the depth
+		barriers[1] = barriers[0];
+		barriers[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barriers[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		barriers[1].image = m_SwapChain->getDepthImage(m_CurrentImageIndex);
+		barriers[1].subresourceRange.aspectMask = depthAspect;
+
+		vkCmdPipelineBarrier(buffer,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+		VkRenderingAttachmentInfoKHR colorAttachment{};
+		colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+		colorAttachment.imageView = m_SwapChain->getImageView(m_CurrentImageIndex);
+		colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.clearValue.color = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+		VkRenderingAttachmentInfoKHR depthAttachment{};
+		depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+		depthAttachment.imageView = m_SwapChain->getDepthImageView(m_CurrentImageIndex);
+		depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		//Stored so the depth can be read back for occlusion culling
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		depthAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+		VkRenderingInfoKHR renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+		renderingInfo.renderArea.offset = { 0, 0 };
+		renderingInfo.renderArea.extent = m_SwapChain->getSwapChainExtent();
+		renderingInfo.layerCount = 1;
+		renderingInfo.colorAttachmentCount = 1;
+		renderingInfo.pColorAttachments = &colorAttachment;
+		renderingInfo.pDepthAttachment = &depthAttachment;
+		m_Device.CmdBeginRendering(buffer, &renderingInfo);
+	}
+
+	void Renderer::EndDynamicRendering(VkCommandBuffer buffer) {
+		m_Device.CmdEndRendering(buffer);
+
+		VkImageMemoryBarrier toPresent{};
+		toPresent.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toPresent.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		toPresent.dstAccessMask = 0;
+		toPresent.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		toPresent.newLayout = m_SwapChain->getFinalColorLayout();
+		toPresent.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toPresent.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toPresent.image = m_SwapChain->getImage(m_CurrentImageIndex);
+		toPresent.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vkCmdPipelineBarrier(buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &toPresent);
 	}
 
 	void Renderer::CreateCommandBuffers() {
-		m_CommandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+		m_CommandBuffers.resize(m_FramesInFlight);
 		VkCommandBufferAllocateInfo allocateInfo{};
 		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -102,20 +229,29 @@ namespace Florencia {
 		m_CommandBuffers.clear();
 	}
 
-	void Renderer::RecreateSwapchain() {
+	//Returns false while the window has no area, the swapchain is then recreated by the first BeginFrame after it has one again
+	bool Renderer::RecreateSwapchain() {
 		auto extent = m_Window.GetExtent();
-		while (extent.width == 0 || extent.height == 0) {
-			extent = m_Window.GetExtent();
-			glfwWaitEvents();
-		}
-		vkDeviceWaitIdle(m_Device.Get());
-		if (m_SwapChain == nullptr) m_SwapChain = std::make_unique<SwapChain>(m_Device, extent);
+		m_SwapChainOutOfDate = extent.width == 0 || extent.height == 0;
+		if (m_SwapChainOutOfDate) return false;
+
+		if (m_SwapChain == nullptr) m_SwapChain = std::make_unique<SwapChain>(m_Device, extent, SwapChainProps{ m_RenderPath, m_DynamicRendering, m_PresentPolicy, m_FramesInFlight });
 		else {
+			//No vkDeviceWaitIdle, frames still in flight keep rendering to the old swapchain until it is released
 			std::shared_ptr<SwapChain> oldSwapChain = std::move(m_SwapChain);
 			m_SwapChain = std::make_unique<SwapChain>(m_Device, extent, oldSwapChain);
 
 			if (!oldSwapChain->compareSwapFormats(*m_SwapChain.get())) throw std::runtime_error("Swap chain image(or depth) format has changed!");
+			m_RetiredSwapChains.push_back({ std::move(oldSwapChain), m_Device.GetLastSubmittedValue() });
+			m_SwapChainRecreations++;
 		}
+		return true;
+	}
+
+	//Called once per frame after the acquire, when presentation on the new swapchain has started
+	void Renderer::ReleaseRetiredSwapChains() {
+		auto completed = [&](const RetiredSwapChain& retired) { return m_Device.IsComplete(retired.m_LastUseValue); };
+		m_RetiredSwapChains.erase(std::remove_if(m_RetiredSwapChains.begin(), m_RetiredSwapChains.end(), completed), m_RetiredSwapChains.end());
 	}
 
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <memory>
 #include "SwapChain.h"
+#include "FrameCapture.h"
+#include "Pipeline.h"
 #include "Window.h"
 #include "Device.h"
 
@@ -8,16 +10,50 @@ namespace Florencia {
 
 	class Renderer {
 	public:
-		Renderer(Window& window, Device& device);
+		//Dynamic rendering is forward only and falls back to a render pass when the device doesn't support it
+		Renderer(Window& window, Device& device, const SwapChainProps& props = SwapChainProps{});
 		~Renderer();
 
 		Renderer(const Renderer&) = delete;
 		Renderer& operator=(const Renderer&) = delete;
 
 		VkRenderPass GetSwapChainRenderPass() const { return m_SwapChain->getRenderPass(); }
+		//What pipelines drawing to the swapchain are built against, valid across swapchain recreation
+		RenderTargetInfo GetSwapChainRenderTarget() const { return { m_SwapChain->getRenderPass(), m_SwapChain->getSwapChainImageFormat(), m_SwapChain->getDepthFormat() }; }
+		bool UsesDynamicRendering() const { return m_DynamicRendering; }
 		bool IsFrameInProgress() const { return m_FrameStarted; }
+		uint32_t GetSwapChainRecreationCount() const { return m_SwapChainRecreations; }
+		//Present ids only identify a present together with the recreation count they were taken at
+		uint64_t GetLastPresentId() const { return m_SwapChain->lastPresentId(); }
+		VkResult WaitForPresent(uint64_t presentId, uint64_t timeout) { return m_SwapChain->waitForPresent(presentId, timeout); }
+		size_t GetRetiredSwapChainCount() const { return m_RetiredSwapChains.size(); }
+		bool IsHeadless() const { return m_SwapChain->isHeadless(); }
+		//Headless only, every frame ended from now on is written out as <pathPrefix><frame number>.ppm
+		void CaptureFrames(const std::string& pathPrefix);
+		uint32_t GetCapturedFrameCount() const { return m_FrameCapture == nullptr ? 0 : m_FrameCapture->GetWrittenFrameCount(); }
 
 		float GetAspectRatio() const { return m_SwapChain->extentAspectRatio(); }
+		VkExtent2D GetSwapChainExtent() const { return m_SwapChain->getSwapChainExtent(); }
+		VkFormat GetDepthFormat() const { return m_SwapChain->getDepthFormat(); }
+		RenderPath GetRenderPath() const { return m_RenderPath; }
+		//Every per-frame resource is indexed by GetFrameIndex and needs this many copies
+		uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+
+		VkImage GetCurrentDepthImage() const {
+			if (!m_FrameStarted) throw std::runtime_error("Cannot Get Depth Image When Frame Not Started");
+			return m_SwapChain->getDepthImage(m_CurrentImageIndex);
+		}
+
+		//Depth aspect only, the image can be sampled once it is in a read only layout
+		VkImageView GetCurrentDepthImageView() const {
+			if (!m_FrameStarted) throw std::runtime_error("Cannot Get Depth Image View When Frame Not Started");
+			return m_SwapChain->getDepthImageView(m_CurrentImageIndex);
+		}
+
+		GBufferViews GetCurrentGBufferViews() const {
+			if (!m_FrameStarted) throw std::runtime_error("Cannot Get G-Buffer When Frame Not Started");
+			return m_SwapChain->getGBufferViews(m_CurrentImageIndex);
+		}
 
 		VkCommandBuffer GetCurrentCommandBuffer() const {
 			if (!m_FrameStarted) throw std::runtime_error("Cannot Get Command Buffer When Frame Not Started");
@@ -29,20 +65,41 @@ namespace Florencia {
 			return m_CurrentFrameIndex;
 		}
 
+		//Blocks until the gpu is done with the next frame's resources, so BeginFrame only waits for the presentation engine
+		void WaitForFrame();
+		//Returns nullptr when no frame can be rendered, while the window is minimized or right after the swapchain was recreated
 		VkCommandBuffer BeginFrame();
 		void EndFrame();
 
 		void BeginSwapChainRenderPass(VkCommandBuffer buffer);
+		void NextSubpass(VkCommandBuffer buffer);
 		void EndSwapChainRenderPass(VkCommandBuffer buffer);
 	private:
 		void CreateCommandBuffers();
 		void FreeCommandBuffers();
-		void RecreateSwapchain();
+		bool RecreateSwapchain();
+		void ReleaseRetiredSwapChains();
+		void BeginDynamicRendering(VkCommandBuffer buffer);
+		void EndDynamicRendering(VkCommandBuffer buffer);
 
 		Window& m_Window;
 		Device& m_Device;
+		RenderPath m_RenderPath;
+		bool m_DynamicRendering;
+		PresentPolicy m_PresentPolicy;
+		uint32_t m_FramesInFlight;
 		std::unique_ptr<SwapChain> m_SwapChain;
 		std::vector<VkCommandBuffer> m_CommandBuffers;
+		std::unique_ptr<FrameCapture> m_FrameCapture;
+
+		//Swapchains replaced by a resize, destroyed once the timeline reaches the last submission made before the replacement
+		struct RetiredSwapChain {
+			std::shared_ptr<SwapChain> m_SwapChain;
+			uint64_t m_LastUseValue;
+		};
+		std::vector<RetiredSwapChain> m_RetiredSwapChains;
+		uint32_t m_SwapChainRecreations = 0;
+		bool m_SwapChainOutOfDate = false;
 
 		bool m_FrameStarted{ false };
 		int m_CurrentFrameIndex{ 0 };
@@ -0,0 +1,73 @@
+#include "ShaderVariant.h"
+#include <cstring>
+
+#include "GameObject.h"
+
+namespace Florencia {
+
+	SpecializationConstants& SpecializationConstants::Set(uint32_t constantID, uint32_t value) {
+		for (auto& entry : m_Entries) {
+			if (entry.constantID == constantID) {
+				m_Data[entry.offset / sizeof(uint32_t)] = value;
+				return *this;
+			}
+		}
+		m_Entries.push_back({ constantID, static_cast<uint32_t>(m_Data.size() * sizeof(uint32_t)), sizeof(uint32_t) });
+		m_Data.push_back(value);
+		return *this;
+	}
+
+	SpecializationConstants& SpecializationConstants::Set(uint32_t constantID, float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return Set(constantID, bits);
+	}
+
+	SpecializationConstants& SpecializationConstants::Set(uint32_t constantID, bool value) { return Set(constantID, static_cast<uint32_t>(value ? VK_TRUE : VK_FALSE)); }
+
+	VkSpecializationInfo SpecializationConstants::GetInfo() const {
+		VkSpecializationInfo info{};
+		info.mapEntryCount = static_cast<uint32_t>(m_Entries.size());
+		info.pMapEntries = m_Entries.data();
+		info.dataSize = m_Data.size() * sizeof(uint32_t);
+		info.pData = m_Data.data();
+		return info;
+	}
+
+	WorldShaderVariant WorldShaderVariant::FromMaterial(const MaterialComponent* material) {
+		WorldShaderVariant variant{};
+		if (material == nullptr) { return variant; }
+		variant.m_Lit = material->m_Lit;
+		variant.m_Specular = material->m_Lit && material->m_Specular;
+		variant.m_Shininess = variant.m_Specular ? material->m_Shininess : 0.0f;
+		return variant;
+	}
+
+	uint64_t WorldShaderVariant::Key() const {
+		uint32_t shininessBits;
+		std::memcpy(&shininessBits, &m_Shininess, sizeof(shininessBits));
+		return static_cast<uint64_t>(m_Lit) | static_cast<uint64_t>(m_Specular) << 1 | static_cast<uint64_t>(shininessBits) << 2;
+	}
+
+	SpecializationConstants WorldShaderVariant::Constants() const {
+		SpecializationConstants constants{};
+		constants.Set(Lit, m_Lit).Set(Specular, m_Specular).Set(Shininess, m_Shininess);
+		return constants;
+	}
+
+	void PipelineVariantCache::Prepare(uint64_t key, const BuildFunc& build) {
+		if (m_Pipelines.find(key) == m_Pipelines.end()) { m_Pipelines.emplace(key, build()); }
+	}
+
+	Pipeline& PipelineVariantCache::Get(uint64_t key, const BuildFunc& build) {
+		auto it = m_Pipelines.find(key);
+		if (it == m_Pipelines.end()) { it = m_Pipelines.emplace(key, build()).first; }
+		return it->second.Get();
+	}
+
+	Pipeline* PipelineVariantCache::Find(uint64_t key) {
+		auto it = m_Pipelines.find(key);
+		return it == m_Pipelines.end() ? nullptr : &it->second.Get();
+	}
+
+}
\ No newline at end of file
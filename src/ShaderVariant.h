@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "PipelineBuilder.h"
+
+namespace Florencia {
+
+	struct MaterialComponent;
+
+	//Owns the data a VkSpecializationInfo points at, every constant is 32 bits so bools and floats share one layout
+	class SpecializationConstants {
+	public:
+		SpecializationConstants& Set(uint32_t constantID, uint32_t value);
+		SpecializationConstants& Set(uint32_t constantID, float value);
+		SpecializationConstants& Set(uint32_t constantID, bool value);
+
+		//Only valid while this object is alive and unchanged
+		VkSpecializationInfo GetInfo() const;
+
+	private:
+		std::vector<VkSpecializationMapEntry> m_Entries;
+		std::vector<uint32_t> m_Data;
+	};
+
+	//Constant ids match the constant_id layouts in World.frag
+	struct WorldShaderVariant {
+		enum ConstantID : uint32_t { Lit = 0, Specular = 1, Shininess = 2 };
+
+		bool m_Lit = true;
+		bool m_Specular = true;
+		float m_Shininess = 32.0f;
+
+		//Cheapest variant that renders the material, unused features are folded away so equivalent materials share a key
+		static WorldShaderVariant FromMaterial(const MaterialComponent* material);
+
+		uint64_t Key() const;
+		SpecializationConstants Constants() const;
+	};
+
+	//Pipelines built on first request for a variant key and kept for the lifetime of the cache
+	class PipelineVariantCache {
+	public:
+		using BuildFunc = std::function<SharedPipeline()>;
+
+		//Starts building the variant without waiting for it
+		void Prepare(uint64_t key, const BuildFunc& build);
+		Pipeline& Get(uint64_t key, const BuildFunc& build);
+		//nullptr when the variant hasn't been requested yet, lets callers skip building a BuildFunc every frame
+		Pipeline* Find(uint64_t key);
+		size_t Size() const { return m_Pipelines.size(); }
+
+	private:
+		std::unordered_map<uint64_t, PendingPipeline> m_Pipelines;
+	};
+
+}
\ No newline at end of file
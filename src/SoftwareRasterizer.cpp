@@ -0,0 +1,199 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#ifdef FLORENCIA_RASTERIZER_SSE
+	#include <emmintrin.h>
+#endif
+
+namespace Florencia {
+
+	namespace {
+
+		//Edge a to b as a * x + b * y + c, positive on the left for counter clockwise triangles
+		glm::vec3 EdgeFunction(const glm::vec3& a, const glm::vec3& b) {
+			return { a.y - b.y, b.x - a.x, a.x * b.y - a.y * b.x };
+		}
+
+	}
+
+	SoftwareRasterizer::SoftwareRasterizer(uint32_t width, uint32_t height) {
+		m_TilesX = std::max(1u, (width + TileWidth - 1) / TileWidth);
+		m_TilesY = std::max(1u, (height + TileHeight - 1) / TileHeight);
+		m_Width = m_TilesX * TileWidth;
+		m_Height = m_TilesY * TileHeight;
+		m_Depth.resize(static_cast<size_t>(m_Width) * m_Height, 1.0f);
+		m_Bins.resize(static_cast<size_t>(m_TilesX) * m_TilesY);
+	}
+
+	void SoftwareRasterizer::Begin(const glm::mat4& viewProjection) {
+		m_ViewProjection = viewProjection;
+		std::fill(m_Depth.begin(), m_Depth.end(), 1.0f);
+		m_Triangles.clear();
+		for (auto& bin : m_Bins) { bin.clear(); }
+	}
+
+	void SoftwareRasterizer::AddOccluder(const glm::vec3* vertices, const uint32_t* indices, uint32_t indexCount, const glm::mat4& modelMatrix) {
+		glm::mat4 modelViewProjection = m_ViewProjection * modelMatrix;
+		for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+			glm::vec3 screen[3];
+			bool clipped = false;
+			for (int v = 0; v < 3; v++) {
+				glm::vec4 clip = modelViewProjection * glm::vec4(vertices[indices[i + v]], 1.0f);
+				if (clip.w <= 1e-5f || clip.z < 0.0f) {
+					clipped = true;
+					break;
+				}
+				glm::vec3 ndc = glm::vec3(clip) / clip.w;
+				screen[v] = { (ndc.x * 0.5f + 0.5f) * m_Width, (ndc.y * 0.5f + 0.5f) * m_Height, ndc.z };
+			}
+			if (clipped) { continue; }
+
+			//Occluders are rasterized double sided, winding is normalized so inside is always positive
+			glm::vec3 edge = EdgeFunction(screen[0], screen[1]);
+			float area = edge.x * screen[2].x + edge.y * screen[2].y + edge.z;
+			if (area < 0.0f) {
+				std::swap(screen[1], screen[2]);
+				area = -area;
+			}
+			if (area < 1e-6f) { continue; }
+
+			Triangle triangle{};
+			triangle.m_MinX = std::max(0, static_cast<int32_t>(std::ceil(std::min({ screen[0].x, screen[1].x, screen[2].x }) - 0.5f)));
+			triangle.m_MinY = std::max(0, static_cast<int32_t>(std::ceil(std::min({ screen[0].y, screen[1].y, screen[2].y }) - 0.5f)));
+			triangle.m_MaxX = std::min(static_cast<int32_t>(m_Width) - 1, static_cast<int32_t>(std::floor(std::max({ screen[0].x, screen[1].x, screen[2].x }) - 0.5f)));
+			triangle.m_MaxY = std::min(static_cast<int32_t>(m_Height) - 1, static_cast<int32_t>(std::floor(std::max({ screen[0].y, screen[1].y, screen[2].y }) - 0.5f)));
+			if (triangle.m_MinX > triangle.m_MaxX || triangle.m_MinY > triangle.m_MaxY) { continue; }
+
+			triangle.m_Edges[0] = EdgeFunction(screen[1], screen[2]);
+			triangle.m_Edges[1] = EdgeFunction(screen[2], screen[0]);
+			triangle.m_Edges[2] = EdgeFunction(screen[0], screen[1]);
+			triangle.m_Depth = (triangle.m_Edges[0] * screen[0].z + triangle.m_Edges[1] * screen[1].z + triangle.m_Edges[2] * screen[2].z) / area;
+
+			uint32_t index = static_cast<uint32_t>(m_Triangles.size());
+			m_Triangles.push_back(triangle);
+			for (uint32_t ty = triangle.m_MinY / TileHeight; ty <= triangle.m_MaxY / TileHeight; ty++) {
+				for (uint32_t tx = triangle.m_MinX / TileWidth; tx <= triangle.m_MaxX / TileWidth; tx++) { m_Bins[ty * m_TilesX + tx].push_back(index); }
+			}
+		}
+	}
+
+	void SoftwareRasterizer::Rasterize(JobSystem* jobs) {
+		uint32_t tileCount = static_cast<uint32_t>(m_Bins.size());
+		if (jobs == nullptr) {
+			for (uint32_t tile = 0; tile < tileCount; tile++) { RasterizeTile(tile); }
+			return;
+		}
+		jobs->ParallelFor(tileCount, 4, [this](uint32_t begin, uint32_t end) {
+			for (uint32_t tile = begin; tile < end; tile++) { RasterizeTile(tile); }
+		});
+	}
+
+	void SoftwareRasterizer::RasterizeTile(uint32_t tile) {
+		const std::vector<uint32_t>& bin = m_Bins[tile];
+		if (bin.empty()) { return; }
+
+		int32_t tileX = static_cast<int32_t>((tile % m_TilesX) * TileWidth);
+		int32_t tileY = static_cast<int32_t>((tile / m_TilesX) * TileHeight);
+		float* tileDepth = m_Depth.data() + static_cast<size_t>(tile) * TileWidth * TileHeight;
+
+		for (uint32_t index : bin) {
+			const Triangle& triangle = m_Triangles[index];
+			//Columns are walked four at a time, the extra pixels just fail the edge tests
+			int32_t x0 = (std::max(triangle.m_MinX, tileX) - tileX) & ~3;
+			int32_t x1 = std::min(triangle.m_MaxX, tileX + static_cast<int32_t>(TileWidth) - 1) - tileX;
+			int32_t y0 = std::max(triangle.m_MinY, tileY) - tileY;
+			int32_t y1 = std::min(triangle.m_MaxY, tileY + static_cast<int32_t>(TileHeight) - 1) - tileY;
+
+#ifdef FLORENCIA_RASTERIZER_SSE
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 columnOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 edge0X = _mm_set1_ps(triangle.m_Edges[0].x);
+			const __m128 edge1X = _mm_set1_ps(triangle.m_Edges[1].x);
+			const __m128 edge2X = _mm_set1_ps(triangle.m_Edges[2].x);
+			const __m128 depthX = _mm_set1_ps(triangle.m_Depth.x);
+			for (int32_t y = y0; y <= y1; y++) {
+				float pixelY = static_cast<float>(tileY + y) + 0.5f;
+				const __m128 row0 = _mm_set1_ps(triangle.m_Edges[0].y * pixelY + triangle.m_Edges[0].z);
+				const __m128 row1 = _mm_set1_ps(triangle.m_Edges[1].y * pixelY + triangle.m_Edges[1].z);
+				const __m128 row2 = _mm_set1_ps(triangle.m_Edges[2].y * pixelY + triangle.m_Edges[2].z);
+				const __m128 rowDepth = _mm_set1_ps(triangle.m_Depth.y * pixelY + triangle.m_Depth.z);
+				float* row = tileDepth + y * TileWidth;
+				for (int32_t x = x0; x <= x1; x += 4) {
+					__m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(tileX + x)), columnOffsets);
+					__m128 w0 = _mm_add_ps(_mm_mul_ps(edge0X, pixelX), row0);
+					__m128 w1 = _mm_add_ps(_mm_mul_ps(edge1X, pixelX), row1);
+					__m128 w2 = _mm_add_ps(_mm_mul_ps(edge2X, pixelX), row2);
+					__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+					if (_mm_movemask_ps(inside) == 0) { continue; }
+
+					__m128 depth = _mm_add_ps(_mm_mul_ps(depthX, pixelX), rowDepth);
+					__m128 current = _mm_loadu_ps(row + x);
+					__m128 nearest = _mm_min_ps(current, depth);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+				}
+			}
+#else
+			for (int32_t y = y0; y <= y1; y++) {
+				float pixelY = static_cast<float>(tileY + y) + 0.5f;
+				float* row = tileDepth + y * TileWidth;
+				for (int32_t x = x0; x <= x1; x++) {
+					float pixelX = static_cast<float>(tileX + x) + 0.5f;
+					if (triangle.m_Edges[0].x * pixelX + triangle.m_Edges[0].y * pixelY + triangle.m_Edges[0].z < 0.0f) { continue; }
+					if (triangle.m_Edges[1].x * pixelX + triangle.m_Edges[1].y * pixelY + triangle.m_Edges[1].z < 0.0f) { continue; }
+					if (triangle.m_Edges[2].x * pixelX + triangle.m_Edges[2].y * pixelY + triangle.m_Edges[2].z < 0.0f) { continue; }
+					float depth = triangle.m_Depth.x * pixelX + triangle.m_Depth.y * pixelY + triangle.m_Depth.z;
+					row[x] = std::min(row[x], depth);
+				}
+			}
+#endif
+		}
+	}
+
+	bool SoftwareRasterizer::IsOccluded(const AABB& worldBounds) const {
+		if (m_Triangles.empty() || !worldBounds.IsValid()) { return false; }
+
+		glm::vec2 screenMin{ std::numeric_limits<float>::max() };
+		glm::vec2 screenMax{ -std::numeric_limits<float>::max() };
+		float nearestDepth = 1.0f;
+		for (int i = 0; i < 8; i++) {
+			glm::vec3 corner{ (i & 1) ? worldBounds.m_Max.x : worldBounds.m_Min.x, (i & 2) ? worldBounds.m_Max.y : worldBounds.m_Min.y, (i & 4) ? worldBounds.m_Max.z : worldBounds.m_Min.z };
+			glm::vec4 clip = m_ViewProjection * glm::vec4(corner, 1.0f);
+			//Bounds reaching behind the camera can cover the whole screen, don't bother testing them
+			if (clip.w <= 1e-5f || clip.z < 0.0f) { return false; }
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			glm::vec2 screen{ (ndc.x * 0.5f + 0.5f) * m_Width, (ndc.y * 0.5f + 0.5f) * m_Height };
+			screenMin = glm::min(screenMin, screen);
+			screenMax = glm::max(screenMax, screen);
+			nearestDepth = std::min(nearestDepth, ndc.z);
+		}
+
+		//Every pixel the bounds touch is tested, not only the ones whose centers are covered
+		int32_t x0 = std::max(0, static_cast<int32_t>(std::floor(screenMin.x)));
+		int32_t y0 = std::max(0, static_cast<int32_t>(std::floor(screenMin.y)));
+		int32_t x1 = std::min(static_cast<int32_t>(m_Width) - 1, static_cast<int32_t>(std::ceil(screenMax.x)) - 1);
+		int32_t y1 = std::min(static_cast<int32_t>(m_Height) - 1, static_cast<int32_t>(std::ceil(screenMax.y)) - 1);
+		if (x0 > x1 || y0 > y1) { return false; }
+		x0 &= ~3;
+		nearestDepth -= DepthBias;
+
+#ifdef FLORENCIA_RASTERIZER_SSE
+		const __m128 nearest = _mm_set1_ps(nearestDepth);
+		for (int32_t y = y0; y <= y1; y++) {
+			for (int32_t x = x0; x <= x1; x += 4) {
+				__m128 depth = _mm_loadu_ps(m_Depth.data() + PixelOffset(x, y));
+				if (_mm_movemask_ps(_mm_cmpge_ps(depth, nearest)) != 0) { return false; }
+			}
+		}
+#else
+		for (int32_t y = y0; y <= y1; y++) {
+			for (int32_t x = x0; x <= x1; x++) {
+				if (m_Depth[PixelOffset(x, y)] >= nearestDepth) { return false; }
+			}
+		}
+#endif
+		return true;
+	}
+
+}
\ No newline at end of file
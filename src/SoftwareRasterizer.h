@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Bounds.h"
+
+#if !defined(FLORENCIA_RASTERIZER_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define FLORENCIA_RASTERIZER_SSE
+#endif
+
+namespace Florencia {
+
+	//Low resolution depth-only rasterizer for occluder meshes, the screen is split into tiles that are each owned by one job
+	//so tiles never share memory and the result does not depend on the number of threads or the order they run in
+	class SoftwareRasterizer {
+	public:
+		static constexpr uint32_t TileWidth = 32;
+		static constexpr uint32_t TileHeight = 16;
+		//Keeps surfaces lying exactly on their own bounds, like an occluder's front face, from hiding themselves
+		static constexpr float DepthBias = 1e-5f;
+
+		//Width and height are rounded up to whole tiles
+		SoftwareRasterizer(uint32_t width = 256, uint32_t height = 192);
+
+		//Clears the depth buffer and the triangle bins, depth is 0 to 1 with 1 being far
+		void Begin(const glm::mat4& viewProjection);
+		//Transforms and bins the triangles, triangles crossing the near plane are dropped which only ever makes culling less aggressive
+		void AddOccluder(const glm::vec3* vertices, const uint32_t* indices, uint32_t indexCount, const glm::mat4& modelMatrix);
+		//Rasterizes every binned triangle, runs on the calling thread when jobs is null
+		void Rasterize(JobSystem* jobs);
+
+		//True when every pixel the projected bounds cover already holds something nearer than the nearest point of the bounds
+		bool IsOccluded(const AABB& worldBounds) const;
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+		uint32_t GetTriangleCount() const { return static_cast<uint32_t>(m_Triangles.size()); }
+		float GetDepth(uint32_t x, uint32_t y) const { return m_Depth[PixelOffset(x, y)]; }
+
+	private:
+		//Edge functions and depth plane in the form a * x + b * y + c, in pixel space
+		struct Triangle {
+			glm::vec3 m_Edges[3];
+			glm::vec3 m_Depth;
+			int32_t m_MinX, m_MinY, m_MaxX, m_MaxY;
+		};
+
+		uint32_t PixelOffset(uint32_t x, uint32_t y) const {
+			uint32_t tile = (y / TileHeight) * m_TilesX + x / TileWidth;
+			return tile * TileWidth * TileHeight + (y % TileHeight) * TileWidth + x % TileWidth;
+		}
+
+		void RasterizeTile(uint32_t tile);
+
+		uint32_t m_Width, m_Height;
+		uint32_t m_TilesX, m_TilesY;
+		glm::mat4 m_ViewProjection{ 1.0f };
+		std::vector<float> m_Depth;
+		std::vector<Triangle> m_Triangles;
+		std::vector<std::vector<uint32_t>> m_Bins;
+	};
+
+}
\ No newline at end of file
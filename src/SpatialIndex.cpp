@@ -0,0 +1,58 @@
+#include "SpatialIndex.h"
+#include "CpuProfiler.h"
+
+namespace Florencia {
+
+	void SpatialIndex::Track(Entity entity, const AABB& localBounds, uint32_t layers) {
+		auto& bounds = m_Registry.Emplace<BoundsComponent>(entity);
+		bounds.m_LocalBounds = localBounds;
+		bounds.m_Layers = layers;
+		MarkMoved(entity);
+	}
+
+	void SpatialIndex::Remove(Entity entity) {
+		auto bounds = m_Registry.TryGet<BoundsComponent>(entity);
+		if (bounds == nullptr) { return; }
+		if (bounds->m_Proxy != BoundingVolumeHierarchy::NullNode) { m_Tree.DestroyProxy(bounds->m_Proxy); }
+		m_Registry.Remove<BoundsComponent>(entity);
+	}
+
+	void SpatialIndex::MarkMoved(Entity entity) {
+		auto bounds = m_Registry.TryGet<BoundsComponent>(entity);
+		if (bounds == nullptr || bounds->m_Dirty) { return; }
+		bounds->m_Dirty = true;
+		m_Dirty.push_back(entity);
+	}
+
+	void SpatialIndex::Update() {
+		FLORENCIA_PROFILE_SCOPE("SpatialIndex::Update");
+		m_Registry.Query<BoundsComponent, TransformComponent>().Each([this](Entity entity, BoundsComponent& bounds, TransformComponent& transform) {
+			if (!transform.m_Moved) { return; }
+			transform.m_Moved = false;
+			MarkMoved(entity);
+		});
+		for (Entity entity : m_Dirty) {
+			auto bounds = m_Registry.TryGet<BoundsComponent>(entity);
+			if (bounds == nullptr) { continue; }
+			bounds->m_Dirty = false;
+			AABB world = WorldBounds(entity, *bounds);
+			if (bounds->m_Proxy == BoundingVolumeHierarchy::NullNode) { bounds->m_Proxy = m_Tree.CreateProxy(world, entity, bounds->m_Layers); }
+			else { m_Tree.MoveProxy(bounds->m_Proxy, world); }
+		}
+		m_Dirty.clear();
+	}
+
+	bool SpatialIndex::Pick(const Ray& ray, uint32_t layers, Entity& hit, float maxDistance) const {
+		float distance;
+		return m_Tree.RayCast(ray, layers, maxDistance, hit, distance);
+	}
+
+	AABB SpatialIndex::WorldBounds(Entity entity, const BoundsComponent& bounds) {
+		auto& transform = m_Registry.Get<TransformComponent>(entity);
+		if (bounds.m_Layers & SpatialLayer::Light) {
+			return { bounds.m_LocalBounds.m_Min + transform.translation, bounds.m_LocalBounds.m_Max + transform.translation };
+		}
+		return bounds.m_LocalBounds.Transform(transform.Mat4());
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+
+#include "BoundingVolumeHierarchy.h"
+#include "GameObject.h"
+
+namespace Florencia {
+
+	struct BoundsComponent {
+		AABB m_LocalBounds{};
+		uint32_t m_Layers = SpatialLayer::Renderable;
+		int32_t m_Proxy = BoundingVolumeHierarchy::NullNode;
+		bool m_Dirty = false;
+	};
+
+	//Keeps a BVH of world space bounds in sync with the registry
+	//Transforms written through GameObject::Transform are flagged as moved, Update picks those up along with entities passed to
+	//MarkMoved and refits only them. Writing a TransformComponent straight through the registry needs a MarkMoved call, or the
+	//BVH keeps the old bounds until the next flagged write
+	class SpatialIndex {
+	public:
+		SpatialIndex(Registry& registry) : m_Registry{ registry } {}
+
+		SpatialIndex(const SpatialIndex&) = delete;
+		SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+		//Light layer bounds are centred on the translation and ignore rotation and scale
+		void Track(Entity entity, const AABB& localBounds, uint32_t layers);
+		void Remove(Entity entity);
+		void MarkMoved(Entity entity);
+		void Update();
+
+		void QueryFrustum(const Frustum& frustum, uint32_t layers, std::vector<Entity>& results) const { m_Tree.QueryFrustum(frustum, layers, results); }
+		void QuerySphere(const glm::vec3& center, float radius, uint32_t layers, std::vector<Entity>& results) const { m_Tree.QuerySphere(center, radius, layers, results); }
+		bool Pick(const Ray& ray, uint32_t layers, Entity& hit, float maxDistance = 1000.0f) const;
+
+	private:
+		AABB WorldBounds(Entity entity, const BoundsComponent& bounds);
+
+		Registry& m_Registry;
+		BoundingVolumeHierarchy m_Tree;
+		std::vector<Entity> m_Dirty;
+	};
+
+}
\ No newline at end of file
@@ -3,84 +3,129 @@
 #include <iostream>
 #include <limits>
 #include <array>
+#include <string>
+#include <algorithm>
+
+#include "CpuProfiler.h"
 
 namespace Florencia {
 
-	SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent) : m_Device{ deviceRef }, m_WindowExtent{ extent } { Init(); }
+	SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent, const SwapChainProps& props)
+		: m_Device{ deviceRef }, m_Headless{ deviceRef.IsHeadless() }, m_RenderPath{ props.Path }, m_DynamicRendering{ props.DynamicRendering }, m_PresentPolicy{ props.Present }, m_FramesInFlight{ props.FramesInFlight }, m_WindowExtent{ extent } {
+		if (m_FramesInFlight < 1 || m_FramesInFlight > MaxFramesInFlight) throw std::runtime_error("Frames In Flight Must Be Between 1 And " + std::to_string(MaxFramesInFlight));
+		Init();
+	}
 
-	SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent, std::shared_ptr<SwapChain> previous) : m_Device{ deviceRef }, m_WindowExtent{ extent }, m_PreviousSwapChain{ previous } {
+	SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent, std::shared_ptr<SwapChain> previous)
+		: m_Device{ deviceRef }, m_Headless{ deviceRef.IsHeadless() }, m_RenderPath{ previous->m_RenderPath }, m_DynamicRendering{ previous->m_DynamicRendering }, m_PresentPolicy{ previous->m_PresentPolicy },
+		m_FramesInFlight{ previous->m_FramesInFlight }, m_WindowExtent{ extent }, m_PreviousSwapChain{ previous } {
 		Init();
 		m_PreviousSwapChain = nullptr;
 	}
 
 	void SwapChain::Init() {
-		createSwapChain();
-		createImageViews();
-		createRenderPass();
+		if (m_Headless) { createOffscreenTargets(); }
+		else {
+			createSwapChain();
+			createImageViews();
+		}
+		if (!m_DynamicRendering) { createRenderPass(); }
 		createDepthResources();
-		createFramebuffers();
+		if (m_RenderPath == RenderPath::Deferred) { createGBufferResources(); }
+		if (!m_DynamicRendering) { createFramebuffers(); }
 		createSyncObjects();
 	}
 
 	SwapChain::~SwapChain() {
 		for (auto imageView : m_SwapChainImageViews) {
-			vkDestroyImageView(m_Device.Get(), imageView, nullptr);
+			vkDestroyImageView(m_Device.Get(), imageView, m_Device.GetAllocator());
 		}
 
 		m_SwapChainImageViews.clear();
 
 		if (m_SwapChain != nullptr) {
-			vkDestroySwapchainKHR(m_Device.Get(), m_SwapChain, nullptr);
+			vkDestroySwapchainKHR(m_Device.Get(), m_SwapChain, m_Device.GetAllocator());
 			m_SwapChain = nullptr;
 		}
+		for (int i = 0; i < m_OffscreenImageMemorys.size(); i++) {
+			vkDestroyImage(m_Device.Get(), m_SwapChainImages[i], m_Device.GetAllocator());
+			m_Device.FreeMemory(m_OffscreenImageMemorys[i]);
+		}
 		for (int i = 0; i < m_DepthImages.size(); i++) {
-			vkDestroyImageView(m_Device.Get(), m_DepthImageViews[i], nullptr);
-			vkDestroyImage(m_Device.Get(), m_DepthImages[i], nullptr);
-			vkFreeMemory(m_Device.Get(), m_DepthImageMemorys[i], nullptr);
+			vkDestroyImageView(m_Device.Get(), m_DepthImageViews[i], m_Device.GetAllocator());
+			vkDestroyImage(m_Device.Get(), m_DepthImages[i], m_Device.GetAllocator());
+			m_Device.FreeMemory(m_DepthImageMemorys[i]);
+		}
+		for (int i = 0; i < m_AlbedoImages.size(); i++) {
+			vkDestroyImageView(m_Device.Get(), m_AlbedoImageViews[i], m_Device.GetAllocator());
+			vkDestroyImage(m_Device.Get(), m_AlbedoImages[i], m_Device.GetAllocator());
+			m_Device.FreeMemory(m_AlbedoImageMemorys[i]);
+			vkDestroyImageView(m_Device.Get(), m_NormalImageViews[i], m_Device.GetAllocator());
+			vkDestroyImage(m_Device.Get(), m_NormalImages[i], m_Device.GetAllocator());
+			m_Device.FreeMemory(m_NormalImageMemorys[i]);
 		}
 		for (auto framebuffer : m_SwapChainFramebuffers) {
-			vkDestroyFramebuffer(m_Device.Get(), framebuffer, nullptr);
+			vkDestroyFramebuffer(m_Device.Get(), framebuffer, m_Device.GetAllocator());
 		}
-		vkDestroyRenderPass(m_Device.Get(), m_RenderPass, nullptr);
-		//cleanup synchronization objects
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			vkDestroySemaphore(m_Device.Get(), m_RenderFinishedSemaphores[i], nullptr);
-			vkDestroySemaphore(m_Device.Get(), m_ImageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(m_Device.Get(), m_InFlightFences[i], nullptr);
+		vkDestroyRenderPass(m_Device.Get(), m_RenderPass, m_Device.GetAllocator());
+		//cleanup synchronization objects, empty when they were handed over to the next swapchain
+		for (size_t i = 0; i < m_ImageAvailableSemaphores.size(); i++) {
+			vkDestroySemaphore(m_Device.Get(), m_RenderFinishedSemaphores[i], m_Device.GetAllocator());
+			vkDestroySemaphore(m_Device.Get(), m_ImageAvailableSemaphores[i], m_Device.GetAllocator());
 		}
 	}
 
 	VkResult SwapChain::acquireNextImage(uint32_t* imageIndex) {
-		vkWaitForFences(m_Device.Get(), 1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+		{
+			FLORENCIA_PROFILE_SCOPE("SwapChain::WaitForFrame");
+			waitForFrame();
+		}
+		//The slot's own target, the frame that last used it is the one just waited for
+		if (m_Headless) {
+			*imageIndex = static_cast<uint32_t>(m_CurrentFrame);
+			return VK_SUCCESS;
+		}
+		FLORENCIA_PROFILE_SCOPE("SwapChain::Acquire");
 		VkResult result = vkAcquireNextImageKHR(m_Device.Get(), m_SwapChain, std::numeric_limits<uint64_t>::max(), m_ImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE, imageIndex);
 		return result;
 	}
 
 	VkResult SwapChain::submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex) {
-		if (m_ImagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-			vkWaitForFences(m_Device.Get(), 1, &m_ImagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-		}
+		//Only blocks when there are more frames in flight than images and the last frame on this image is still rendering
+		m_Device.WaitForValue(m_ImageValues[*imageIndex]);
 
-		m_ImagesInFlight[*imageIndex] = m_InFlightFences[m_CurrentFrame];
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = buffers;
+		if (m_Headless) {
+			FLORENCIA_PROFILE_SCOPE("SwapChain::Submit");
+			uint64_t frameValue = m_Device.SubmitGraphics(submitInfo);
+			m_FrameValues[m_CurrentFrame] = frameValue;
+			m_ImageValues[*imageIndex] = frameValue;
+			m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+			return VK_SUCCESS;
+		}
+
 		VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphores[m_CurrentFrame] };
 
 		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 		submitInfo.waitSemaphoreCount = 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = buffers;
 
 		VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphores[m_CurrentFrame] };
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		vkResetFences(m_Device.Get(), 1, &m_InFlightFences[m_CurrentFrame]);
-		if (vkQueueSubmit(m_Device.GraphicsQueue(), 1, &submitInfo, m_InFlightFences[m_CurrentFrame]) != VK_SUCCESS) {
-			throw std::runtime_error("failed to submit draw command buffer!");
+		uint64_t frameValue;
+		{
+			FLORENCIA_PROFILE_SCOPE("SwapChain::Submit");
+			frameValue = m_Device.SubmitGraphics(submitInfo);
 		}
+		m_FrameValues[m_CurrentFrame] = frameValue;
+		m_ImageValues[*imageIndex] = frameValue;
+
 		VkPresentInfoKHR presentInfo = {};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 		presentInfo.waitSemaphoreCount = 1;
@@ -90,8 +135,22 @@ namespace Florencia {
 		presentInfo.swapchainCount = 1;
 		presentInfo.pSwapchains = m_SwapChains;
 		presentInfo.pImageIndices = imageIndex;
-		auto result = vkQueuePresentKHR(m_Device.PresentQueue(), &presentInfo);
-		m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+
+		VkPresentIdKHR presentIdInfo = {};
+		uint64_t presentId = m_PresentId + 1;
+		if (m_Device.SupportsPresentWait()) {
+			presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+			presentIdInfo.swapchainCount = 1;
+			presentIdInfo.pPresentIds = &presentId;
+			presentInfo.pNext = &presentIdInfo;
+			m_PresentId = presentId;
+		}
+		VkResult result;
+		{
+			FLORENCIA_PROFILE_SCOPE("SwapChain::Present");
+			result = vkQueuePresentKHR(m_Device.PresentQueue(), &presentInfo);
+		}
+		m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
 
 		return result;
 	}
@@ -101,7 +160,8 @@ namespace Florencia {
 		VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(m_SwapChainSupport.m_Formats);
 		VkPresentModeKHR presentMode = chooseSwapPresentMode(m_SwapChainSupport.m_PresentModes);
 		VkExtent2D extent = chooseSwapExtent(m_SwapChainSupport.m_Capabilities);
-		uint32_t imageCount = m_SwapChainSupport.m_Capabilities.minImageCount + 1;
+		//An extra image lets the cpu start the next frame while one is presented, low latency gives that up for a shorter queue
+		uint32_t imageCount = m_SwapChainSupport.m_Capabilities.minImageCount + (m_PresentPolicy == PresentPolicy::LowLatency ? 0 : 1);
 
 		if (m_SwapChainSupport.m_Capabilities.maxImageCount > 0 && imageCount > m_SwapChainSupport.m_Capabilities.maxImageCount) {
 			imageCount = m_SwapChainSupport.m_Capabilities.maxImageCount;
@@ -137,7 +197,7 @@ namespace Florencia {
 		createInfo.clipped = VK_TRUE;
 		createInfo.oldSwapchain = m_PreviousSwapChain == nullptr ? VK_NULL_HANDLE : m_PreviousSwapChain->m_SwapChain;
 
-		if (vkCreateSwapchainKHR(m_Device.Get(), &createInfo, nullptr, &m_SwapChain) != VK_SUCCESS) {
+		if (vkCreateSwapchainKHR(m_Device.Get(), &createInfo, m_Device.GetAllocator(), &m_SwapChain) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create swap chain!");
 		}
 		//we only specified a minimum number of images in the swap chain, so the implementation is
@@ -149,11 +209,29 @@ namespace Florencia {
 		vkGetSwapchainImagesKHR(m_Device.Get(), m_SwapChain, &imageCount, m_SwapChainImages.data());
 		m_SwapChainImageFormat = surfaceFormat.format;
 		m_SwapChainExtent = extent;
+		m_PresentMode = presentMode;
+	}
+
+	void SwapChain::createOffscreenTargets() {
+		//Same preference as the surface format, so pipelines are built against the format a window would use
+		m_SwapChainImageFormat = m_Device.FindSupportedFormat({ VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB }, VK_IMAGE_TILING_OPTIMAL,
+			VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT);
+		m_SwapChainExtent = m_WindowExtent;
+		//Nothing waits for a vertical blank
+		m_PresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		m_SwapChainImages.resize(m_FramesInFlight);
+		m_SwapChainImageViews.resize(m_FramesInFlight);
+		m_OffscreenImageMemorys.resize(m_FramesInFlight);
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		for (size_t i = 0; i < m_FramesInFlight; i++) {
+			createAttachmentImage(m_SwapChainImageFormat, usage, VK_IMAGE_ASPECT_COLOR_BIT, m_SwapChainImages[i], m_OffscreenImageMemorys[i], m_SwapChainImageViews[i], "Offscreen Color");
+		}
 	}
 
 	void SwapChain::createImageViews() {
 		m_SwapChainImageViews.resize(m_SwapChainImages.size());
 		for (size_t i = 0; i < m_SwapChainImages.size(); i++) {
+			m_Device.SetObjectName(VK_OBJECT_TYPE_IMAGE, m_SwapChainImages[i], "SwapChain Image");
 			VkImageViewCreateInfo viewInfo{};
 			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 			viewInfo.image = m_SwapChainImages[i];
@@ -165,18 +243,24 @@ namespace Florencia {
 			viewInfo.subresourceRange.baseArrayLayer = 0;
 			viewInfo.subresourceRange.layerCount = 1;
 
-			if (vkCreateImageView(m_Device.Get(), &viewInfo, nullptr, &m_SwapChainImageViews[i]) != VK_SUCCESS) {
+			if (vkCreateImageView(m_Device.Get(), &viewInfo, m_Device.GetAllocator(), &m_SwapChainImageViews[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create texture image view!");
 			}
 		}
 	}
 
 	void SwapChain::createRenderPass() {
+		if (m_RenderPath == RenderPath::Deferred) { createDeferredRenderPass(); }
+		else { createForwardRenderPass(); }
+	}
+
+	void SwapChain::createForwardRenderPass() {
 		VkAttachmentDescription depthAttachment{};
 		depthAttachment.format = findDepthFormat();
 		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
 		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		//Stored so the depth can be read back for occlusion culling
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -194,7 +278,7 @@ namespace Florencia {
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		colorAttachment.finalLayout = getFinalColorLayout();
 
 		VkAttachmentReference colorAttachmentRef = {};
 		colorAttachmentRef.attachment = 0;
@@ -212,7 +296,7 @@ namespace Florencia {
 		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
 		dependency.srcAccessMask = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
 
 		VkRenderPassCreateInfo m_RenderPassInfo = {};
@@ -224,15 +308,104 @@ namespace Florencia {
 		m_RenderPassInfo.dependencyCount = 1;
 		m_RenderPassInfo.pDependencies = &dependency;
 
-		if (vkCreateRenderPass(m_Device.Get(), &m_RenderPassInfo, nullptr, &m_RenderPass) != VK_SUCCESS) {
+		if (vkCreateRenderPass(m_Device.Get(), &m_RenderPassInfo, m_Device.GetAllocator(), &m_RenderPass) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create render pass!");
 		}
 	}
 
+	void SwapChain::createDeferredRenderPass() {
+		VkAttachmentDescription colorAttachment = {};
+		colorAttachment.format = getSwapChainImageFormat();
+		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachment.finalLayout = getFinalColorLayout();
+
+		VkAttachmentDescription depthAttachment = colorAttachment;
+		depthAttachment.format = findDepthFormat();
+		//Stored so the depth can be read back for occlusion culling
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		//The g-buffer only lives for the duration of the render pass
+		VkAttachmentDescription albedoAttachment = colorAttachment;
+		albedoAttachment.format = AlbedoFormat;
+		albedoAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		albedoAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkAttachmentDescription normalAttachment = albedoAttachment;
+		normalAttachment.format = NormalFormat;
+
+		VkAttachmentReference gBufferRefs[] = {
+			{ 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+			{ 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL }
+		};
+		VkAttachmentReference depthWriteRef = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference colorRef = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		//Order matches the input_attachment_index values in DeferredLighting.frag
+		VkAttachmentReference inputRefs[] = {
+			{ 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ 3, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL }
+		};
+		//Depth stays bound read only in the lighting subpass so light billboards are still depth tested
+		VkAttachmentReference depthReadRef = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+
+		std::array<VkSubpassDescription, 2> subpasses{};
+		subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[0].colorAttachmentCount = 2;
+		subpasses[0].pColorAttachments = gBufferRefs;
+		subpasses[0].pDepthStencilAttachment = &depthWriteRef;
+
+		subpasses[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpasses[1].colorAttachmentCount = 1;
+		subpasses[1].pColorAttachments = &colorRef;
+		subpasses[1].inputAttachmentCount = 3;
+		subpasses[1].pInputAttachments = inputRefs;
+		subpasses[1].pDepthStencilAttachment = &depthReadRef;
+
+		std::array<VkSubpassDependency, 2> dependencies{};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[0].srcAccessMask = 0;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = 1;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+		dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		std::array<VkAttachmentDescription, 4> attachments = { colorAttachment, depthAttachment, albedoAttachment, normalAttachment };
+
+		VkRenderPassCreateInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+		renderPassInfo.pSubpasses = subpasses.data();
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
+
+		if (vkCreateRenderPass(m_Device.Get(), &renderPassInfo, m_Device.GetAllocator(), &m_RenderPass) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create deferred render pass!");
+		}
+	}
+
 	void SwapChain::createFramebuffers() {
 		m_SwapChainFramebuffers.resize(imageCount());
 		for (size_t i = 0; i < imageCount(); i++) {
-			std::array<VkImageView, 2> attachments = { m_SwapChainImageViews[i], m_DepthImageViews[i] };
+			std::vector<VkImageView> attachments = { m_SwapChainImageViews[i], m_DepthImageViews[i] };
+			if (m_RenderPath == RenderPath::Deferred) {
+				attachments.push_back(m_AlbedoImageViews[i]);
+				attachments.push_back(m_NormalImageViews[i]);
+			}
 			VkExtent2D m_SwapChainExtent = getSwapChainExtent();
 
 			VkFramebufferCreateInfo framebufferInfo = {};
@@ -244,7 +417,7 @@ namespace Florencia {
 			framebufferInfo.height = m_SwapChainExtent.height;
 			framebufferInfo.layers = 1;
 
-			if (vkCreateFramebuffer(m_Device.Get(), &framebufferInfo, nullptr, &m_SwapChainFramebuffers[i]) != VK_SUCCESS) {
+			if (vkCreateFramebuffer(m_Device.Get(), &framebufferInfo, m_Device.GetAllocator(), &m_SwapChainFramebuffers[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create framebuffer!");
 			}
 		}
@@ -269,11 +442,14 @@ namespace Florencia {
 			imageInfo.format = depthFormat;
 			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+			//Sampled by the Hi-Z occlusion culler's depth reduction
+			imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			if (m_RenderPath == RenderPath::Deferred) { imageInfo.usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT; }
 			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 			imageInfo.flags = 0;
 			m_Device.CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_DepthImages[i], m_DepthImageMemorys[i]);
+			m_Device.SetObjectName(VK_OBJECT_TYPE_IMAGE, m_DepthImages[i], "Depth");
 			VkImageViewCreateInfo viewInfo{};
 			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 			viewInfo.image = m_DepthImages[i];
@@ -284,29 +460,88 @@ namespace Florencia {
 			viewInfo.subresourceRange.levelCount = 1;
 			viewInfo.subresourceRange.baseArrayLayer = 0;
 			viewInfo.subresourceRange.layerCount = 1;
-			if (vkCreateImageView(m_Device.Get(), &viewInfo, nullptr, &m_DepthImageViews[i]) != VK_SUCCESS) {
+			if (vkCreateImageView(m_Device.Get(), &viewInfo, m_Device.GetAllocator(), &m_DepthImageViews[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create texture image view!");
 			}
 		}
 	}
 
+	void SwapChain::createGBufferResources() {
+		m_AlbedoImages.resize(imageCount());
+		m_AlbedoImageMemorys.resize(imageCount());
+		m_AlbedoImageViews.resize(imageCount());
+		m_NormalImages.resize(imageCount());
+		m_NormalImageMemorys.resize(imageCount());
+		m_NormalImageViews.resize(imageCount());
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		for (size_t i = 0; i < imageCount(); i++) {
+			createAttachmentImage(AlbedoFormat, usage, VK_IMAGE_ASPECT_COLOR_BIT, m_AlbedoImages[i], m_AlbedoImageMemorys[i], m_AlbedoImageViews[i], "G-Buffer Albedo");
+			createAttachmentImage(NormalFormat, usage, VK_IMAGE_ASPECT_COLOR_BIT, m_NormalImages[i], m_NormalImageMemorys[i], m_NormalImageViews[i], "G-Buffer Normal");
+		}
+	}
+
+	void SwapChain::createAttachmentImage(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, VkImage& image, VkDeviceMemory& memory, VkImageView& view, const char* name) {
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent.width = m_SwapChainExtent.width;
+		imageInfo.extent.height = m_SwapChainExtent.height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = format;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = usage;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.flags = 0;
+		m_Device.CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+		m_Device.SetObjectName(VK_OBJECT_TYPE_IMAGE, image, name);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = format;
+		viewInfo.subresourceRange.aspectMask = aspect;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+		if (vkCreateImageView(m_Device.Get(), &viewInfo, m_Device.GetAllocator(), &view) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create attachment image view!");
+		}
+	}
+
 	void SwapChain::createSyncObjects() {
-		m_ImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		m_RenderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		m_InFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-		m_ImagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+		//Value 0 is complete from the start, so fresh images and frame slots never wait
+		m_ImageValues.resize(imageCount(), 0);
+		//The frame values still guard work recorded against the previous swapchain, taking them over lets the next frame
+		//wait on exactly that work instead of the whole device, and keeps the frame index in step with the Renderer
+		if (m_PreviousSwapChain != nullptr) {
+			m_ImageAvailableSemaphores = std::move(m_PreviousSwapChain->m_ImageAvailableSemaphores);
+			m_RenderFinishedSemaphores = std::move(m_PreviousSwapChain->m_RenderFinishedSemaphores);
+			m_FrameValues = std::move(m_PreviousSwapChain->m_FrameValues);
+			m_CurrentFrame = m_PreviousSwapChain->m_CurrentFrame;
+			m_PreviousSwapChain->m_ImageAvailableSemaphores.clear();
+			m_PreviousSwapChain->m_RenderFinishedSemaphores.clear();
+			m_PreviousSwapChain->m_FrameValues.clear();
+			return;
+		}
+
+		m_FrameValues.resize(m_FramesInFlight, 0);
+		if (m_Headless) { return; }
+		//Acquire and present only take binary semaphores, everything else waits on the device timeline
+		m_ImageAvailableSemaphores.resize(m_FramesInFlight);
+		m_RenderFinishedSemaphores.resize(m_FramesInFlight);
 
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			if (vkCreateSemaphore(m_Device.Get(), &semaphoreInfo, nullptr, &m_ImageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(m_Device.Get(), &semaphoreInfo, nullptr, &m_RenderFinishedSemaphores[i]) != VK_SUCCESS ||
-				vkCreateFence(m_Device.Get(), &fenceInfo, nullptr, &m_InFlightFences[i]) != VK_SUCCESS) {
+		for (size_t i = 0; i < m_FramesInFlight; i++) {
+			if (vkCreateSemaphore(m_Device.Get(), &semaphoreInfo, m_Device.GetAllocator(), &m_ImageAvailableSemaphores[i]) != VK_SUCCESS ||
+				vkCreateSemaphore(m_Device.Get(), &semaphoreInfo, m_Device.GetAllocator(), &m_RenderFinishedSemaphores[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create synchronization objects for a frame!");
 			}
 		}
@@ -323,20 +558,31 @@ namespace Florencia {
 	}
 
 	VkPresentModeKHR SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-		/*for (const auto& availablePresentMode : availablePresentModes) {
-			if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-				std::cout << "Present mode: Mailbox\n";
-				return availablePresentMode;
+		std::vector<VkPresentModeKHR> preferredModes{};
+		switch (m_PresentPolicy) {
+			case PresentPolicy::LowLatency: preferredModes = { VK_PRESENT_MODE_FIFO_RELAXED_KHR }; break;
+			case PresentPolicy::Uncapped: preferredModes = { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR }; break;
+			case PresentPolicy::Mailbox: preferredModes = { VK_PRESENT_MODE_MAILBOX_KHR }; break;
+			default: break;
+		}
+		VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+		for (VkPresentModeKHR preferredMode : preferredModes) {
+			if (std::find(availablePresentModes.begin(), availablePresentModes.end(), preferredMode) != availablePresentModes.end()) {
+				presentMode = preferredMode;
+				break;
 			}
-		}*/
-		for (const auto &availablePresentMode : availablePresentModes) {
-			if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-				std::cout << "Present mode: Immediate\n";
-				return availablePresentMode;
+		}
+
+		//Only reported once, recreation picks the same mode again
+		if (m_PreviousSwapChain == nullptr) {
+			switch (presentMode) {
+				case VK_PRESENT_MODE_IMMEDIATE_KHR: std::cout << "Present mode: Immediate\n"; break;
+				case VK_PRESENT_MODE_MAILBOX_KHR: std::cout << "Present mode: Mailbox\n"; break;
+				case VK_PRESENT_MODE_FIFO_RELAXED_KHR: std::cout << "Present mode: Relaxed V-Sync\n"; break;
+				default: std::cout << "Present mode: V-Sync\n"; break;
 			}
 		}
-		std::cout << "Present mode: V-Sync\n";
-		return VK_PRESENT_MODE_FIFO_KHR;
+		return presentMode;
 	}
 
 	VkExtent2D SwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
@@ -352,7 +598,7 @@ namespace Florencia {
 	}
 
 	VkFormat SwapChain::findDepthFormat() {
-		return m_Device.FindSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT }, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		return m_Device.FindSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT }, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
 	}
 
 }
\ No newline at end of file
@@ -6,42 +6,98 @@
 
 namespace Florencia {
 
+	//Forward renders everything in one subpass
+	//Deferred writes albedo, normal and depth in subpass 0 and reads them as input attachments to light the swapchain image in subpass 1
+	enum class RenderPath { Forward, Deferred };
+
+	//Uncapped prefers IMMEDIATE and may tear, Mailbox never tears but renders frames that are never shown, VSync waits for
+	//every vertical blank, LowLatency is VSync with the shallowest queue that presents late frames right away
+	//Every policy falls back to FIFO, the only mode all devices support
+	enum class PresentPolicy { LowLatency, VSync, Uncapped, Mailbox };
+
+	struct SwapChainProps {
+		RenderPath Path = RenderPath::Forward;
+		//No render pass or framebuffers are created, so recreating only rebuilds the images
+		bool DynamicRendering = false;
+		PresentPolicy Present = PresentPolicy::Uncapped;
+		//Frames the cpu may record ahead of the gpu, fewer cut latency and more absorb frame time spikes
+		uint32_t FramesInFlight = 2;
+	};
+
+	struct GBufferViews {
+		VkImageView m_Albedo;
+		VkImageView m_Normal;
+		VkImageView m_Depth;
+	};
+
 	class SwapChain {
 	public:
-		SwapChain(Device& deviceRef, VkExtent2D m_WindowExtent);
+		static constexpr VkFormat AlbedoFormat = VK_FORMAT_R8G8B8A8_UNORM;
+		static constexpr VkFormat NormalFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+		static constexpr uint32_t MaxFramesInFlight = 4;
+
+		SwapChain(Device& deviceRef, VkExtent2D m_WindowExtent, const SwapChainProps& props = SwapChainProps{});
+		//Passes previous as oldSwapchain and takes over its frame values and semaphores, previous must be kept alive
+		//until the frames submitted with it have completed
 		SwapChain(Device& deviceRef, VkExtent2D m_WindowExtent, std::shared_ptr<SwapChain> previous);
 		~SwapChain();
 
 		SwapChain(const SwapChain&) = delete;
 		SwapChain& operator=(const SwapChain&) = delete;
 
+		//On a headless device the images are an offscreen ring with one color and depth target per frame slot,
+		//acquiring hands out the slot's image and submitting never presents
+		bool isHeadless() { return m_Headless; }
+		//Layout the color image is left in at the end of a frame, transfer source when headless so it can be read back
+		VkImageLayout getFinalColorLayout() { return m_Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
+
 		uint32_t width() { return m_SwapChainExtent.width; }
 		uint32_t height() { return m_SwapChainExtent.height; }
+		//VK_NULL_HANDLE with dynamic rendering
 		VkRenderPass getRenderPass() { return m_RenderPass; }
+		bool usesDynamicRendering() { return m_DynamicRendering; }
 		size_t imageCount() { return m_SwapChainImages.size(); }
 		VkExtent2D getSwapChainExtent() { return m_SwapChainExtent; }
 		VkFormat getSwapChainImageFormat() { return m_SwapChainImageFormat; }
+		VkImage getImage(int index) { return m_SwapChainImages[index]; }
 		VkImageView getImageView(int index) { return m_SwapChainImageViews[index]; }
+		VkImage getDepthImage(int index) { return m_DepthImages[index]; }
+		VkImageView getDepthImageView(int index) { return m_DepthImageViews[index]; }
+		VkFormat getDepthFormat() { return m_SwapChainDepthFormat; }
+		RenderPath getRenderPath() { return m_RenderPath; }
+		uint32_t framesInFlight() { return m_FramesInFlight; }
+		VkPresentModeKHR getPresentMode() { return m_PresentMode; }
+		GBufferViews getGBufferViews(int index) { return { m_AlbedoImageViews[index], m_NormalImageViews[index], m_DepthImageViews[index] }; }
 		VkFramebuffer getFrameBuffer(int index) { return m_SwapChainFramebuffers[index]; }
 		float extentAspectRatio() { return static_cast<float>(m_SwapChainExtent.width) / static_cast<float>(m_SwapChainExtent.height); }
 
 		VkFormat findDepthFormat();
 		VkResult acquireNextImage(uint32_t* imageIndex);
 		VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
+		//Waits until the gpu has finished the last frame submitted in the next frame slot, acquireNextImage then won't block on it
+		void waitForFrame() { m_Device.WaitForValue(m_FrameValues[m_CurrentFrame]); }
+		//Id of the last present, 0 without present wait support, ids restart with every swapchain
+		uint64_t lastPresentId() { return m_PresentId; }
+		VkResult waitForPresent(uint64_t presentId, uint64_t timeout) { return m_Device.WaitForPresent(m_SwapChain, presentId, timeout); }
 
 		bool compareSwapFormats(const SwapChain& m_SwapChain) const {
 			return m_SwapChain.m_SwapChainDepthFormat == m_SwapChainDepthFormat && m_SwapChain.m_SwapChainImageFormat == m_SwapChainImageFormat;
 		}
 
-		static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 	private:
 		void Init();
 		void createSwapChain();
+		void createOffscreenTargets();
 		void createImageViews();
 		void createRenderPass();
 		void createSyncObjects();
 		void createFramebuffers();
 		void createDepthResources();
+		void createGBufferResources();
+		void createForwardRenderPass();
+		void createDeferredRenderPass();
+		void createAttachmentImage(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, VkImage& image, VkDeviceMemory& memory, VkImageView& view, const char* name);
 
 		// Helper functions
 		VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
@@ -49,20 +105,32 @@ namespace Florencia {
 		VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 
 		Device& m_Device;
+		bool m_Headless;
+		RenderPath m_RenderPath;
+		bool m_DynamicRendering;
+		PresentPolicy m_PresentPolicy;
+		uint32_t m_FramesInFlight;
+		VkPresentModeKHR m_PresentMode;
 		size_t m_CurrentFrame = 0;
+		uint64_t m_PresentId = 0;
 		VkExtent2D m_WindowExtent;
-		VkRenderPass m_RenderPass;
-		VkSwapchainKHR m_SwapChain;
+		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+		VkSwapchainKHR m_SwapChain = VK_NULL_HANDLE;
 		VkExtent2D m_SwapChainExtent;
 		VkFormat m_SwapChainImageFormat;
 		VkFormat m_SwapChainDepthFormat;
 		std::vector<VkImage> m_DepthImages;
-		std::vector<VkFence> m_InFlightFences;
-		std::vector<VkFence> m_ImagesInFlight;
+		//Timeline values of the last submission of each frame slot and of the last frame rendered to each image
+		std::vector<uint64_t> m_FrameValues;
+		std::vector<uint64_t> m_ImageValues;
 		std::vector<VkImage> m_SwapChainImages;
 		std::vector<VkImageView> m_DepthImageViews;
 		std::vector<VkImageView> m_SwapChainImageViews;
+		std::vector<VkDeviceMemory> m_OffscreenImageMemorys;
 		std::vector<VkDeviceMemory> m_DepthImageMemorys;
+		std::vector<VkImage> m_AlbedoImages, m_NormalImages;
+		std::vector<VkImageView> m_AlbedoImageViews, m_NormalImageViews;
+		std::vector<VkDeviceMemory> m_AlbedoImageMemorys, m_NormalImageMemorys;
 		std::shared_ptr<SwapChain> m_PreviousSwapChain;
 		std::vector<VkFramebuffer> m_SwapChainFramebuffers;
 		std::vector<VkSemaphore> m_ImageAvailableSemaphores;
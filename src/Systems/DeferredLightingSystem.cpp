@@ -0,0 +1,96 @@
+#include "DeferredLightingSystem.h"
+#include <glm/glm.hpp>
+#include <stdexcept>
+
+#include "CpuProfiler.h"
+
+namespace Florencia {
+
+	struct DeferredLightingPushConstantData {
+		glm::vec2 inverseExtent;
+	};
+
+	DeferredLightingSystem::DeferredLightingSystem(Device& device, PipelineBuilder& pipelineBuilder, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout, uint32_t framesInFlight) : m_Device(device) {
+		m_GBufferSetLayout = DescriptorSetLayout::Builder(m_Device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.AddBinding(2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.Build();
+		m_GBufferPool = DescriptorPool::Builder(m_Device)
+			.SetMaxSets(framesInFlight)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, framesInFlight * 3)
+			.Build();
+		m_GBufferSets.resize(framesInFlight);
+		for (auto& set : m_GBufferSets) {
+			if (!m_GBufferPool->AllocateDescriptor(m_GBufferSetLayout->GetDescriptorSetLayout(), set)) { throw std::runtime_error("Failed to Allocate G-Buffer Descriptor Set"); }
+			m_Device.SetObjectName(VK_OBJECT_TYPE_DESCRIPTOR_SET, set, "G-Buffer Set");
+		}
+
+		CreatePipelineLayout(globalSetLayout, lightingSetLayout);
+		CreatePipeline(pipelineBuilder, renderPass);
+	}
+
+	DeferredLightingSystem::~DeferredLightingSystem() { vkDestroyPipelineLayout(m_Device.Get(), m_PipelineLayout, m_Device.GetAllocator()); }
+
+	void DeferredLightingSystem::Render(FrameInfo& frameInfo, const GBufferViews& gBuffer, VkExtent2D extent) {
+		FLORENCIA_PROFILE_SCOPE("DeferredLightingSystem::Render");
+		//The framebuffer changes with the acquired image, so the set of this frame is rewritten every frame
+		VkDescriptorImageInfo albedoInfo{ VK_NULL_HANDLE, gBuffer.m_Albedo, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		VkDescriptorImageInfo normalInfo{ VK_NULL_HANDLE, gBuffer.m_Normal, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		VkDescriptorImageInfo depthInfo{ VK_NULL_HANDLE, gBuffer.m_Depth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+		VkDescriptorSet& gBufferSet = m_GBufferSets[frameInfo.m_FrameIndex];
+		DescriptorWriter(*m_GBufferSetLayout, *m_GBufferPool, &frameInfo.m_FrameArena)
+			.WriteImage(0, &albedoInfo)
+			.WriteImage(1, &normalInfo)
+			.WriteImage(2, &depthInfo)
+			.Overwrite(gBufferSet);
+
+		DebugLabelScope label{ m_Device, frameInfo.m_CommandBuffer, "DeferredLightingSystem" };
+		if (m_Pipeline.Get().Bind(frameInfo.m_CommandBuffer, frameInfo.m_BoundPipeline)) { frameInfo.m_Statistics.m_PipelineBinds++; }
+		VkDescriptorSet descriptorSets[] = { frameInfo.m_GlobalDescriptorSet, frameInfo.m_LightingDescriptorSet, gBufferSet };
+		vkCmdBindDescriptorSets(frameInfo.m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 3, descriptorSets, 0, nullptr);
+
+		DeferredLightingPushConstantData push{};
+		push.inverseExtent = glm::vec2(1.0f / static_cast<float>(extent.width), 1.0f / static_cast<float>(extent.height));
+		vkCmdPushConstants(frameInfo.m_CommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(DeferredLightingPushConstantData), &push);
+		vkCmdDraw(frameInfo.m_CommandBuffer, 3, 1, 0, 0);
+		frameInfo.m_Statistics.m_DescriptorSetBinds++;
+		frameInfo.m_Statistics.m_DrawCalls++;
+	}
+
+	void DeferredLightingSystem::CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout) {
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.size = sizeof(DeferredLightingPushConstantData);
+		pushConstantRange.offset = 0;
+
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, lightingSetLayout, m_GBufferSetLayout->GetDescriptorSetLayout() };
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(m_Device.Get(), &pipelineLayoutInfo, m_Device.GetAllocator(), &m_PipelineLayout) != VK_SUCCESS) throw std::runtime_error("Failed to Create Pipeline Layout");
+	}
+
+	void DeferredLightingSystem::CreatePipeline(PipelineBuilder& pipelineBuilder, VkRenderPass renderPass) {
+		if (m_PipelineLayout == nullptr) throw std::runtime_error("Cannot create pipeline before pipeline layout");
+
+		PipelineConfigInfo pipelineConfig{};
+		Pipeline::DefaultPipelineConfigInfo(pipelineConfig);
+		//Fullscreen triangle generated from the vertex index, depth is an input here rather than a test
+		pipelineConfig.bindingDescriptions.clear();
+		pipelineConfig.attributeDescriptions.clear();
+		pipelineConfig.depthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+		pipelineConfig.renderPass = renderPass;
+		pipelineConfig.pipelineLayout = m_PipelineLayout;
+		pipelineConfig.subpass = 1;
+
+		m_Pipeline = pipelineBuilder.Build(pipelineConfig, "assets/shaders/DeferredLighting.vert.spv", "assets/shaders/DeferredLighting.frag.spv");
+	}
+
+}
\ No newline at end of file
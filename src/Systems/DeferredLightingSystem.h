@@ -0,0 +1,37 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Descriptors.h"
+#include "FrameInfo.h"
+#include "SwapChain.h"
+#include "PipelineBuilder.h"
+#include "Device.h"
+
+namespace Florencia {
+
+	//Lighting subpass of the deferred path, shades every covered pixel once from the g-buffer with a fullscreen triangle
+	//Uses the same clustered light lists as the forward path so both paths light identically
+	class DeferredLightingSystem {
+	public:
+		DeferredLightingSystem(Device& device, PipelineBuilder& pipelineBuilder, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout, uint32_t framesInFlight);
+		~DeferredLightingSystem();
+
+		DeferredLightingSystem(const DeferredLightingSystem&) = delete;
+		DeferredLightingSystem& operator=(const DeferredLightingSystem&) = delete;
+
+		//Must be called in subpass 1, gBuffer are the attachments of the framebuffer being rendered to
+		void Render(FrameInfo& frameInfo, const GBufferViews& gBuffer, VkExtent2D extent);
+
+	private:
+		void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout);
+		void CreatePipeline(PipelineBuilder& pipelineBuilder, VkRenderPass renderPass);
+
+		Device& m_Device;
+		VkPipelineLayout m_PipelineLayout;
+		PendingPipeline m_Pipeline;
+		std::unique_ptr<DescriptorSetLayout> m_GBufferSetLayout;
+		std::unique_ptr<DescriptorPool> m_GBufferPool;
+		std::vector<VkDescriptorSet> m_GBufferSets;
+	};
+
+}
\ No newline at end of file
@@ -3,106 +3,130 @@
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/constants.hpp>
 #include <glm/glm.hpp>
+#include <algorithm>
 #include <stdexcept>
-#include <map>
+#include <cstddef>
 
+#include "CpuProfiler.h"
 #include "GameObject.h"
+#include "SwapChain.h"
 
 namespace Florencia {
 
-	struct PointLightPushConstants {
-		glm::vec4 m_Position{};
-		glm::vec4 m_Color{};
-		float radius;
-	};
-
-	PointLightSystem::PointLightSystem(Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : m_Device(device) {
+	PointLightSystem::PointLightSystem(Device& device, PipelineBuilder& pipelineBuilder, const RenderTargetInfo& renderTarget, VkDescriptorSetLayout globalSetLayout, uint32_t framesInFlight, uint32_t subpass) : m_Device(device) {
 		CreatePipelineLayout(globalSetLayout);
-		CreatePipeline(renderPass);
+		CreatePipeline(pipelineBuilder, renderTarget, subpass);
+		m_InstanceBuffers.resize(framesInFlight);
 	}
 
-	PointLightSystem::~PointLightSystem() { vkDestroyPipelineLayout(m_Device.Get(), m_PipelineLayout, nullptr); }
+	PointLightSystem::~PointLightSystem() { vkDestroyPipelineLayout(m_Device.Get(), m_PipelineLayout, m_Device.GetAllocator()); }
+
+	void PointLightSystem::Update(FrameInfo& frameInfo, GlobalUBO& ubo, ClusteredLighting& lighting) {
+		FLORENCIA_PROFILE_SCOPE("PointLightSystem::Update");
+		//Only lights whose range reaches into the view frustum and touches a renderable are uploaded
+		Frustum frustum = frameInfo.m_Camera.GetFrustum();
+		m_VisibleLights.clear();
+		frameInfo.m_SpatialIndex.QueryFrustum(frustum, SpatialLayer::Light, m_VisibleLights);
+
+		m_Lights.clear();
+		for (Entity entity : m_VisibleLights) {
+			auto light = frameInfo.m_Registry.TryGet<PointLightComponent>(entity);
+			if (light == nullptr) { continue; }
+			auto& transform = frameInfo.m_Registry.Get<TransformComponent>(entity);
+			if (!frustum.Intersects(transform.translation, light->Range())) { continue; }
+			//A light that reaches no renderable only costs cluster assignment and shading work
+			m_LitEntities.clear();
+			frameInfo.m_SpatialIndex.QuerySphere(transform.translation, light->Range(), SpatialLayer::Renderable, m_LitEntities);
+			if (m_LitEntities.empty()) { continue; }
+			m_Lights.push_back({ glm::vec4(transform.translation, light->Range()), glm::vec4(light->m_Color, light->m_LightIntensity) });
+		}
+		lighting.Update(frameInfo.m_FrameIndex, frameInfo.m_Camera, m_Lights, ubo);
+	}
 
-	void PointLightSystem::Update(FrameInfo& frameInfo, GlobalUBO& ubo) {
-		int lightIndex = 0;
-		for(auto& kv : frameInfo.m_GameObjects) {
-			auto& obj = kv.second;
-			if(obj.m_PointLight == nullptr) { continue; }
-			ubo.m_PointLights[lightIndex].m_Position = glm::vec4(obj.m_Transform.translation, 1.0f);
-			ubo.m_PointLights[lightIndex].m_Color = glm::vec4(obj.m_Color.r, obj.m_Color.g, obj.m_Color.b, obj.m_PointLight->m_LightIntensity);
-			lightIndex++;
+	uint32_t LightDistanceSort::Sort(Registry& registry, glm::vec3 cameraPosition, const std::vector<Entity>& lights) {
+		m_Entities.clear();
+		m_Keys.clear();
+		for (Entity entity : lights) {
+			if (!registry.Has<PointLightComponent>(entity)) { continue; }
+			auto offset = cameraPosition - registry.Get<TransformComponent>(entity).translation;
+			m_Entities.push_back(entity);
+			m_Keys.push_back(glm::dot(offset, offset));
 		}
-		ubo.numLights = lightIndex;
+		uint32_t count = static_cast<uint32_t>(m_Entities.size());
+		m_Order = &m_Sort.Sort(m_Keys.data(), count);
+		return count;
 	}
 
 	void PointLightSystem::Render(FrameInfo& frameInfo) {
-		//sort lights
-		std::map<float, GameObject::ID_t> m_SortedLights;
-		for(auto& kv : frameInfo.m_GameObjects) {
-			auto& obj = kv.second;
-			if(obj.m_PointLight == nullptr) { continue; }
-
-			//calculate distance
-			auto offset = frameInfo.m_Camera.GetPostition() - obj.m_Transform.translation;
-			float squareDistance = glm::dot(offset, offset);
-			m_SortedLights[squareDistance] = obj.GetID();
+		FLORENCIA_PROFILE_SCOPE("PointLightSystem::Render");
+		uint32_t instanceCount = m_LightSort.Sort(frameInfo.m_Registry, frameInfo.m_Camera.GetPostition(), m_VisibleLights);
+		if (instanceCount == 0) { return; }
+
+		auto& instanceBuffer = m_InstanceBuffers[frameInfo.m_FrameIndex];
+		if (instanceBuffer == nullptr || instanceBuffer->GetInstanceCount() < instanceCount) {
+			uint32_t capacity = std::max(instanceCount, instanceBuffer == nullptr ? 64u : instanceBuffer->GetInstanceCount() * 2);
+			instanceBuffer = std::make_unique<Buffer>(m_Device, sizeof(PointLightInstance), capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+			instanceBuffer->SetName("Point Light Instances");
+			instanceBuffer->Map();
 		}
 
-		m_Pipeline->Bind(frameInfo.m_CommandBuffer);
+		//Farthest first so the farthest billboard blends first
+		auto instances = static_cast<PointLightInstance*>(instanceBuffer->GetMappedMemory());
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			Entity entity = m_LightSort.GetBackToFront(i);
+			auto& transform = frameInfo.m_Registry.Get<TransformComponent>(entity);
+			auto& light = frameInfo.m_Registry.Get<PointLightComponent>(entity);
+			instances[i].m_Position = glm::vec4(transform.translation, transform.scale.x);
+			instances[i].m_Color = glm::vec4(light.m_Color, light.m_LightIntensity);
+		}
+		instanceBuffer->Flush();
 
+		DebugLabelScope label{ m_Device, frameInfo.m_CommandBuffer, "PointLightSystem" };
+		if (m_Pipeline.Get().Bind(frameInfo.m_CommandBuffer, frameInfo.m_BoundPipeline)) { frameInfo.m_Statistics.m_PipelineBinds++; }
 		vkCmdBindDescriptorSets(frameInfo.m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &frameInfo.m_GlobalDescriptorSet, 0, nullptr);
 
-		for(auto it = m_SortedLights.rbegin(); it != m_SortedLights.rend(); ++it) {
-			auto& obj = frameInfo.m_GameObjects.at(it->second);
-			PointLightPushConstants push{};
-			push.m_Position = glm::vec4(obj.m_Transform.translation, 1.0f);
-			push.m_Color = glm::vec4(obj.m_Color.x, obj.m_Color.y, obj.m_Color.z, obj.m_PointLight->m_LightIntensity);
-			push.radius = obj.m_Transform.scale.x;
-
-			vkCmdPushConstants(
-				frameInfo.m_CommandBuffer,
-				m_PipelineLayout,
-				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-				0,
-				sizeof(PointLightPushConstants),
-				&push
-			);
-
-			vkCmdDraw(frameInfo.m_CommandBuffer, 6, 1, 0, 0);
-		}
+		VkBuffer buffers[] = { instanceBuffer->GetBuffer() };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(frameInfo.m_CommandBuffer, 0, 1, buffers, offsets);
+		vkCmdDraw(frameInfo.m_CommandBuffer, 6, instanceCount, 0, 0);
+		frameInfo.m_Statistics.m_DescriptorSetBinds++;
+		frameInfo.m_Statistics.m_VertexBufferBinds++;
+		frameInfo.m_Statistics.m_DrawCalls++;
 	}
 
 	void PointLightSystem::CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout) {
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.size = sizeof(PointLightPushConstants);
-		pushConstantRange.offset = 0;
-
 		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
 		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
-		if (vkCreatePipelineLayout(m_Device.Get(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS) { throw std::runtime_error("Failed to Create Pipeline Layout"); }
+		if (vkCreatePipelineLayout(m_Device.Get(), &pipelineLayoutInfo, m_Device.GetAllocator(), &m_PipelineLayout) != VK_SUCCESS) { throw std::runtime_error("Failed to Create Pipeline Layout"); }
 	}
 
-	void PointLightSystem::CreatePipeline(VkRenderPass renderPass) {
+	void PointLightSystem::CreatePipeline(PipelineBuilder& pipelineBuilder, const RenderTargetInfo& renderTarget, uint32_t subpass) {
 		if (m_PipelineLayout == nullptr) { throw std::runtime_error("Cannot create pipeline before pipeline layout"); }
 
 		PipelineConfigInfo pipelineConfig{};
 		Pipeline::DefaultPipelineConfigInfo(pipelineConfig);
 		Pipeline::EnableAlphaBlending(pipelineConfig);
-		pipelineConfig.attributeDescriptions.clear();
-		pipelineConfig.bindingDescriptions.clear();
-
-		pipelineConfig.renderPass = renderPass;
+		//One PointLightInstance per billboard, the quad corners come from gl_VertexIndex
+		pipelineConfig.bindingDescriptions = { { 0, sizeof(PointLightInstance), VK_VERTEX_INPUT_RATE_INSTANCE } };
+		pipelineConfig.attributeDescriptions = {
+			{ 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(PointLightInstance, m_Position) },
+			{ 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(PointLightInstance, m_Color) }
+		};
+
+		Pipeline::RenderTargetConfigInfo(pipelineConfig, renderTarget);
 		pipelineConfig.pipelineLayout = m_PipelineLayout;
+		pipelineConfig.subpass = subpass;
+		//Depth is bound read only after the g-buffer subpass
+		if (subpass > 0) { pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE; }
 
-		m_Pipeline = std::make_unique<Pipeline>(m_Device, pipelineConfig, "assets/shaders/PointLight.vert.spv", "assets/shaders/PointLight.frag.spv");
+		m_Pipeline = pipelineBuilder.Build(pipelineConfig, "assets/shaders/PointLight.vert.spv", "assets/shaders/PointLight.frag.spv");
 	}
 
 }
\ No newline at end of file
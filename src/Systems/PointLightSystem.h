@@ -1,29 +1,61 @@
 #pragma once
 #include <memory>
 #include <vector>
+#include "ClusteredLighting.h"
 #include "FrameInfo.h"
-#include "Pipeline.h"
+#include "RadixSort.h"
+#include "PipelineBuilder.h"
+#include "Buffer.h"
 #include "Device.h"
 
 namespace Florencia {
 
+	//Orders lights by distance to the camera for back to front blending, scratch memory is kept between calls
+	class LightDistanceSort {
+	public:
+		//Skips entities that no longer have a light, returns how many were sorted
+		uint32_t Sort(Registry& registry, glm::vec3 cameraPosition, const std::vector<Entity>& lights);
+		//Farthest first, i must be below the count returned by the last Sort
+		Entity GetBackToFront(uint32_t i) const { return m_Entities[(*m_Order)[m_Order->size() - 1 - i]]; }
+
+	private:
+		RadixSort m_Sort;
+		std::vector<Entity> m_Entities;
+		std::vector<float> m_Keys;
+		const std::vector<uint32_t>* m_Order = nullptr;
+	};
+
 	class PointLightSystem {
 	public:
-		PointLightSystem(Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+		//Subpass is the one the billboards are drawn in, 1 for the lighting subpass of the deferred path
+		PointLightSystem(Device& device, PipelineBuilder& pipelineBuilder, const RenderTargetInfo& renderTarget, VkDescriptorSetLayout globalSetLayout, uint32_t framesInFlight, uint32_t subpass = 0);
 		~PointLightSystem();
 
 		PointLightSystem(const PointLightSystem&) = delete;
 		PointLightSystem& operator=(const PointLightSystem&) = delete;
 
-		void Update(FrameInfo& frameInfo, GlobalUBO& ubo);
+		//Gathers every light whose range reaches into the view and hands them to lighting for binning, there is no upper bound
+		void Update(FrameInfo& frameInfo, GlobalUBO& ubo, ClusteredLighting& lighting);
+		//Draws the lights gathered by the last Update call back to front in a single instanced draw
 		void Render(FrameInfo& frameInfo);
 	private:
+		struct PointLightInstance {
+			glm::vec4 m_Position{}; //4th component is the billboard radius
+			glm::vec4 m_Color{}; //4th component is light intensity
+		};
+
 		void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout);
-		void CreatePipeline(VkRenderPass renderPass);
+		void CreatePipeline(PipelineBuilder& pipelineBuilder, const RenderTargetInfo& renderTarget, uint32_t subpass);
 
 		Device& m_Device;
 		VkPipelineLayout m_PipelineLayout;
-		std::unique_ptr<Pipeline> m_Pipeline;
+		PendingPipeline m_Pipeline;
+		std::vector<Entity> m_VisibleLights;
+		std::vector<Entity> m_LitEntities;
+		std::vector<PointLight> m_Lights;
+
+		LightDistanceSort m_LightSort;
+		std::vector<std::unique_ptr<Buffer>> m_InstanceBuffers;
 	};
 
 }
\ No newline at end of file
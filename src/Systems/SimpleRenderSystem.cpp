@@ -4,7 +4,11 @@
 #include <glm/gtc/constants.hpp>
 #include <glm/glm.hpp>
 #include <stdexcept>
+#include <algorithm>
+#include <array>
 
+#include "OcclusionCulling.h"
+#include "CpuProfiler.h"
 #include "GameObject.h"
 
 namespace Florencia {
@@ -14,38 +18,78 @@ namespace Florencia {
 		glm::mat4 normalMatrix{ 1.0f };
 	};
 
-	SimpleRenderSystem::SimpleRenderSystem(Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : m_Device(device) {
-		CreatePipelineLayout(globalSetLayout);
-		CreatePipeline(renderPass);
+	SimpleRenderSystem::SimpleRenderSystem(Device& device, PipelineBuilder& pipelineBuilder, const RenderTargetInfo& renderTarget, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout, RenderPath renderPath)
+		: m_Device(device), m_PipelineBuilder(pipelineBuilder), m_RenderPath(renderPath), m_RenderTarget(renderTarget) {
+		CreatePipelineLayout(globalSetLayout, lightingSetLayout);
+		CreatePipeline();
 	}
 
-	SimpleRenderSystem::~SimpleRenderSystem() { vkDestroyPipelineLayout(m_Device.Get(), m_PipelineLayout, nullptr); }
+	SimpleRenderSystem::~SimpleRenderSystem() { vkDestroyPipelineLayout(m_Device.Get(), m_PipelineLayout, m_Device.GetAllocator()); }
 
 	void SimpleRenderSystem::RenderGameObjects(FrameInfo& frameInfo) {
-		m_Pipeline->Bind(frameInfo.m_CommandBuffer);
+		FLORENCIA_PROFILE_SCOPE("SimpleRenderSystem::RenderGameObjects");
+		m_VisibleEntities.clear();
+		frameInfo.m_SpatialIndex.QueryFrustum(frameInfo.m_Camera.GetFrustum(), SpatialLayer::Renderable, m_VisibleEntities);
+
+		m_DrawCommands.clear();
+		for (Entity entity : m_VisibleEntities) {
+			auto model = frameInfo.m_Registry.TryGet<ModelComponent>(entity);
+			if (model == nullptr || model->m_Model == nullptr) { continue; }
+			auto& transform = frameInfo.m_Registry.Get<TransformComponent>(entity);
+			glm::mat4 modelMatrix = transform.Mat4();
+			if (frameInfo.m_OcclusionCuller != nullptr && !frameInfo.m_OcclusionCuller->IsVisible(entity, model->m_Model->GetBounds().Transform(modelMatrix))) { continue; }
+			WorldShaderVariant variant = WorldShaderVariant::FromMaterial(frameInfo.m_Registry.TryGet<MaterialComponent>(entity));
+			m_DrawCommands.push_back({ model->m_Model.get(), modelMatrix, transform.NormalMatrix(), variant, variant.Key() });
+		}
 
-		vkCmdBindDescriptorSets(frameInfo.m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &frameInfo.m_GlobalDescriptorSet, 0, nullptr);
+		DebugLabelScope label{ m_Device, frameInfo.m_CommandBuffer, "SimpleRenderSystem" };
+		VkDescriptorSet descriptorSets[] = { frameInfo.m_GlobalDescriptorSet, frameInfo.m_LightingDescriptorSet };
+		vkCmdBindDescriptorSets(frameInfo.m_CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 2, descriptorSets, 0, nullptr);
+		frameInfo.m_Statistics.m_DescriptorSetBinds++;
+		//Grouped by variant so every pipeline is bound once per pass
+		std::sort(m_DrawCommands.begin(), m_DrawCommands.end(), [](const DrawCommand& a, const DrawCommand& b) { return a.m_VariantKey < b.m_VariantKey; });
+		if (m_RenderPath == RenderPath::Deferred) {
+			//The g-buffer variants write the material for DeferredLighting.frag to light with
+			RecordDraws(frameInfo, true, false);
+			return;
+		}
 
-		for (auto& keyvalue : frameInfo.m_GameObjects) {
-			auto& obj = keyvalue.second;
-			if (obj.m_Model == nullptr) { continue; }
-			SimplePushConstantData push{};
-			push.modelMatrix = obj.m_Transform.Mat4();
-			push.normalMatrix = obj.m_Transform.NormalMatrix();
+		if (m_DepthPrepassEnabled) {
+			DebugLabelScope prepassLabel{ m_Device, frameInfo.m_CommandBuffer, "Depth Pre-pass" };
+			if (m_DepthOnlyPipeline.Get().Bind(frameInfo.m_CommandBuffer, frameInfo.m_BoundPipeline)) { frameInfo.m_Statistics.m_PipelineBinds++; }
+			RecordDraws(frameInfo, false, false);
+		}
+		RecordDraws(frameInfo, true, m_DepthPrepassEnabled);
+	}
 
-			vkCmdPushConstants(frameInfo.m_CommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
-			obj.m_Model->Bind(frameInfo.m_CommandBuffer);
-			obj.m_Model->Draw(frameInfo.m_CommandBuffer);
+	void SimpleRenderSystem::RecordDraws(FrameInfo& frameInfo, bool bindVariants, bool depthEqual) {
+		VkCommandBuffer commandBuffer = frameInfo.m_CommandBuffer;
+		for (size_t i = 0; i < m_DrawCommands.size(); i++) {
+			const DrawCommand& draw = m_DrawCommands[i];
+			//Variants that end up with the same pipeline state share a pipeline, so the bind may still be skipped
+			if (bindVariants && (i == 0 || draw.m_VariantKey != m_DrawCommands[i - 1].m_VariantKey) && GetPipeline(draw.m_Variant, depthEqual).Bind(commandBuffer, frameInfo.m_BoundPipeline)) {
+				frameInfo.m_Statistics.m_PipelineBinds++;
+			}
+
+			SimplePushConstantData push{};
+			push.modelMatrix = draw.m_ModelMatrix;
+			push.normalMatrix = draw.m_NormalMatrix;
+
+			vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
+			draw.m_Model->Bind(commandBuffer);
+			draw.m_Model->Draw(commandBuffer);
+			frameInfo.m_Statistics.m_VertexBufferBinds++;
+			frameInfo.m_Statistics.m_DrawCalls++;
 		}
 	}
 
-	void SimpleRenderSystem::CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+	void SimpleRenderSystem::CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout) {
 		VkPushConstantRange pushConstantRange{};
 		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 		pushConstantRange.size = sizeof(SimplePushConstantData);
 		pushConstantRange.offset = 0;
 
-		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, lightingSetLayout };
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -54,19 +98,55 @@ namespace Florencia {
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-		if (vkCreatePipelineLayout(m_Device.Get(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS) throw std::runtime_error("Failed to Create Pipeline Layout");
+		if (vkCreatePipelineLayout(m_Device.Get(), &pipelineLayoutInfo, m_Device.GetAllocator(), &m_PipelineLayout) != VK_SUCCESS) throw std::runtime_error("Failed to Create Pipeline Layout");
 	}
 
-	void SimpleRenderSystem::CreatePipeline(VkRenderPass renderPass) {
+	void SimpleRenderSystem::CreatePipeline() {
 		if (m_PipelineLayout == nullptr) throw std::runtime_error("Cannot create pipeline before pipeline layout");
 
+		//Objects without a material use the default variant, start its pipelines now so the first frame doesn't stall on them
+		WorldShaderVariant defaultVariant{};
+		m_Pipelines.Prepare(defaultVariant.Key() << 1, [&]() { return BuildVariant(defaultVariant, false); });
+		if (m_RenderPath == RenderPath::Deferred) { return; }
+
+		PipelineConfigInfo depthOnlyConfig{};
+		Pipeline::DefaultPipelineConfigInfo(depthOnlyConfig);
+		Pipeline::DepthOnlyPipelineConfigInfo(depthOnlyConfig);
+		Pipeline::RenderTargetConfigInfo(depthOnlyConfig, m_RenderTarget);
+		depthOnlyConfig.pipelineLayout = m_PipelineLayout;
+		m_DepthOnlyPipeline = m_PipelineBuilder.Build(depthOnlyConfig, "assets/shaders/DepthOnly.vert.spv", "");
+
+		m_Pipelines.Prepare(defaultVariant.Key() << 1 | 1, [&]() { return BuildVariant(defaultVariant, true); });
+	}
+
+	Pipeline& SimpleRenderSystem::GetPipeline(const WorldShaderVariant& variant, bool depthEqual) {
+		uint64_t key = variant.Key() << 1 | (depthEqual ? 1 : 0);
+		//The capturing lambda is too large for std::function to store inline, so it is only built for a new variant
+		if (Pipeline* pipeline = m_Pipelines.Find(key)) { return *pipeline; }
+		return m_Pipelines.Get(key, [&]() { return BuildVariant(variant, depthEqual); });
+	}
+
+	SharedPipeline SimpleRenderSystem::BuildVariant(const WorldShaderVariant& variant, bool depthEqual) {
+		SpecializationConstants constants = variant.Constants();
 		PipelineConfigInfo pipelineConfig{};
 		Pipeline::DefaultPipelineConfigInfo(pipelineConfig);
-
-		pipelineConfig.renderPass = renderPass;
+		Pipeline::RenderTargetConfigInfo(pipelineConfig, m_RenderTarget);
 		pipelineConfig.pipelineLayout = m_PipelineLayout;
-
-		m_Pipeline = std::make_unique<Pipeline>(m_Device, pipelineConfig, "assets/shaders/World.vert.spv", "assets/shaders/World.frag.spv");
+		pipelineConfig.specializationInfo = constants.GetInfo();
+		if (m_RenderPath == RenderPath::Deferred) {
+			//One blend state per g-buffer target, subpass 0 writes albedo and normal
+			std::array<VkPipelineColorBlendAttachmentState, 2> gBufferBlendAttachments{ pipelineConfig.colorBlendAttachment, pipelineConfig.colorBlendAttachment };
+			pipelineConfig.colorBlendInfo.attachmentCount = static_cast<uint32_t>(gBufferBlendAttachments.size());
+			pipelineConfig.colorBlendInfo.pAttachments = gBufferBlendAttachments.data();
+			pipelineConfig.subpass = 0;
+			return m_PipelineBuilder.Build(pipelineConfig, "assets/shaders/World.vert.spv", "assets/shaders/GBuffer.frag.spv");
+		}
+		if (depthEqual) {
+			//Depth is already resolved by the pre-pass, only the front most surface passes EQUAL
+			pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+			pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+		}
+		return m_PipelineBuilder.Build(pipelineConfig, "assets/shaders/World.vert.spv", "assets/shaders/World.frag.spv");
 	}
 
 }
\ No newline at end of file
@@ -1,28 +1,57 @@
 #pragma once
 #include <memory>
 #include <vector>
+#include "ShaderVariant.h"
 #include "FrameInfo.h"
-#include "Pipeline.h"
+#include "PipelineBuilder.h"
+#include "SwapChain.h"
 #include "Device.h"
 
 namespace Florencia {
 
 	class SimpleRenderSystem {
 	public:
-		SimpleRenderSystem(Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+		//With the deferred path the objects are written to the g-buffer in subpass 0 instead of being lit directly
+		//Pipelines are compiled by pipelineBuilder in the background, the builder must outlive this system
+		SimpleRenderSystem(Device& device, PipelineBuilder& pipelineBuilder, const RenderTargetInfo& renderTarget, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout, RenderPath renderPath = RenderPath::Forward);
 		~SimpleRenderSystem();
 
 		SimpleRenderSystem(const SimpleRenderSystem&) = delete;
 		SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
 
 		void RenderGameObjects(FrameInfo& frameInfo);
+
+		//Lays down depth with a position only pass first so the lit pass shades each pixel once, forward path only
+		void SetDepthPrepassEnabled(bool enabled) { m_DepthPrepassEnabled = enabled; }
+		bool IsDepthPrepassEnabled() const { return m_DepthPrepassEnabled; }
+
 	private:
-		void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout);
-		void CreatePipeline(VkRenderPass renderPass);
+		struct DrawCommand {
+			Model* m_Model;
+			glm::mat4 m_ModelMatrix;
+			glm::mat4 m_NormalMatrix;
+			WorldShaderVariant m_Variant;
+			uint64_t m_VariantKey;
+		};
+
+		void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout lightingSetLayout);
+		void CreatePipeline();
+		//Built on first use and cached, depthEqual variants test against the pre-pass depth, with the deferred path these are the g-buffer pipelines
+		Pipeline& GetPipeline(const WorldShaderVariant& variant, bool depthEqual);
+		SharedPipeline BuildVariant(const WorldShaderVariant& variant, bool depthEqual);
+		//With bindVariants the pipeline of each draw's variant is bound as the variant changes, otherwise the bound pipeline is used
+		void RecordDraws(FrameInfo& frameInfo, bool bindVariants, bool depthEqual);
 
 		Device& m_Device;
+		PipelineBuilder& m_PipelineBuilder;
+		RenderPath m_RenderPath;
+		RenderTargetInfo m_RenderTarget;
 		VkPipelineLayout m_PipelineLayout;
-		std::unique_ptr<Pipeline> m_Pipeline;
+		PipelineVariantCache m_Pipelines;
+		PendingPipeline m_DepthOnlyPipeline;
+		bool m_DepthPrepassEnabled = false;
+		std::vector<Entity> m_VisibleEntities;
+		std::vector<DrawCommand> m_DrawCommands;
 	};
 
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <functional>
 
 namespace Florencia {
@@ -9,4 +10,14 @@ namespace Florencia {
 		(HashCombine(seed, rest), ...);
 	}
 
+	//FNV-1a, pass the previous result as hash to continue hashing across several buffers
+	inline uint64_t HashBytes(const void* data, std::size_t size, uint64_t hash = 14695981039346656037ull) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (std::size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
 }
\ No newline at end of file
@@ -7,17 +7,44 @@ namespace Florencia {
 	}
 
 	Window::~Window() {
+		if (IsHeadless()) { return; }
 		glfwDestroyWindow(m_Window);
 		glfwTerminate();
 	}
 
-	void Window::CreateWindowSurface(VkInstance instance, VkSurfaceKHR* surface) {
-		if (glfwCreateWindowSurface(instance, m_Window, nullptr, surface) != VK_SUCCESS) {
+	void Window::SetSize(uint32_t width, uint32_t height) {
+		//There is no framebuffer callback without a window, flag the resize the same way it would
+		if (IsHeadless()) {
+			if (width == m_Properties.Width && height == m_Properties.Height) { return; }
+			m_Properties.Width = width;
+			m_Properties.Height = height;
+			m_Properties.Resized = true;
+			return;
+		}
+		glfwSetWindowSize(m_Window, static_cast<int>(width), static_cast<int>(height));
+	}
+
+	void Window::SetTitle(const std::string& title) {
+		m_Properties.Title = title;
+		if (!IsHeadless()) { glfwSetWindowTitle(m_Window, title.c_str()); }
+	}
+
+	void Window::Close() {
+		m_CloseRequested = true;
+		if (!IsHeadless()) { glfwSetWindowShouldClose(m_Window, GLFW_TRUE); }
+	}
+
+	void Window::CreateWindowSurface(VkInstance instance, const VkAllocationCallbacks* allocator, VkSurfaceKHR* surface) {
+		if (IsHeadless()) {
+			throw std::runtime_error("Headless Window Has No Surface");
+		}
+		if (glfwCreateWindowSurface(instance, m_Window, allocator, surface) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to Create Window Surface");
 		}
 	}
 
 	void Window::InitializeWindow() {
+		if (IsHeadless()) { return; }
 		if (glfwInit() != GL_FALSE) {
 			glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
 			glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
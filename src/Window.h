@@ -7,8 +7,10 @@
 namespace Florencia {
 
 	struct WindowProps {
-		WindowProps(uint32_t width, uint32_t height, std::string title) :Title(title), Width(width), Height(height) {}
+		WindowProps(uint32_t width, uint32_t height, std::string title, bool headless = false) :Title(title), Headless(headless), Width(width), Height(height) {}
 		std::string Title;
+		//No glfw window or surface is created, the size is only used for the offscreen targets
+		bool Headless;
 		bool Resized = false;
 		uint32_t Width, Height;
 	};
@@ -21,21 +23,32 @@ namespace Florencia {
 		Window(const Window&) = delete;
 		Window& operator=(const Window&) = delete;
 
-		void Update() { glfwPollEvents(); }
+		//Nothing can be presented while minimized, so wait for the next event instead of spinning through empty frames
+		void Update() { if (IsHeadless()) return; if (IsMinimized()) glfwWaitEvents(); else glfwPollEvents(); }
 
 		VkExtent2D GetExtent() const { return { m_Properties.Width, m_Properties.Height }; }
-		bool IsOpen() { return !glfwWindowShouldClose(m_Window); }
+		bool IsMinimized() const { return m_Properties.Width == 0 || m_Properties.Height == 0; }
+		//Headless this resizes the offscreen targets, they are recreated at the end of the current frame
+		void SetSize(uint32_t width, uint32_t height);
+		void SetTitle(const std::string& title);
+		bool IsOpen() { return IsHeadless() ? !m_CloseRequested : !glfwWindowShouldClose(m_Window); }
+		void Close();
+		bool IsHeadless() const { return m_Properties.Headless; }
+		//Input queries report nothing pressed while headless
+		bool IsKeyPressed(int key) const { return !IsHeadless() && glfwGetKey(m_Window, key) == GLFW_PRESS; }
+		bool IsMouseButtonPressed(int button) const { return !IsHeadless() && glfwGetMouseButton(m_Window, button) == GLFW_PRESS; }
 		bool WasResized() const { return m_Properties.Resized; }
 		void ResetWindowResizeFlag() { m_Properties.Resized = false; }
 		GLFWwindow* Get() const { return m_Window; }
 
-		void CreateWindowSurface(VkInstance instance, VkSurfaceKHR* surface);
+		void CreateWindowSurface(VkInstance instance, const VkAllocationCallbacks* allocator, VkSurfaceKHR* surface);
 	private:
 		void InitializeWindow();
 		static void FramebufferResizeCallback(GLFWwindow* window, int width, int height);
 
-		GLFWwindow* m_Window;
+		GLFWwindow* m_Window = nullptr;
 		WindowProps m_Properties;
+		bool m_CloseRequested = false;
 	};
 
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "Application.h"
 
 int main(int argc, char** argv) {
-	Florencia::Application* app = new Florencia::Application();
+	Florencia::Application* app = new Florencia::Application(Florencia::ApplicationProps::FromCommandLine(argc, argv));
 	app->Run();
 	delete app;
 	return 0;